@@ -1,12 +1,20 @@
 #include <cuw3/cuw3.hpp>
+#include <cuw3/memory_resource.hpp>
+#include <cuw3/fast_path.hpp>
 
 #include <benchmark/benchmark.h>
 
+#include <cstdio>
+#include <cstring>
 #include <format>
 #include <random>
+#include <map>
 #include <vector>
 #include <variant>
 #include <iterator>
+#include <algorithm>
+#include <unordered_map>
+#include <memory_resource>
 
 using namespace cuw3;
 
@@ -57,6 +65,29 @@ struct Cuw3Allocator {
     }
 };
 
+// same as Cuw3Allocator but size is looked up on free
+struct Cuw3UnsizedAllocator {
+    void* allocate(uint64 size, uint64 alignment) const {
+        return cuw3_alloc(size, alignment);
+    }
+
+    void deallocate(void* ptr, uint64 size) const {
+        (void)size;
+        cuw3_free_unsized(ptr);
+    }
+};
+
+// same as Cuw3Allocator but tcache hits are served inline
+struct Cuw3InlineAllocator {
+    void* allocate(uint64 size, uint64 alignment) const {
+        return cuw3::alloc_inline(size, alignment);
+    }
+
+    void deallocate(void* ptr, uint64 size) const {
+        cuw3::free_inline(ptr, size);
+    }
+};
+
 struct StdAllocator {
     void* allocate(uint64 size, uint64 alignment) const {
         (void)alignment;
@@ -169,6 +200,29 @@ RequestList create_req_list_alloc_dealloc_chaos(uint64 seed, uint64 low, uint64
     return reqs;
 }
 
+// spreads alignments of allocation requests over powers of two in [min_alignment_log2, max_alignment_log2]
+void randomize_alignments(RequestList& reqs, uint64 seed, uint64 min_alignment_log2, uint64 max_alignment_log2) {
+    std::minstd_rand gen(seed ? seed : std::random_device{}());
+    std::uniform_int_distribution<uint64> dist(min_alignment_log2, max_alignment_log2);
+    for (auto& req : reqs) {
+        if (auto* alloc_req = std::get_if<AllocationRequest>(&req)) {
+            alloc_req->alignment = (uint64)1 << dist(gen);
+        }
+    }
+}
+
+// resident set size of the whole process, zero if it cannot be queried (non-linux)
+uint64 resident_set_size() {
+    unsigned long long rss_pages{};
+    if (FILE* statm = fopen("/proc/self/statm", "r")) {
+        if (fscanf(statm, "%*u %llu", &rss_pages) != 1) {
+            rss_pages = 0;
+        }
+        fclose(statm);
+    }
+    return rss_pages * 4096;
+}
+
 template<class Allocator>
 void execute_benchmark(benchmark::State& state, const Allocator& alloc, const RequestExecutor& executor, RequestContext& context, const RequestList& reqs, const char* name) {
     for (const auto& _ : state) {
@@ -185,6 +239,40 @@ void execute_benchmark(benchmark::State& state, const Allocator& alloc, const Re
 }
 
 
+// same as execute_benchmark but also reports peak rss, sampled once all allocations of the list are made and touched
+// list must allocate everything first and deallocate afterwards (see create_req_list_alloc_dealloc)
+template<class Allocator>
+void execute_benchmark_rss(benchmark::State& state, const Allocator& alloc, const RequestExecutor& executor, RequestContext& context, const RequestList& reqs, const char* name) {
+    auto middle = reqs.begin() + reqs.size() / 2;
+    RequestList alloc_reqs(reqs.begin(), middle);
+    RequestList dealloc_reqs(middle, reqs.end());
+
+    uint64 peak_rss{};
+    for (const auto& _ : state) {
+        if (!executor.exec_list(alloc, context, alloc_reqs)) {
+            state.SkipWithError(std::format("{}: failed to finish request", name));
+            return;
+        }
+        state.PauseTiming();
+        for (auto& allocation : context.allocations) {
+            memset(allocation.ptr, 0xff, allocation.size); // untouched pages are not resident
+        }
+        peak_rss = std::max(peak_rss, resident_set_size());
+        state.ResumeTiming();
+        if (!executor.exec_list(alloc, context, dealloc_reqs)) {
+            state.SkipWithError(std::format("{}: failed to finish request", name));
+            return;
+        }
+        if (context.any_alive_allocs()) {
+            state.SkipWithError(std::format("{}: context was not empty", name));
+            return;
+        }
+        context.clear();
+    }
+    state.counters["peak_rss_mib"] = (double)peak_rss / (1 << 20);
+}
+
+
 // all consts are taken from the cuw3.cpp file
 void cuw3_bench_small_alloc_dealloc(benchmark::State& state) {
     RequestExecutor executor{};
@@ -241,6 +329,71 @@ void cuw3_bench_mixed_alloc_dealloc_chaos_mt(benchmark::State& state) {
 }
 
 
+// alignments from 16 B to 4 KiB are interleaved: binned layout keeps arenas per alignment
+// build with -DCUW3_ALIGNMENT_AGNOSTIC_ARENAS=1 to compare with alignment-agnostic arenas
+void cuw3_bench_mixed_aligned_alloc_dealloc(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc(42 + state.thread_index(), 16, 16384, 16, 1 << 12);
+    randomize_alignments(reqs, 42 + state.thread_index(), 4, 12);
+    execute_benchmark_rss(state, Cuw3Allocator{}, executor, context, reqs, "bench_mixed_aligned_alloc_dealloc");
+}
+
+void cuw3_bench_mixed_aligned_alloc_dealloc_chaos(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc_chaos(42 + state.thread_index(), 16, 16384, 16, 1 << 16);
+    randomize_alignments(reqs, 42 + state.thread_index(), 4, 12);
+    execute_benchmark(state, Cuw3Allocator{}, executor, context, reqs, "bench_mixed_aligned_alloc_dealloc_chaos");
+}
+
+void cuw3_bench_mixed_aligned_alloc_dealloc_chaos_mt(benchmark::State& state) {
+    cuw3_bench_mixed_aligned_alloc_dealloc_chaos(state);
+}
+
+
+// sized vs unsized free: same request lists as above
+// allocations are as big as chunks so threads keep taking chunks from the cache and region pools
+void cuw3_bench_chunk_churn_mt(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc_chaos(42 + state.thread_index(), 1 << 20, 1 << 22, 16, 1 << 5);
+    execute_benchmark(state, Cuw3Allocator{}, executor, context, reqs, "bench_chunk_churn_mt");
+}
+
+void cuw3_unsized_bench_small_alloc_dealloc(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc(42 + state.thread_index(), 16, 16384, 16, 1 << 18);
+    execute_benchmark(state, Cuw3UnsizedAllocator{}, executor, context, reqs, "unsized_bench_small_alloc_dealloc");
+}
+
+void cuw3_unsized_bench_small_alloc_dealloc_chaos(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc_chaos(42 + state.thread_index(), 16, 16384, 16, 1 << 18);
+    execute_benchmark(state, Cuw3UnsizedAllocator{}, executor, context, reqs, "unsized_bench_small_alloc_dealloc_chaos");
+}
+
+void cuw3_unsized_bench_medium_alloc_dealloc(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc(42 + state.thread_index(), 16384, 1 << 18, 16, 1 << 15);
+    execute_benchmark(state, Cuw3UnsizedAllocator{}, executor, context, reqs, "unsized_bench_medium_alloc_dealloc");
+}
+
+void cuw3_unsized_bench_mixed_alloc_dealloc_chaos(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc_chaos(42 + state.thread_index(), 16, 1 << 18, 16, 1 << 15);
+    execute_benchmark(state, Cuw3UnsizedAllocator{}, executor, context, reqs, "unsized_bench_mixed_alloc_dealloc_chaos");
+}
+
+void cuw3_unsized_bench_mixed_alloc_dealloc_chaos_mt(benchmark::State& state) {
+    cuw3_unsized_bench_mixed_alloc_dealloc_chaos(state);
+}
+
+
 // all consts are taken from the cuw3.cpp file
 void std_bench_small_alloc_dealloc(benchmark::State& state) {
     RequestExecutor executor{};
@@ -292,11 +445,136 @@ void std_bench_mixed_alloc_dealloc_chaos(benchmark::State& state) {
     execute_benchmark(state, StdAllocator{}, executor, context, reqs, "bench_mixed_alloc_dealloc_chaos");
 }
 
+void std_bench_chunk_churn_mt(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc_chaos(42 + state.thread_index(), 1 << 20, 1 << 22, 16, 1 << 5);
+    execute_benchmark(state, StdAllocator{}, executor, context, reqs, "bench_chunk_churn_mt");
+}
+
 void std_bench_mixed_alloc_dealloc_chaos_mt(benchmark::State& state) {
     std_bench_mixed_alloc_dealloc_chaos(state);
 }
 
 
+// containers: the same workload on top of std::allocator, cuw3 adapters and the pmr pool
+// container is created per iteration, so every node and buffer goes through the allocator and back
+inline constexpr uint64 container_elems = 1 << 14;
+
+uint64 container_key(uint64 i) {
+    return i * 0x9E3779B97F4A7C15ull;
+}
+
+template<class Container, class... Args>
+void bench_container_vector(benchmark::State& state, Args&&... args) {
+    for (auto _ : state) {
+        Container vec(args...);
+        for (uint64 i = 0; i < container_elems; i++) {
+            vec.push_back(i);
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+// half of the nodes is erased before the container dies so frees interleave with allocations
+template<class Container, class... Args>
+void bench_container_map(benchmark::State& state, Args&&... args) {
+    for (auto _ : state) {
+        Container map(args...);
+        for (uint64 i = 0; i < container_elems; i++) {
+            map.emplace(container_key(i), i);
+        }
+        for (uint64 i = 0; i < container_elems; i += 2) {
+            map.erase(container_key(i));
+        }
+        benchmark::DoNotOptimize(map.size());
+    }
+}
+
+template<class T>
+using Cuw3Vector = std::vector<T, StlAllocator<T>>;
+
+template<class K, class V>
+using Cuw3UnorderedMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, StlAllocator<std::pair<const K, V>>>;
+
+template<class K, class V>
+using Cuw3Map = std::map<K, V, std::less<K>, StlAllocator<std::pair<const K, V>>>;
+
+void cuw3_bench_vector(benchmark::State& state) {
+    bench_container_vector<Cuw3Vector<uint64>>(state);
+}
+
+void cuw3_pmr_bench_vector(benchmark::State& state) {
+    bench_container_vector<std::pmr::vector<uint64>>(state, get_memory_resource());
+}
+
+void std_bench_vector(benchmark::State& state) {
+    bench_container_vector<std::vector<uint64>>(state);
+}
+
+void pool_pmr_bench_vector(benchmark::State& state) {
+    std::pmr::unsynchronized_pool_resource pool{};
+    bench_container_vector<std::pmr::vector<uint64>>(state, &pool);
+}
+
+void cuw3_bench_unordered_map(benchmark::State& state) {
+    bench_container_map<Cuw3UnorderedMap<uint64, uint64>>(state);
+}
+
+void cuw3_pmr_bench_unordered_map(benchmark::State& state) {
+    bench_container_map<std::pmr::unordered_map<uint64, uint64>>(state, get_memory_resource());
+}
+
+void std_bench_unordered_map(benchmark::State& state) {
+    bench_container_map<std::unordered_map<uint64, uint64>>(state);
+}
+
+void pool_pmr_bench_unordered_map(benchmark::State& state) {
+    std::pmr::unsynchronized_pool_resource pool{};
+    bench_container_map<std::pmr::unordered_map<uint64, uint64>>(state, &pool);
+}
+
+void cuw3_bench_map(benchmark::State& state) {
+    bench_container_map<Cuw3Map<uint64, uint64>>(state);
+}
+
+void cuw3_pmr_bench_map(benchmark::State& state) {
+    bench_container_map<std::pmr::map<uint64, uint64>>(state, get_memory_resource());
+}
+
+void std_bench_map(benchmark::State& state) {
+    bench_container_map<std::map<uint64, uint64>>(state);
+}
+
+void pool_pmr_bench_map(benchmark::State& state) {
+    std::pmr::unsynchronized_pool_resource pool{};
+    bench_container_map<std::pmr::map<uint64, uint64>>(state, &pool);
+}
+
+// slab sizes only, interleaved frees and allocations mostly hit the tcache
+void cuw3_bench_slab_alloc_dealloc_chaos(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc_chaos(42 + state.thread_index(), 16, 1024, 16, 1 << 18);
+    execute_benchmark(state, Cuw3Allocator{}, executor, context, reqs, "bench_slab_alloc_dealloc_chaos");
+}
+
+void cuw3_bench_slab_alloc_dealloc_chaos_mt(benchmark::State& state) {
+    cuw3_bench_slab_alloc_dealloc_chaos(state);
+}
+
+void cuw3_inline_bench_slab_alloc_dealloc_chaos(benchmark::State& state) {
+    RequestExecutor executor{};
+    RequestContext context{};
+    RequestList reqs = create_req_list_alloc_dealloc_chaos(42 + state.thread_index(), 16, 1024, 16, 1 << 18);
+    execute_benchmark(state, Cuw3InlineAllocator{}, executor, context, reqs, "inline_bench_slab_alloc_dealloc_chaos");
+}
+
+void cuw3_inline_bench_slab_alloc_dealloc_chaos_mt(benchmark::State& state) {
+    cuw3_inline_bench_slab_alloc_dealloc_chaos(state);
+}
+
+
 BENCHMARK(cuw3_bench_small_alloc_dealloc);
 BENCHMARK(std_bench_small_alloc_dealloc);
 
@@ -327,5 +605,44 @@ BENCHMARK(cuw3_bench_mixed_alloc_dealloc_chaos_mt)->Threads(12);
 BENCHMARK(std_bench_mixed_alloc_dealloc_chaos_mt)->Threads(12);
 
 
+BENCHMARK(cuw3_bench_mixed_aligned_alloc_dealloc);
+BENCHMARK(cuw3_bench_mixed_aligned_alloc_dealloc_chaos);
+BENCHMARK(cuw3_bench_mixed_aligned_alloc_dealloc_chaos_mt)->Threads(12);
+
+
+BENCHMARK(cuw3_bench_chunk_churn_mt)->ThreadRange(1, 64);
+BENCHMARK(std_bench_chunk_churn_mt)->ThreadRange(1, 64);
+
+
+// compare with sized cuw3 runs above
+BENCHMARK(cuw3_unsized_bench_small_alloc_dealloc);
+BENCHMARK(cuw3_unsized_bench_small_alloc_dealloc_chaos);
+BENCHMARK(cuw3_unsized_bench_medium_alloc_dealloc);
+BENCHMARK(cuw3_unsized_bench_mixed_alloc_dealloc_chaos);
+BENCHMARK(cuw3_unsized_bench_mixed_alloc_dealloc_chaos_mt)->Threads(12);
+
+
+BENCHMARK(cuw3_bench_slab_alloc_dealloc_chaos);
+BENCHMARK(cuw3_inline_bench_slab_alloc_dealloc_chaos);
+
+BENCHMARK(cuw3_bench_slab_alloc_dealloc_chaos_mt)->Threads(12);
+BENCHMARK(cuw3_inline_bench_slab_alloc_dealloc_chaos_mt)->Threads(12);
+
+
+BENCHMARK(cuw3_bench_vector);
+BENCHMARK(cuw3_pmr_bench_vector);
+BENCHMARK(std_bench_vector);
+BENCHMARK(pool_pmr_bench_vector);
+
+BENCHMARK(cuw3_bench_unordered_map);
+BENCHMARK(cuw3_pmr_bench_unordered_map);
+BENCHMARK(std_bench_unordered_map);
+BENCHMARK(pool_pmr_bench_unordered_map);
+
+BENCHMARK(cuw3_bench_map);
+BENCHMARK(cuw3_pmr_bench_map);
+BENCHMARK(std_bench_map);
+BENCHMARK(pool_pmr_bench_map);
+
 
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -6,7 +6,11 @@
 #include "funcs.hpp"
 #include "utils.hpp"
 #include "assert.hpp"
+#include "large_allocator.hpp"
+#include "scoped_arena.hpp"
 #include "thread_graveyard.hpp"
+#include "region_chunk_cache.hpp"
+#include "sub_chunk_arena_pool.hpp"
 #include "region_chunk_allocator.hpp"
 #include "thread_local_allocator.hpp"
 
@@ -16,56 +20,152 @@ namespace cuw3 {
 
     inline constexpr uint64 cuw3_try_reclaim_each_op = 8;
     inline constexpr uint64 cuw3_try_cleanup_each_op = 16;
+    inline constexpr uint64 cuw3_batch_free_groups = 16; // arenas and slab chunks tracked at once by a batch free
+
+    // how chunk memory is committed and decommitted
+    // * Protect: regions are reserved inaccessible, chunks are committed/decommitted via protection change
+    //   each commit/decommit splits/merges VMAs under the mm lock so it serializes threads on linux
+    // * LazyFree/LazyDontNeed: regions are reserved read-write up front so pages are committed on the first touch
+    //   chunk commit is no-op, decommit only purges pages (MADV_FREE/MADV_DONTNEED), relies on overcommit
+    //   NOTE : windows cannot reserve huge read-write ranges without committing them, stick to Protect there
+    enum class ChunkCommitMode : uint32 {
+        Protect,
+        LazyFree,
+        LazyDontNeed,
+    };
+
+    // huge page backing of the region chunks, applied once to the whole regions range so commits inherit it
+    // * Transparent: MADV_HUGEPAGE hint, kernel may or may not back chunks with huge pages
+    // * Hugetlb: MAP_HUGETLB if hugetlb pool can hold all regions, falls back to Transparent otherwise
+    //   never used with lazy chunk commit modes: unreserved hugetlb mapping gets SIGBUS once the pool is exhausted
+    // chunk sizes and region alignment are multiples of the huge page size so chunks never share a huge page
+    enum class ChunkHugePageMode : uint32 {
+        None,
+        Transparent,
+        Hugetlb,
+    };
 
     struct AllocatorConfig {
         RegionChunkAllocatorSpecsConfig rca_specs_config{};
+        RegionChunkCacheConfig chunk_cache_config{};
+        SubChunkArenaPoolConfig sub_arena_pool_config{};
         uint64 contention_split{};
         uint64 num_grave_entries{};
+        ChunkCommitMode chunk_commit_mode{};
+        ChunkHugePageMode chunk_huge_page_mode{};
     };
 
     struct AllocatorMemoryBundle {
-        [[nodiscard]] static AllocatorMemoryBundle from(const RegionChunkAllocatorSpecs& specs) {
+        [[nodiscard]] static AllocatorMemoryBundle from(const RegionChunkAllocatorSpecs& specs, ChunkCommitMode chunk_commit_mode, ChunkHugePageMode chunk_huge_page_mode) {
             AllocatorMemoryBundle bundle{};
-            bundle.regions = vmem_alloc_aligned(specs.total_regions_size, VMemAllocType::VMemReserve, specs.region_alignment);
-            CUW3_CHECK_GOTO(bundle.regions, failed_regions_alloc, "failed to allocate regions memory");
+            uintptr regions_alloc_type = chunk_commit_mode == ChunkCommitMode::Protect ? VMemReserve : VMemReserveCommit | VMemNoReserve;
+            if (chunk_huge_page_mode == ChunkHugePageMode::Transparent) {
+                regions_alloc_type |= VMemHugepages;
+            } else if (chunk_huge_page_mode == ChunkHugePageMode::Hugetlb) {
+                regions_alloc_type |= VMemHugetlb;
+            }
+            bundle.regions_alloc_type = (VMemAllocType)regions_alloc_type;
+
+            if (specs.segment_size_log2) {
+                // regions and their end maps are reserved segment by segment on demand
+                // see RegionChunkAllocator::reserve_segment_() and Allocator::reserve_end_map_segment_()
+                bundle.segments = (void**)vmem_alloc(specs.total_segments_size, VMemAllocType::VMemReserveCommit);
+                CUW3_CHECK_GOTO(bundle.segments, failed_alloc, "failed to allocate segment table memory");
+
+                bundle.segment_map = (uint32*)vmem_alloc(specs.total_segment_map_size, (VMemAllocType)(VMemReserveCommit | VMemNoReserve));
+                CUW3_CHECK_GOTO(bundle.segment_map, failed_alloc, "failed to allocate segment map memory");
+
+                bundle.end_map_segments = (void**)vmem_alloc(specs.total_segments_size, VMemAllocType::VMemReserveCommit);
+                CUW3_CHECK_GOTO(bundle.end_map_segments, failed_alloc, "failed to allocate end map segment table memory");
+            } else {
+                bundle.regions = vmem_alloc_aligned(specs.total_regions_size, (VMemAllocType)regions_alloc_type, specs.region_alignment);
+                CUW3_CHECK_GOTO(bundle.regions, failed_alloc, "failed to allocate regions memory");
+
+                // only touched parts of the arena end maps are ever backed by pages
+                // NOTE : windows commits the whole range
+                bundle.end_map = (uint64*)vmem_alloc(end_map_size(specs.total_regions_size), (VMemAllocType)(VMemReserveCommit | VMemNoReserve));
+                CUW3_CHECK_GOTO(bundle.end_map, failed_alloc, "failed to allocate arena end map memory");
+
+                bundle.end_map_summary = (uint64*)vmem_alloc(end_map_summary_size(specs.total_regions_size), (VMemAllocType)(VMemReserveCommit | VMemNoReserve));
+                CUW3_CHECK_GOTO(bundle.end_map_summary, failed_alloc, "failed to allocate arena end map summary memory");
+            }
 
             bundle.handles = vmem_alloc_aligned(specs.total_handles_size, VMemAllocType::VMemReserveCommit, specs.handle_alignment);
-            CUW3_CHECK_GOTO(bundle.handles, failed_handles_alloc, "failed to allocate handles memory");
+            CUW3_CHECK_GOTO(bundle.handles, failed_alloc, "failed to allocate handles memory");
 
             bundle.pool_handles = vmem_alloc_aligned(specs.total_pool_handles_size, VMemAllocType::VMemReserveCommit, specs.pool_handles_alignment);
-            CUW3_CHECK_GOTO(bundle.pool_handles, failed_pool_handles_alloc, "failed to allocate pool handles memory");
+            CUW3_CHECK_GOTO(bundle.pool_handles, failed_alloc, "failed to allocate pool handles memory");
+
+            if (specs.unified) {
+                bundle.blocks = (RegionChunkBlock*)vmem_alloc_aligned(specs.total_blocks_size, VMemAllocType::VMemReserveCommit, specs.blocks_alignment);
+                CUW3_CHECK_GOTO(bundle.blocks, failed_alloc, "failed to allocate region blocks memory");
+            }
 
             // regions may be too big to poison
             // we cannot poison pool_handles because this memory can be accessed even when considered 'dead'
             CUW3_POISON_MEMORY_REGION(bundle.handles, specs.total_handles_size);
             return bundle;
 
-        failed_pool_handles_alloc:
-            vmem_free(bundle.handles, specs.total_handles_size);
-        failed_handles_alloc:
-            vmem_free(bundle.regions, specs.total_regions_size);
-        failed_regions_alloc:
+        failed_alloc:
+            release_(bundle, specs);
             return {};
         }
 
+        // segments themselves must have been released already, see RegionChunkAllocator::release_segments()
         static void release(AllocatorMemoryBundle bundle, const RegionChunkAllocatorSpecs& specs) {
             if (!bundle) {
                 return;
             }
-            vmem_free(bundle.regions, specs.total_regions_size);
-            vmem_free(bundle.handles, specs.total_handles_size);
-            vmem_free(bundle.pool_handles, specs.total_pool_handles_size);
+            release_(bundle, specs);
+        }
+
+        // releases whatever was allocated
+        static void release_(const AllocatorMemoryBundle& bundle, const RegionChunkAllocatorSpecs& specs) {
+            auto release_memory = [](void* memory, uint64 size) {
+                if (memory) {
+                    vmem_free(memory, size);
+                }
+            };
+            release_memory(bundle.regions, specs.total_regions_size);
+            release_memory(bundle.handles, specs.total_handles_size);
+            release_memory(bundle.pool_handles, specs.total_pool_handles_size);
+            release_memory(bundle.blocks, specs.total_blocks_size);
+            release_memory(bundle.end_map, end_map_size(specs.total_regions_size));
+            release_memory(bundle.end_map_summary, end_map_summary_size(specs.total_regions_size));
+            release_memory(bundle.segments, specs.total_segments_size);
+            release_memory(bundle.segment_map, specs.total_segment_map_size);
+            release_memory(bundle.end_map_segments, specs.total_segments_size);
+        }
+
+        static uint64 end_map_size(uint64 regions_size) {
+            return regions_size / fast_arena_end_map_ratio;
+        }
+
+        static uint64 end_map_summary_size(uint64 regions_size) {
+            return regions_size / fast_arena_end_map_summary_ratio;
         }
 
         explicit operator bool() const {
-            return regions && handles && pool_handles;
+            bool regions_valid = (regions && end_map && end_map_summary) || (segments && segment_map && end_map_segments);
+            return regions_valid && handles && pool_handles;
         }
 
         void* regions{};
         void* handles{};
         void* pool_handles{};
+        RegionChunkBlock* blocks{}; // unified regions only
+        uint64* end_map{}; // arena end maps of all chunks, indexed by chunk offset
+        uint64* end_map_summary{};
+
+        // segmented regions only
+        void** segments{};
+        uint32* segment_map{};
+        void** end_map_segments{}; // end map followed by its summary, one per segment
+        VMemAllocType regions_alloc_type{};
     };
 
+    static_assert(conf_min_region_chunk_size % fast_arena_end_map_summary_word_span == 0, "chunk end map must start at the summary word boundary");
+
     using TlaGraveyardOps = DefaultThreadGraveyardOps;
 
     struct Allocator {
@@ -87,7 +187,12 @@ namespace cuw3 {
             auto* rca_pools = RegionChunkAllocatorPools::create(Memory::from(&alloc->rca_pools), rca_pools_config);
             CUW3_CHECK_RETURN_VAL(rca_pools, nullptr, "allocator: failed to initialize region chunk allocator pools");
 
-            auto memory_bundle = AllocatorMemoryBundle::from(*rca_specs);
+            CUW3_CHECK_RETURN_VAL(
+                config.chunk_huge_page_mode == ChunkHugePageMode::None || is_aligned(rca_specs->region_alignment, vmem_huge_page_size()),
+                nullptr, "allocator: regions must be aligned to huge page size to be backed by huge pages"
+            );
+
+            auto memory_bundle = AllocatorMemoryBundle::from(*rca_specs, config.chunk_commit_mode, config.chunk_huge_page_mode);
             CUW3_CHECK_RETURN_VAL(memory_bundle, nullptr, "allocator: failed to allocate memory");
 
             RegionAllocatorConfig rca_config{};
@@ -96,11 +201,35 @@ namespace cuw3 {
             rca_config.regions = memory_bundle.regions;
             rca_config.handles = memory_bundle.handles;
             rca_config.pool_handles = memory_bundle.pool_handles;
+            rca_config.blocks = memory_bundle.blocks;
+            rca_config.segments = memory_bundle.segments;
+            rca_config.segment_map = memory_bundle.segment_map;
+            rca_config.segment_alloc_type = memory_bundle.regions_alloc_type;
 
             auto* rca = RegionChunkAllocator::create(Memory::from(&alloc->rca), rca_config);
+            auto* chunk_cache = RegionChunkCache::create(Memory::from(&alloc->chunk_cache), config.chunk_cache_config);
             auto* tla_graveyard = ThreadGraveyard::create(Memory::from(&alloc->tla_graveyard), config.num_grave_entries);
+
+            // sub-chunks are carved from the smallest chunks only
+            auto sub_arena_pool_config = config.sub_arena_pool_config;
+            sub_arena_pool_config.chunk_size_log2 = rca_specs->region_specs[0].chunk_size_log2;
+            sub_arena_pool_config.num_handles = rca_specs->region_specs[0].get_last_handle();
+            auto* sub_arena_pool = SubChunkArenaPool::create(Memory::from(&alloc->sub_arena_pool), sub_arena_pool_config);
+
+            // hugetlb is not used for spans: they are resized on page boundaries
+            LargeAllocatorConfig large_config{};
+            large_config.span_alloc_type = config.chunk_huge_page_mode == ChunkHugePageMode::None ? VMemReserveCommit : (VMemAllocType)(VMemReserveCommit | VMemHugepages);
+            auto* large_allocator = LargeAllocator::create(Memory::from(&alloc->large_allocator), large_config);
+
             CUW3_CHECK_GOTO(rca, free_alloc_memory, "allocator: failed to initialize region chunk allocator");
+            CUW3_CHECK_GOTO(chunk_cache, free_alloc_memory, "allocator: failed to initialize region chunk cache");
             CUW3_CHECK_GOTO(tla_graveyard, free_alloc_memory, "allocator: failed to initialize thread graveyard");
+            CUW3_CHECK_GOTO(sub_arena_pool, free_alloc_memory, "allocator: failed to initialize sub-chunk arena pool");
+            CUW3_CHECK_GOTO(large_allocator, free_alloc_memory, "allocator: failed to initialize large allocator");
+            alloc->chunk_commit_mode = config.chunk_commit_mode;
+            alloc->end_map = memory_bundle.end_map;
+            alloc->end_map_summary = memory_bundle.end_map_summary;
+            alloc->end_map_segments = memory_bundle.end_map_segments;
 
         #ifdef CUW3_ENABLE_DEBUG_CODE
             handle_owners_size = rca_specs->num_handles * sizeof(void*);
@@ -118,7 +247,21 @@ namespace cuw3 {
         static void destroy(Allocator* alloc) {
             CUW3_CHECK(alloc, "allocator: alloc was null on release");
 
-            AllocatorMemoryBundle::release({alloc->rca.regions, alloc->rca.handles, alloc->rca.pool_handles}, alloc->rca_specs);
+            alloc->rca.release_segments();
+            alloc->release_end_map_segments_();
+            LargeAllocator::destroy(&alloc->large_allocator);
+
+            AllocatorMemoryBundle bundle{};
+            bundle.regions = alloc->rca.regions;
+            bundle.handles = alloc->rca.handles;
+            bundle.pool_handles = alloc->rca.pool_handles;
+            bundle.blocks = alloc->rca.blocks;
+            bundle.end_map = alloc->end_map;
+            bundle.end_map_summary = alloc->end_map_summary;
+            bundle.segments = alloc->rca.segments;
+            bundle.segment_map = alloc->rca.segment_map;
+            bundle.end_map_segments = alloc->end_map_segments;
+            AllocatorMemoryBundle::release(bundle, alloc->rca_specs);
 
         #ifdef CUW3_ENABLE_DEBUG_CODE
             vmem_free(alloc->handle_owners, alloc->handle_owners_size);
@@ -166,93 +309,492 @@ namespace cuw3 {
                 align(size, alignment), 
                 std::min(rca.get_max_chunk_size(), tla->total_chunk_storage_size)
             );
+            return allocate_chunk_demand_(tla, demand, !incremental_commit_());
+        }
+
+        // demand is the minimal chunk size we want to get, bigger one can be returned
+        [[nodiscard]] RegionChunkAllocation allocate_chunk_demand_(ThreadLocalAllocator* tla, uint64 demand, bool commit) {
             uint32 region = rca.search_suitable_region(demand);
             if (region == region_chunk_allocator_null_value) {
                 return null_region_chunk_allocation;
             }
 
+            auto chunk_allocation = fetch_chunk_(tla, region, rca.get_num_regions(), commit);
+            if (!chunk_allocation) {
+                return null_region_chunk_allocation;
+            }
+            tla->total_chunk_storage_size += rca.get_region_spec(chunk_allocation.region).get_chunk_size(); // pump up the usage
+
+        #ifdef CUW3_ENABLE_DEBUG_CODE
+            set_handle_owner(tla, chunk_allocation.handle);
+        #endif
+
+            return chunk_allocation;
+        }
+
+        // chunk from regions [first_region, last_region), cached one goes first
+        // chunk is committed unless commit is false: arena commits it by itself then (see FastArenaView::acquire())
+        // cached chunk may have been left partially committed by such arena so it is committed again (no-op for committed pages)
+        // chunk is not accounted to the tla: caller decides who owns it
+        [[nodiscard]] RegionChunkAllocation fetch_chunk_(ThreadLocalAllocator* tla, uint32 first_region, uint32 last_region, bool commit) {
             // try to get cached one
-            for (uint32 curr_region = region; curr_region <= conf_max_cached_chunk_size_id; curr_region++) {
-                if (tla->cached_chunks[curr_region]) {
-                    // chunk already committed
-                    return std::exchange(tla->cached_chunks[curr_region], null_region_chunk_allocation);
+            for (uint32 curr_region = first_region; curr_region <= conf_max_cached_chunk_size_id && curr_region < last_region; curr_region++) {
+                if (auto chunk_allocation = chunk_cache.get(rca, curr_region, tla->thread_id)) {
+                    if (commit && !commit_chunk_(rca.chunk_allocation_to_memory(chunk_allocation))) {
+                        release_chunk_(chunk_allocation);
+                        return null_region_chunk_allocation;
+                    }
+                    return chunk_allocation;
                 }
             }
 
             // try to allocate new chunk
-            for (uint32 curr_region = region; curr_region < rca.get_num_regions(); curr_region++) {
-                RegionChunkAllocParams alloc_params{};
-                alloc_params.rounds = 4;
-                alloc_params.attempts = -1;
-                alloc_params.split_step = 1;
-                alloc_params.split_start = tla->last_chunk_pool_split_id[curr_region];
-                if (auto chunk_allocation = rca.allocate_chunk(curr_region,  alloc_params)) {
-                    tla->last_chunk_pool_split_id[curr_region] = chunk_allocation.split; // update split
-                    tla->total_chunk_storage_size += rca.get_region_spec(curr_region).get_chunk_size(); // pump up the usage
-
+            for (uint32 curr_region = first_region; curr_region < last_region; curr_region++) {
+                if (auto chunk_allocation = allocate_fresh_chunk_(tla, curr_region)) {
                     auto chunk_memory = rca.chunk_allocation_to_memory(chunk_allocation);
-                    if (!vmem_commit(chunk_memory.chunk, chunk_memory.chunk_size)) {
+                    if (!reserve_end_map_segment_(chunk_memory.chunk) || (commit && !commit_chunk_(chunk_memory))) {
                         rca.deallocate_chunk(chunk_allocation);
                         return null_region_chunk_allocation;
                     }
-
-                #ifdef CUW3_ENABLE_DEBUG_CODE
-                    set_handle_owner(tla, chunk_allocation.handle);
-                #endif
-
                     return chunk_allocation;
                 }
             }
             return null_region_chunk_allocation;
         }
 
+        // thread sticks to the split it got its chunk from unless it lost cas races there,
+        // then it hops away with its own odd step so threads that collided do not collide again
+        void update_chunk_pool_split_(ThreadLocalAllocator* tla, uint32 region, uint32 split, uint32 cas_failures) {
+            if (cas_failures) {
+                split = rca.next_pool_split(split, (uint32)(tla->thread_id << 1) | 1);
+            }
+            tla->last_chunk_pool_split_id[region] = split;
+        }
+
+        // chunk straight from the region pools, small ones go through the thread chunk magazine
+        [[nodiscard]] RegionChunkAllocation allocate_fresh_chunk_(ThreadLocalAllocator* tla, uint32 region) {
+            uint32 cas_failures = 0;
+            RegionChunkAllocParams alloc_params{};
+            alloc_params.rounds = 4;
+            alloc_params.attempts = -1;
+            alloc_params.split_step = 1;
+            alloc_params.split_start = tla->last_chunk_pool_split_id[region];
+            alloc_params.cas_failures = &cas_failures;
+
+            if (conf_chunk_magazine_size && region <= conf_max_magazine_chunk_size_id) {
+                auto& magazine = tla->chunk_magazines[region];
+                if (magazine.empty()) {
+                    magazine.count = rca.allocate_chunks(region, conf_chunk_magazine_size, alloc_params, magazine.chunks);
+                    if (magazine.empty()) {
+                        return null_region_chunk_allocation;
+                    }
+                    update_chunk_pool_split_(tla, region, magazine.chunks[0].split, cas_failures);
+                }
+                return magazine.pop();
+            }
+
+            auto chunk_allocation = rca.allocate_chunk(region, alloc_params);
+            if (chunk_allocation) {
+                update_chunk_pool_split_(tla, region, chunk_allocation.split, cas_failures);
+            }
+            return chunk_allocation;
+        }
+
+        // gives unused fresh chunks back to the region pools, must be done before tla is destroyed
+        void flush_chunk_magazines(ThreadLocalAllocator* tla) {
+            for (auto& magazine : tla->chunk_magazines) {
+                rca.deallocate_chunk_chain(magazine.chunks, magazine.count);
+                magazine.count = 0;
+            }
+        }
+
         void deallocate_chunk_(ThreadLocalAllocator* tla, RegionChunkAllocation chunk_allocation) {
+            tla->total_chunk_storage_size -= rca.get_region_spec(chunk_allocation.region).get_chunk_size();
+
+        #ifdef CUW3_ENABLE_DEBUG_CODE
+            reset_handle_owner(tla, chunk_allocation.handle);
+        #endif
+
             // try to cache it at first, no need to decommit
             if (chunk_allocation.region <= conf_max_cached_chunk_size_id) {
-                if (!tla->cached_chunks[chunk_allocation.region]) {
-                    tla->cached_chunks[chunk_allocation.region] = chunk_allocation;
+                if (chunk_cache.put(rca, chunk_allocation, tla->thread_id)) {
                     return;
                 }
             }
+            release_chunk_(chunk_allocation);
+        }
 
-            // decommit & deallocate
+        // decommit & deallocate
+        void release_chunk_(RegionChunkAllocation chunk_allocation) {
             auto chunk_memory = rca.chunk_allocation_to_memory(chunk_allocation);
-            vmem_decommit(chunk_memory.chunk, chunk_memory.chunk_size);
-            tla->total_chunk_storage_size -= chunk_memory.chunk_size;
+            decommit_chunk_(chunk_memory);
+            purge_end_map_(chunk_memory);
+            rca.deallocate_chunk(chunk_allocation);
+        }
 
-        #ifdef CUW3_ENABLE_DEBUG_CODE
-            reset_handle_owner(tla, rca.index_from_handle(arena));
-        #endif
+        // map of the dead arena is zeroed already, we only give its pages back (summary is too small to bother)
+        void purge_end_map_(RegionChunkMemory chunk_memory) {
+            uint64 end_map_size = chunk_memory.chunk_size / fast_arena_end_map_ratio;
+            if (is_aligned(end_map_size, vmem_page_size())) {
+                vmem_purge(chunk_end_map_(chunk_memory.chunk), end_map_size, VMemPurgeDontNeed);
+            }
+        }
 
-            rca.deallocate_chunk(chunk_allocation);
+        uint64* chunk_end_map_(void* chunk) {
+            uint64 offset = rca.ptr_to_offset(chunk);
+            if (!end_map_segments) {
+                return end_map + offset / fast_arena_end_map_word_span;
+            }
+            return (uint64*)end_map_segment_(offset) + modpow2(offset, rca_specs.segment_size_log2) / fast_arena_end_map_word_span;
+        }
+
+        uint64* chunk_end_map_summary_(void* chunk) {
+            uint64 offset = rca.ptr_to_offset(chunk);
+            if (!end_map_segments) {
+                return end_map_summary + offset / fast_arena_end_map_summary_word_span;
+            }
+            auto* summary = (uint64*)advance_ptr(end_map_segment_(offset), AllocatorMemoryBundle::end_map_size(intpow2(rca_specs.segment_size_log2)));
+            return summary + modpow2(offset, rca_specs.segment_size_log2) / fast_arena_end_map_summary_word_span;
+        }
+
+        // end map of the segment must have been reserved when the chunk was allocated
+        void* end_map_segment_(uint64 offset) {
+            void* segment_end_map = std::atomic_ref{end_map_segments[divpow2(offset, rca_specs.segment_size_log2)]}.load(std::memory_order_acquire);
+            CUW3_CHECK(segment_end_map, "end map of the segment is not reserved");
+            return segment_end_map;
+        }
+
+        uint64 end_map_segment_size_() const {
+            uint64 segment_size = intpow2(rca_specs.segment_size_log2);
+            return AllocatorMemoryBundle::end_map_size(segment_size) + AllocatorMemoryBundle::end_map_summary_size(segment_size);
         }
 
-        [[nodiscard]] FastArena* construct_arena_(ThreadLocalAllocator* tla, RegionChunkMemory chunk_memory, uint64 alignment, uint64 type) {
+        // same protocol as the region segments: whoever publishes first wins, the rest give their reservation back
+        [[nodiscard]] bool reserve_end_map_segment_(void* chunk) {
+            if (!end_map_segments) {
+                return true;
+            }
+
+            auto segment_ref = std::atomic_ref{end_map_segments[divpow2(rca.ptr_to_offset(chunk), rca_specs.segment_size_log2)]};
+            if (segment_ref.load(std::memory_order_acquire)) {
+                return true;
+            }
+
+            // only touched parts of the end map are ever backed by pages
+            void* segment_end_map = vmem_alloc(end_map_segment_size_(), (VMemAllocType)(VMemReserveCommit | VMemNoReserve));
+            if (!segment_end_map) {
+                return segment_ref.load(std::memory_order_acquire);
+            }
+
+            void* expected = nullptr;
+            if (!segment_ref.compare_exchange_strong(expected, segment_end_map, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                vmem_free(segment_end_map, end_map_segment_size_());
+            }
+            return true;
+        }
+
+        void release_end_map_segments_() {
+            if (!end_map_segments) {
+                return;
+            }
+            for (uint64 segment = 0; segment < rca_specs.num_segments; segment++) {
+                if (end_map_segments[segment]) {
+                    vmem_free(end_map_segments[segment], end_map_segment_size_());
+                    end_map_segments[segment] = nullptr;
+                }
+            }
+        }
+
+        // only mprotect commit pays for every committed byte up front
+        bool incremental_commit_() const {
+            return chunk_commit_mode == ChunkCommitMode::Protect && conf_arena_commit_step;
+        }
+
+        [[nodiscard]] bool commit_chunk_(RegionChunkMemory chunk_memory) {
+            if (chunk_commit_mode == ChunkCommitMode::Protect) {
+                return vmem_commit(chunk_memory.chunk, chunk_memory.chunk_size);
+            }
+            return true; // already accessible, pages are committed on the first touch
+        }
+
+        void decommit_chunk_(RegionChunkMemory chunk_memory) {
+            switch (chunk_commit_mode) {
+                case ChunkCommitMode::Protect:
+                    vmem_decommit(chunk_memory.chunk, chunk_memory.chunk_size);
+                    break;
+                case ChunkCommitMode::LazyFree:
+                    vmem_purge(chunk_memory.chunk, chunk_memory.chunk_size, VMemPurgeFree);
+                    break;
+                case ChunkCommitMode::LazyDontNeed:
+                    vmem_purge(chunk_memory.chunk, chunk_memory.chunk_size, VMemPurgeDontNeed);
+                    break;
+            }
+        }
+
+        // decommits cached chunks above the low watermark
+        void trim_chunk_cache(uint32 shard_hint = 0) {
+            for (uint32 region = 0; region <= conf_max_cached_chunk_size_id && region < rca.get_num_regions(); region++) {
+                uint64 watermark = chunk_cache.get_low_watermark(region);
+                while (auto chunk_allocation = chunk_cache.trim(rca, region, watermark, shard_hint)) {
+                    release_chunk_(chunk_allocation);
+                }
+            }
+        }
+
+        // decommits cached chunks of idle regions according to the decay curve, now is in ms
+        // then unmaps cached large spans (whole spans, so it may overshoot a little)
+        // stops as soon as max_bytes were released, returns amount of bytes released
+        uint64 purge_chunk_cache(uint64 now, uint64 max_bytes) {
+            uint64 released{};
+            for (uint32 region = 0; region <= conf_max_cached_chunk_size_id && region < rca.get_num_regions(); region++) {
+                uint64 chunk_size = rca.get_region_spec(region).get_chunk_size();
+                uint64 watermark = chunk_cache.update_decay_watermark(region, now);
+                while (released + chunk_size <= max_bytes) {
+                    auto chunk_allocation = chunk_cache.trim(rca, region, watermark);
+                    if (!chunk_allocation) {
+                        break;
+                    }
+                    release_chunk_(chunk_allocation);
+                    released += chunk_size;
+                }
+            }
+            if (released < max_bytes) {
+                released += large_allocator.release_cached_spans(max_bytes - released);
+            }
+            return released;
+        }
+
+        // failed cas attempts on the free lists of all region pools, diagnostics only
+        uint64 chunk_pool_cas_failures() {
+            uint64 failures{};
+            for (uint32 region = 0; region < rca.get_num_regions(); region++) {
+                for (uint32 split = 0; split < rca.num_pool_splits(); split++) {
+                    failures += rca.pool_cas_failures(region, split);
+                }
+            }
+            return failures;
+        }
+
+        [[nodiscard]] FastArena* construct_arena_(ThreadLocalAllocator* tla, RegionChunkMemory chunk_memory, uint64 alignment, uint64 type, bool incremental_commit) {
             FastArenaConfig config{};
             config.owner = tla;
             config.arena_type = type;
             config.arena_alignment = alignment;
             config.arena_memory = chunk_memory.chunk;
             config.arena_memory_size = chunk_memory.chunk_size;
-            config.retire_reclaim_flags = (uint64)RetireReclaimFlags::RetiredFlag;
+            config.retire_reclaim_flags = 0; // first retirer must put arena into the retired list
+            config.end_map = chunk_end_map_(chunk_memory.chunk);
+            config.end_map_summary = chunk_end_map_summary_(chunk_memory.chunk);
+            config.incremental_commit = incremental_commit;
             return FastArenaView::create(Memory::from(chunk_memory.handle, chunk_memory.handle_size), config);
         }
 
         // TODO : remake this logic, fused allocate + create, destroy + deallocate seems better ... or maybe postpone it to refactoring phase
-        void destroy_arena_(ThreadLocalAllocator* tla, FastArena* arena) {}
+        void destroy_arena_(ThreadLocalAllocator* tla, FastArena* arena) {
+            auto chunk_allocation = rca.ptr_to_allocation(arena->arena_memory);
+            CUW3_CHECK(chunk_allocation, "Attempt to deallocate invalid chunk");
+
+            auto* header = (RegionChunkHandleHeader*)rca.handle_from_index(chunk_allocation.handle);
+            if (header->data() == (uint64)RegionChunkType::SubChunkArenas) {
+                tla->total_chunk_storage_size -= FastArenaView{arena}.memory_size();
+                sub_arena_pool.release(rca, arena, chunk_allocation.handle);
+                return;
+            }
+            deallocate_chunk_(tla, chunk_allocation);
+        }
+
+        // slot is taken from the shared pool, pool grows by a whole chunk when it is empty
+        [[nodiscard]] FastArena* acquire_new_sub_arena_(ThreadLocalAllocator* tla, uint64 alignment, uint64 arena_type) {
+            auto slot_memory = sub_arena_pool.acquire(rca);
+            if (!slot_memory) {
+                auto chunk_allocation = fetch_chunk_(tla, 0, 1, true);
+                if (!chunk_allocation) {
+                    return nullptr;
+                }
+                slot_memory = sub_arena_pool.add_chunk(rca, rca.chunk_allocation_to_memory(chunk_allocation), chunk_allocation.handle);
+            }
+            tla->total_chunk_storage_size += slot_memory.chunk_size;
+
+            auto* arena = construct_arena_(tla, slot_memory, alignment, arena_type, false);
+            CUW3_CHECK(arena, "failed to construct sub-chunk arena");
+            return arena;
+        }
 
+        // small arenas of small threads are carved from the shared sub-chunks
+        // thread graduates to whole chunks once its chunk storage reaches the pool thread limit
         [[nodiscard]] FastArena* acquire_new_arena_(ThreadLocalAllocator* tla, uint64 size, uint64 alignment, uint64 arena_type) {
+            if (arena_type == (uint64)RegionChunkType::FastArenaSmallAllocator && sub_arena_pool.can_allocate(tla->total_chunk_storage_size, size, alignment)) {
+                if (auto* arena = acquire_new_sub_arena_(tla, alignment, arena_type)) {
+                    return arena;
+                }
+            }
+
             auto chunk_allocation = allocate_chunk_(tla, size, alignment);
             if (!chunk_allocation) {
                 return nullptr;
             }
 
             auto chunk_memory = rca.chunk_allocation_to_memory(chunk_allocation);
-            auto* arena = construct_arena_(tla, chunk_memory, alignment, arena_type);
+            auto* arena = construct_arena_(tla, chunk_memory, alignment, arena_type, incremental_commit_());
             CUW3_CHECK(arena, "failed to construct small arena");
             return arena;
         }
 
+        [[nodiscard]] SlabChunk* construct_slab_chunk_(ThreadLocalAllocator* tla, RegionChunkMemory chunk_memory) {
+            SlabChunkConfig config{};
+            config.owner = tla;
+            config.chunk_memory = chunk_memory.chunk;
+            config.chunk_memory_size = chunk_memory.chunk_size;
+            config.retire_reclaim_flags = 0;
+            return SlabChunkView::create(Memory::from(chunk_memory.handle, chunk_memory.handle_size), config);
+        }
+
+        // slab pages are small so we do not scale chunk size with total usage: smallest chunk is enough
+        [[nodiscard]] SlabChunk* acquire_new_slab_chunk_(ThreadLocalAllocator* tla) {
+            auto chunk_allocation = allocate_chunk_demand_(tla, rca.get_min_chunk_size(), true);
+            if (!chunk_allocation) {
+                return nullptr;
+            }
+
+            auto chunk_memory = rca.chunk_allocation_to_memory(chunk_allocation);
+            auto* chunk = construct_slab_chunk_(tla, chunk_memory);
+            CUW3_CHECK(chunk, "failed to construct slab chunk");
+            return chunk;
+        }
+
+        void release_slab_chunk_(ThreadLocalAllocator* tla, SlabChunk* chunk) {
+            auto chunk_allocation = rca.ptr_to_allocation(chunk->chunk_memory);
+            CUW3_CHECK(chunk_allocation, "Attempt to deallocate invalid chunk");
+            deallocate_chunk_(tla, chunk_allocation);
+        }
+
+        // block may be in the tcache so we do not know its chunk yet
+        void release_slab_block_(ThreadLocalAllocator* tla, void* block) {
+            auto chunk_allocation = rca.ptr_to_allocation(block);
+            CUW3_CHECK(chunk_allocation, "attempt to release invalid block");
+
+            auto chunk_memory = rca.chunk_allocation_to_memory(chunk_allocation);
+            auto* released_chunk = tla->slab_allocator.deallocate((SlabChunk*)chunk_memory.handle, block, 0);
+            if (released_chunk) {
+                release_slab_chunk_(tla, released_chunk);
+            }
+        }
+
+        // scoped arena chunks are plain committed chunks of the tla, released ones go to the chunk cache
+        [[nodiscard]] ScopedArenaChunk* acquire_scoped_arena_chunk_(ThreadLocalAllocator* tla, uint64 demand) {
+            auto chunk_allocation = allocate_chunk_demand_(tla, demand, true);
+            if (!chunk_allocation) {
+                return nullptr;
+            }
+
+            ScopedArenaChunkConfig config{};
+            config.owner = tla;
+            config.chunk_memory = rca.chunk_allocation_to_memory(chunk_allocation);
+            config.chunk_allocation = chunk_allocation;
+            auto* chunk = ScopedArenaChunkView::create(Memory::from(config.chunk_memory.handle, config.chunk_memory.handle_size), config);
+            CUW3_CHECK(chunk, "failed to construct scoped arena chunk");
+            return chunk;
+        }
+
+        void release_scoped_arena_chunk_(ThreadLocalAllocator* tla, ScopedArenaChunk* chunk) {
+            CUW3_POISON_MEMORY_REGION(chunk->chunk_memory, chunk->chunk_memory_size);
+            deallocate_chunk_(tla, chunk->chunk_allocation);
+        }
+
+        // size is the amount of memory the arena is expected to take, the first chunk is picked by it
+        [[nodiscard]] ScopedArena* create_scoped_arena(ThreadLocalAllocator* tla, uint64 size) {
+            auto* chunk = acquire_scoped_arena_chunk_(tla, sizeof(ScopedArena) + size);
+            if (!chunk) {
+                return nullptr;
+            }
+            auto* arena = ScopedArenaView::create(chunk);
+            CUW3_CHECK(arena, "failed to construct scoped arena");
+            return arena;
+        }
+
+        // pointer bump first, a new chunk is chained when the current one is full
+        // every next chunk is at least twice as big as the current one (up to the max chunk size)
+        // any alignment is served by padding: fresh chunk has room for the worst case one
+        [[nodiscard]] void* scoped_arena_allocate(ScopedArena* arena, uint64 size, uint64 alignment) {
+            if (!is_alignment(alignment) || size > rca.get_max_chunk_size() || alignment > rca.get_max_chunk_size()) {
+                return nullptr;
+            }
+
+            auto arena_view = ScopedArenaView{arena};
+            if (void* mem = arena_view.acquire(size, alignment)) {
+                return mem;
+            }
+
+            uint64 demand = std::max(std::max<uint64>(size, 1) + alignment - 1, std::min(rca.get_max_chunk_size(), 2 * arena->chunk->chunk_memory_size));
+            auto* chunk = acquire_scoped_arena_chunk_((ThreadLocalAllocator*)arena->owner, demand);
+            if (!chunk) {
+                return nullptr;
+            }
+            arena_view.push_chunk(chunk);
+
+            void* mem = arena_view.acquire(size, alignment);
+            CUW3_CHECK(mem, "fresh scoped arena chunk is too small");
+            return mem;
+        }
+
+        // chunks above the mark go back at once
+        void rewind_scoped_arena(ScopedArena* arena, void* mark) {
+            auto arena_view = ScopedArenaView{arena};
+            while (auto* chunk = arena_view.pop_chunk_above(mark)) {
+                release_scoped_arena_chunk_((ThreadLocalAllocator*)arena->owner, chunk);
+            }
+            arena_view.set_top(mark);
+        }
+
+        // arena lives in its first chunk so it is gone as well
+        void destroy_scoped_arena(ScopedArena* arena) {
+            auto* tla = (ThreadLocalAllocator*)arena->owner;
+            for (auto* chunk = arena->chunk; chunk; ) {
+                auto* prev = chunk->prev;
+                release_scoped_arena_chunk_(tla, chunk);
+                chunk = prev;
+            }
+        }
+
+        // keeps first 'keep' (hottest) blocks in the bin, flushes the rest back into the slab allocator
+        void flush_tcache_bin_(ThreadLocalAllocator* tla, uint64 size_class, uint64 keep) {
+            void* block = tla->tcache.detach_tail(size_class, keep);
+            while (block) {
+                void* next = *(void**)block;
+                release_slab_block_(tla, block);
+                block = next;
+            }
+        }
+
+        void deallocate_slab_owner_(ThreadLocalAllocator* tla, SlabChunk* chunk, void* ptr, uint64 size) {
+            auto size_class = tla->tcache.locate_size_class(size, conf_min_alloc_alignment);
+            if (size_class != slab_null_size_class) {
+                if (tla->tcache.full(size_class)) {
+                    flush_tcache_bin_(tla, size_class, tla->tcache.bin_capacity - tla->tcache.flush_batch);
+                }
+                tla->tcache.push(size_class, ptr);
+                return;
+            }
+
+            auto* released_chunk = tla->slab_allocator.deallocate(chunk, ptr, size);
+            if (released_chunk) {
+                release_slab_chunk_(tla, released_chunk);
+            }
+        }
+
+        [[nodiscard]] AcquiredResource allocate_slab_allocator_(ThreadLocalAllocator* tla, uint64 size, uint64 alignment) {
+            auto acquired_res = tla->slab_allocator.allocate(size, alignment);
+            if (acquired_res.status_no_resource()) {
+                auto* chunk = acquire_new_slab_chunk_(tla);
+                if (!chunk) {
+                    return AcquiredResource::no_resource();
+                }
+                tla->slab_allocator.add_chunk(chunk);
+                return tla->slab_allocator.allocate(size, alignment);
+            }
+            return acquired_res;
+        }
+
         [[nodiscard]] AcquiredResource allocate_small_allocator_(ThreadLocalAllocator* tla, uint64 size, uint64 alignment) {
             auto acquired_res = tla->small_allocator.acquire(size, alignment);
             if (acquired_res.status_no_resource()) {
@@ -283,18 +825,108 @@ namespace cuw3 {
             return AcquiredResource::failed();
         }
 
+        // blocks of a batch are carved from one arena until it runs out of room, returns zero if no arena could be acquired
+        [[nodiscard]] uint64 allocate_small_allocator_batch_(ThreadLocalAllocator* tla, uint64 size, uint64 alignment, uint64 n, void** out) {
+            auto acquired_res = tla->small_allocator.acquire(size, alignment);
+            if (acquired_res.status_no_resource()) {
+                auto* arena = acquire_new_arena_(tla, size, alignment, (uint64)RegionChunkType::FastArenaSmallAllocator);
+                if (!arena) {
+                    return 0;
+                }
+                return tla->small_allocator.allocate_batch(arena, size, n, out);
+            }
+            if (acquired_res.status_acquired()) {
+                return tla->small_allocator.allocate_batch(acquired_res.get(), size, n, out);
+            }
+            return 0;
+        }
+
+        [[nodiscard]] uint64 allocate_step_split_allocator_batch_(ThreadLocalAllocator* tla, uint64 size, uint64 alignment, uint64 n, void** out) {
+            auto acquired_res = tla->step_split_allocator.acquire_arena(size, alignment);
+            if (acquired_res.status_no_resource()) {
+                auto* arena = acquire_new_arena_(tla, size, alignment, (uint64)RegionChunkType::FastArenaStepSplitAllocator);
+                if (!arena) {
+                    return 0;
+                }
+                return tla->step_split_allocator.allocate_batch(arena, size, n, out);
+            }
+            if (acquired_res.status_acquired()) {
+                return tla->step_split_allocator.allocate_batch(acquired_res.get(), size, n, out);
+            }
+            return 0;
+        }
+
+        // alignment above the max arena alignment: arena is acquired for the worst case padding
+        // so allocation never fails once we have the arena, padding is charged to the arena freed counter
+        // worst case padded size within the small allocator cutoff goes to the small allocator
+        // so with alignment-agnostic arenas all alignments share the same arenas
+        [[nodiscard]] AcquiredResource allocate_padded_(ThreadLocalAllocator* tla, uint64 size, uint64 alignment) {
+            uint64 size_cutoff = tla->small_allocator.get_size_cutoff();
+            if (uint64 arena_alignment = tla->small_allocator.get_max_alignment(); size <= size_cutoff && alignment - arena_alignment <= size_cutoff - size) {
+                uint64 padded_size = size + alignment - arena_alignment;
+                auto acquired_res = tla->small_allocator.acquire(padded_size, arena_alignment);
+                if (acquired_res.status_no_resource()) {
+                    auto* arena = acquire_new_arena_(tla, padded_size, arena_alignment, (uint64)RegionChunkType::FastArenaSmallAllocator);
+                    if (!arena) {
+                        return AcquiredResource::no_resource();
+                    }
+                    return AcquiredResource::acquired(tla->small_allocator.allocate_padded(arena, size, alignment));
+                }
+                if (acquired_res.status_acquired()) {
+                    return AcquiredResource::acquired(tla->small_allocator.allocate_padded(acquired_res.get(), size, alignment));
+                }
+                return AcquiredResource::failed();
+            }
+
+            uint64 arena_alignment = tla->step_split_allocator.get_max_alignment();
+            uint64 max_size = tla->step_split_allocator.get_max_alloc_size();
+            if (alignment > rca.get_max_chunk_size()) {
+                return AcquiredResource::failed();
+            }
+            if (size > max_size || alignment - arena_alignment > max_size - size) {
+                return allocate_large_(size, alignment);
+            }
+
+            uint64 padded_size = size + alignment - arena_alignment;
+            auto acquired_res = tla->step_split_allocator.acquire_arena(padded_size, arena_alignment);
+            if (acquired_res.status_no_resource()) {
+                auto* arena = acquire_new_arena_(tla, padded_size, arena_alignment, (uint64)RegionChunkType::FastArenaStepSplitAllocator);
+                if (!arena) {
+                    return AcquiredResource::no_resource();
+                }
+                return AcquiredResource::acquired(tla->step_split_allocator.allocate_padded(arena, size, alignment));
+            }
+            if (acquired_res.status_acquired()) {
+                return AcquiredResource::acquired(tla->step_split_allocator.allocate_padded(acquired_res.get(), size, alignment));
+            }
+            return AcquiredResource::failed();
+        }
+
         
+        // above the max chunk size: dedicated span, no thread local state involved
+        [[nodiscard]] AcquiredResource allocate_large_(uint64 size, uint64 alignment) {
+            if (void* span = large_allocator.allocate(size, alignment)) {
+                return AcquiredResource::acquired(span);
+            }
+            return AcquiredResource::failed();
+        }
+
+        // arena and slab chunk share the handle header so owner and type can be read before we know the actual type
         struct DeallocationContext {
             RegionChunkAllocation chunk_allocation{};
             RegionChunkMemory chunk_memory{};
             FastArena* arena{};
             ThreadLocalAllocator* arena_tla{};
+            uint64 type{};
         };
 
         void deallocate_owner_(ThreadLocalAllocator* tla, const DeallocationContext& context, void* ptr, uint64 size) {
             FastArena* released_arena{};
-            auto type = FastArenaView{context.arena}.type();
-            if (type == (uint64)RegionChunkType::FastArenaSmallAllocator) {
+            auto type = context.type;
+            if (type == (uint64)RegionChunkType::SlabAllocator) {
+                deallocate_slab_owner_(tla, (SlabChunk*)context.chunk_memory.handle, ptr, size);
+                return;
+            } else if (type == (uint64)RegionChunkType::FastArenaSmallAllocator) {
                 released_arena = tla->small_allocator.deallocate(context.arena, ptr, size);                
             } else if (type == (uint64)RegionChunkType::FastArenaStepSplitAllocator) {
                released_arena = tla->step_split_allocator.deallocate(context.arena, ptr, size);                
@@ -302,19 +934,61 @@ namespace cuw3 {
                 CUW3_ABORT_CRITICAL("Invalid arena type detected");
             }
             if (released_arena) {
-                destroy_arena_(tla, released_arena); // TODO : smelly place, must be rewritten
+                destroy_arena_(tla, released_arena);
+            }
+        }
 
-                auto chunk_allocation = rca.ptr_to_allocation(released_arena->arena_memory);
-                CUW3_CHECK(chunk_allocation, "Attempt to deallocate invalid chunk");
-                deallocate_chunk_(tla, chunk_allocation);
+        // publishes all frees of the batch into the chunk owner with one retire
+        void publish_remote_batch_(const RemoteFreeBatch& batch) {
+            auto* header = (RegionChunkHandleHeader*)batch.handle;
+            auto* owner = (ThreadLocalAllocator*)header->owner();
+            auto type = header->data();
+            if (type == (uint64)RegionChunkType::SlabAllocator) {
+                (void)owner->slab_allocator.retire_chain((SlabChunk*)batch.handle, batch.head, batch.tail);
+            } else if (type == (uint64)RegionChunkType::FastArenaSmallAllocator) {
+                (void)owner->small_allocator.retire_batch((FastArena*)batch.handle, batch.size);
+            } else if (type == (uint64)RegionChunkType::FastArenaStepSplitAllocator) {
+                (void)owner->step_split_allocator.retire_batch((FastArena*)batch.handle, batch.size);
+            } else {
+                CUW3_ABORT_CRITICAL("Invalid arena type detected");
+            }
+        }
+
+        // free is buffered in the tla of the freeing thread, batch is published once it is full or its slot is required
+        void deallocate_remote_(ThreadLocalAllocator* tla, const DeallocationContext& context, void* ptr, uint64 size) {
+            auto& buffer = tla->remote_frees;
+
+            auto* handle = context.chunk_memory.handle;
+            auto* batch = buffer.find(handle);
+            if (!batch) {
+                publish_remote_batch_(buffer.detach(buffer.victim()));
+                batch = buffer.find(handle);
+                CUW3_CHECK(batch, "slot must have been freed");
+            }
+
+            if (context.type == (uint64)RegionChunkType::SlabAllocator) {
+                buffer.push(batch, ptr, 0);
+            } else {
+                buffer.push(batch, nullptr, FastArenaView{context.arena}.defer_retire_allocation(ptr, size));
+            }
+
+            if (buffer.full(batch)) {
+                publish_remote_batch_(buffer.detach(batch));
             }
         }
 
         // we dont care here about the retire-reclaim flags
         // we could have cared, in fact and it would have made our life kind of ... easier?
         void deallocate_non_owner_(ThreadLocalAllocator* tla, const DeallocationContext& context, void* ptr, uint64 size) {
-            auto type = FastArenaView{context.arena}.type();
-            if (type == (uint64)RegionChunkType::FastArenaSmallAllocator) {
+            if (tla->remote_frees.enabled()) {
+                deallocate_remote_(tla, context, ptr, size);
+                return;
+            }
+
+            auto type = context.type;
+            if (type == (uint64)RegionChunkType::SlabAllocator) {
+                (void)context.arena_tla->slab_allocator.retire((SlabChunk*)context.chunk_memory.handle, ptr, size);
+            } else if (type == (uint64)RegionChunkType::FastArenaSmallAllocator) {
                 (void)context.arena_tla->small_allocator.retire(context.arena, ptr, size);
             } else if (type == (uint64)RegionChunkType::FastArenaStepSplitAllocator) {
                 (void)context.arena_tla->step_split_allocator.retire(context.arena, ptr, size);
@@ -323,11 +997,36 @@ namespace cuw3 {
             }
         }
 
+        [[nodiscard]] DeallocationContext deallocation_context_(void* ptr) {
+            auto chunk_allocation = rca.ptr_to_allocation(ptr);
+            CUW3_CHECK(chunk_allocation, "attempt to deallocate invalid pointer");
+
+            auto chunk_memory = rca.region_data_to_memory(chunk_allocation.region, chunk_allocation.chunk, chunk_allocation.handle);
+            auto* header = (RegionChunkHandleHeader*)chunk_memory.handle;
+            if (header->data() == (uint64)RegionChunkType::SubChunkArenas) {
+                // arena control block acts as a handle from now on: remote batches are keyed by it
+                auto* arena = SubChunkArenaChunkView{(SubChunkArenaChunk*)chunk_memory.handle}.arena_from_ptr(ptr);
+                chunk_memory.handle = arena;
+                header = (RegionChunkHandleHeader*)arena;
+            }
+            auto* arena = (FastArena*)chunk_memory.handle;
+            auto* arena_tla = (ThreadLocalAllocator*)header->owner();
+            return DeallocationContext{chunk_allocation, chunk_memory, arena, arena_tla, header->data()};
+        }
+
+        // slab block size comes from its page, arena allocation size comes from the arena end map
+        uint64 allocation_size_(const DeallocationContext& context, void* ptr) {
+            if (context.type == (uint64)RegionChunkType::SlabAllocator) {
+                return SlabChunkView{(SlabChunk*)context.chunk_memory.handle}.block_size(ptr);
+            }
+            return FastArenaView{context.arena}.allocation_size(ptr);
+        }
+
         void deallocate_(ThreadLocalAllocator* tla, const DeallocationContext& context, void* ptr, uint64 size) {
             if (tla == context.arena_tla) {
                 deallocate_owner_(tla, context, ptr, size);
             } else {
-                deallocate_non_owner_(context.arena_tla, context, ptr, size);
+                deallocate_non_owner_(tla, context, ptr, size);
             }
         }
 
@@ -342,6 +1041,17 @@ namespace cuw3 {
             }
         }
 
+        void reclaim_slab_allocator_(ThreadLocalAllocator* tla) {
+            auto reclaim_list = tla->slab_allocator.reclaim_chunks();
+            while (reclaim_list) {
+                auto* chunk = reclaim_list.pop();
+                auto* released_chunk = tla->slab_allocator.reclaim_chunk(chunk);
+                if (released_chunk) {
+                    release_slab_chunk_(tla, released_chunk);
+                }
+            }
+        }
+
         void reclaim_step_split_allocator_(ThreadLocalAllocator* tla) {
             auto reclaim_list = tla->step_split_allocator.reclaim_arenas();
             while (reclaim_list) {
@@ -354,50 +1064,285 @@ namespace cuw3 {
         }
 
 
+        // tcache only parts of allocate() and deallocate(), inlined into the caller by cuw3/fast_path.hpp
+        // nullptr / false means nothing was done: caller goes through the full path then
+        [[nodiscard]] void* try_allocate_cached(ThreadLocalAllocator* tla, uint64 size, uint64 alignment) {
+            if (!is_alignment(alignment)) {
+                return nullptr;
+            }
+            auto size_class = tla->tcache.locate_size_class(size, std::max<uint64>(alignment, conf_min_alloc_alignment));
+            if (size_class == slab_null_size_class) {
+                return nullptr;
+            }
+            return tla->tcache.pop(size_class);
+        }
+
+        // own slab block only, chunk handle is found by the location alone: pool split is not needed to push into the tcache
+        [[nodiscard]] bool try_deallocate_cached(ThreadLocalAllocator* tla, void* ptr, uint64 size) {
+            auto size_class = tla->tcache.locate_size_class(size, conf_min_alloc_alignment);
+            if (size_class == slab_null_size_class || tla->tcache.full(size_class)) {
+                return false;
+            }
+            auto location = rca.ptr_to_location(ptr);
+            if (!location) {
+                return false;
+            }
+            auto chunk_memory = rca.region_data_to_memory(location.region, location.chunk, location.handle);
+            auto* header = (RegionChunkHandleHeader*)chunk_memory.handle;
+            if (header->owner() != tla || header->data() != (uint64)RegionChunkType::SlabAllocator) {
+                return false;
+            }
+            tla->tcache.push(size_class, ptr);
+            return true;
+        }
+
         // NOTE : mostly tla + global context
         [[nodiscard]] AcquiredResource allocate(ThreadLocalAllocator* tla, uint64 size, uint64 alignment) {
             if (!is_alignment(alignment)) {
                 return AcquiredResource::failed();
             }
+            alignment = std::max<uint64>(alignment, conf_min_alloc_alignment); // the only clamp: arenas and arena sizes rely on it further down
             size = std::max<uint64>(size, 1);
 
+            auto tcache_size_class = tla->tcache.locate_size_class(size, alignment);
+            if (tcache_size_class != slab_null_size_class) {
+                if (void* block = tla->tcache.pop(tcache_size_class)) {
+                    return AcquiredResource::acquired(block);
+                }
+            }
+            // small thread does not take whole slab chunks, its small arenas serve slab sizes as well
+            if (tla->slab_allocator.can_allocate(size, alignment) && !sub_arena_pool.serves_thread(tla->total_chunk_storage_size)) {
+                return allocate_slab_allocator_(tla, size, alignment);
+            }
+            if (alignment > tla->step_split_allocator.get_max_alignment()) {
+                return allocate_padded_(tla, size, alignment);
+            }
             if (size <= tla->small_allocator.get_size_cutoff()) {
                 return allocate_small_allocator_(tla, size, alignment);
             }
+            if (size > tla->step_split_allocator.get_max_alloc_size()) {
+                return allocate_large_(size, alignment);
+            }
             return allocate_step_split_allocator_(tla, size, alignment);
         }
 
+        // n blocks of the same size, returns amount of blocks allocated: fewer than n only if memory is exhausted
+        // arena sizes are carved from one arena while it has room so the arena is acquired once per run, not once per block
+        // slab sizes and the rest go block by block
+        [[nodiscard]] uint64 allocate_batch(ThreadLocalAllocator* tla, uint64 size, uint64 alignment, uint64 n, void** out) {
+            if (!is_alignment(alignment)) {
+                return 0;
+            }
+            alignment = std::max<uint64>(alignment, conf_min_alloc_alignment); // same as allocate()
+            size = std::max<uint64>(size, 1);
+
+            bool slab = tla->slab_allocator.can_allocate(size, alignment) && !sub_arena_pool.serves_thread(tla->total_chunk_storage_size);
+            bool small = !slab && alignment <= tla->step_split_allocator.get_max_alignment() && size <= tla->small_allocator.get_size_cutoff();
+            bool step_split = !slab && !small && alignment <= tla->step_split_allocator.get_max_alignment() && size <= tla->step_split_allocator.get_max_alloc_size();
+
+            uint64 count = 0;
+            while (count < n) {
+                uint64 allocated = 0;
+                if (small) {
+                    allocated = allocate_small_allocator_batch_(tla, size, alignment, n - count, out + count);
+                } else if (step_split) {
+                    allocated = allocate_step_split_allocator_batch_(tla, size, alignment, n - count, out + count);
+                } else if (auto res = allocate(tla, size, alignment); res.status_acquired()) {
+                    out[count] = res.get();
+                    allocated = 1;
+                }
+                if (!allocated) {
+                    break;
+                }
+                count += allocated;
+            }
+            return count;
+        }
+
+        // anything outside of the regions can only be a large span
         void deallocate(ThreadLocalAllocator* tla, void* ptr, uint64 size) {
+            if (!rca.belongs_any_region(ptr)) {
+                large_allocator.deallocate(ptr);
+                return;
+            }
             size = std::max<uint64>(size, 1);
+            deallocate_(tla, deallocation_context_(ptr), ptr, size);
+        }
 
-            auto chunk_allocation = rca.ptr_to_allocation(ptr);
-            CUW3_CHECK(chunk_allocation, "attempt to deallocate invalid pointer");
+        // slower than the sized deallocate: size has to be recovered from the chunk metadata
+        void deallocate_unsized(ThreadLocalAllocator* tla, void* ptr) {
+            if (!rca.belongs_any_region(ptr)) {
+                large_allocator.deallocate(ptr);
+                return;
+            }
+            auto context = deallocation_context_(ptr);
+            deallocate_(tla, context, ptr, allocation_size_(context, ptr));
+        }
 
-            auto chunk_memory = rca.region_data_to_memory(chunk_allocation.region, chunk_allocation.chunk, chunk_allocation.handle);
-            auto* arena = (FastArena*)chunk_memory.handle;
-            auto arena_view = FastArenaView{arena};
-            auto* arena_tla = (ThreadLocalAllocator*)arena_view.owner();
+        // following pointers of the batch reuse the context while they stay in the same arena or slab chunk
+        bool context_has_ptr_(const DeallocationContext& context, void* ptr) {
+            if (context.type == (uint64)RegionChunkType::SlabAllocator) {
+                auto offset = subptr(ptr, context.chunk_memory.chunk);
+                return offset >= 0 && (uint64)offset < context.chunk_memory.chunk_size;
+            }
+            return FastArenaView{context.arena}.has_memory_range(ptr, 1);
+        }
 
-            auto context = DeallocationContext{chunk_allocation, chunk_memory, arena, arena_tla};
-            deallocate_(tla, context, ptr, size);
+        // pending frees of one arena or slab chunk within a batch free
+        struct BatchFreeGroup {
+            DeallocationContext context{};
+            uint64 total_size{}; // deferred aligned size of the owner arena
+        };
+
+        // owner arena is released with a single counter update and at most one reset
+        void release_batch_free_group_(ThreadLocalAllocator* tla, BatchFreeGroup& group) {
+            const auto& context = group.context;
+            if (group.total_size) {
+                FastArena* released_arena{};
+                if (context.type == (uint64)RegionChunkType::FastArenaSmallAllocator) {
+                    released_arena = tla->small_allocator.deallocate_batch(context.arena, group.total_size);
+                } else if (context.type == (uint64)RegionChunkType::FastArenaStepSplitAllocator) {
+                    released_arena = tla->step_split_allocator.deallocate_batch(context.arena, group.total_size);
+                } else {
+                    CUW3_ABORT_CRITICAL("Invalid arena type detected");
+                }
+                if (released_arena) {
+                    destroy_arena_(tla, released_arena);
+                }
+            }
+            group = {};
         }
 
-        // NOTE: can be made smarter. We can limit reclamation amount.
-        bool reclaim(ThreadLocalAllocator* tla) {
-            reclaim_small_allocator_(tla);
-            reclaim_step_split_allocator_(tla);
-            return tla->small_allocator.empty() && tla->step_split_allocator.empty();
+        // pointers are bucketed by their arena or slab chunk in a small table (round-robin eviction, like the remote free buffer)
+        // so interleaved pointers still cost one lookup per chunk and one release per owner arena, not one per pointer
+        // * owner arena frees are deferred and released once per group: when it is evicted or at the end,
+        //   live pointers of the batch keep their arena alive meanwhile so cached contexts stay valid
+        // * owner slab blocks go to the tcache one by one, remote frees go through the remote free buffer that batches them anyway
+        // null pointers are skipped
+        void deallocate_batch(ThreadLocalAllocator* tla, void* const* ptrs, const uint64* sizes, uint64 n) {
+            BatchFreeGroup groups[cuw3_batch_free_groups] = {};
+            uint64 used = 0;
+            uint64 last_found = 0;
+            uint64 next_victim = 0;
+            for (uint64 i = 0; i < n; i++) {
+                void* ptr = ptrs[i];
+                if (!ptr) {
+                    continue;
+                }
+                if (!rca.belongs_any_region(ptr)) {
+                    large_allocator.deallocate(ptr);
+                    continue;
+                }
+
+                BatchFreeGroup* group{};
+                if (used && context_has_ptr_(groups[last_found].context, ptr)) {
+                    group = &groups[last_found];
+                }
+                for (uint64 g = 0; !group && g < used; g++) {
+                    if (context_has_ptr_(groups[g].context, ptr)) {
+                        group = &groups[g];
+                        last_found = g;
+                    }
+                }
+                if (!group) {
+                    if (used == cuw3_batch_free_groups) {
+                        last_found = next_victim;
+                        next_victim = (next_victim + 1) % cuw3_batch_free_groups;
+                        release_batch_free_group_(tla, groups[last_found]);
+                    } else {
+                        last_found = used++;
+                    }
+                    group = &groups[last_found];
+                    group->context = deallocation_context_(ptr);
+                }
+
+                const auto& context = group->context;
+                uint64 size = std::max<uint64>(sizes[i], 1);
+                if (tla != context.arena_tla) {
+                    deallocate_non_owner_(tla, context, ptr, size);
+                } else if (context.type == (uint64)RegionChunkType::SlabAllocator) {
+                    deallocate_slab_owner_(tla, (SlabChunk*)context.chunk_memory.handle, ptr, size);
+                } else {
+                    // same first half as the remote retire: allocation is dead, its aligned size is released later
+                    group->total_size += FastArenaView{context.arena}.defer_retire_allocation(ptr, size);
+                }
+            }
+            for (uint64 g = 0; g < used; g++) {
+                release_batch_free_group_(tla, groups[g]);
+            }
+        }
+
+        // allocation keeps its address, it must be freed with new_size then
+        // * arena allocation can grow or shrink only if it is the last one in its arena and only by the owner
+        // * slab block can only be reused as is if both sizes fall into the same size class
+        // * large span can grow or shrink by any thread if its address range allows it
+        [[nodiscard]] bool try_resize(ThreadLocalAllocator* tla, void* ptr, uint64 size, uint64 new_size) {
+            if (!rca.belongs_any_region(ptr)) {
+                return large_allocator.try_resize(ptr, new_size);
+            }
+            size = std::max<uint64>(size, 1);
+            new_size = std::max<uint64>(new_size, 1);
+
+            auto context = deallocation_context_(ptr);
+            auto type = context.type;
+            if (type == (uint64)RegionChunkType::SlabAllocator) {
+                return tla->tcache.locate_size_class(size, conf_min_alloc_alignment) == tla->tcache.locate_size_class(new_size, conf_min_alloc_alignment)
+                    && new_size <= SlabChunkView{(SlabChunk*)context.chunk_memory.handle}.block_size(ptr);
+            }
+            if (tla != context.arena_tla) {
+                return false;
+            }
+            if (type == (uint64)RegionChunkType::FastArenaSmallAllocator) {
+                return tla->small_allocator.resize(context.arena, ptr, size, new_size);
+            } else if (type == (uint64)RegionChunkType::FastArenaStepSplitAllocator) {
+                return tla->step_split_allocator.resize(context.arena, ptr, size, new_size);
+            }
+            CUW3_ABORT_CRITICAL("Invalid arena type detected");
+            return false;
+        }
+
+        // size of the allocation ptr points to, at least the size it was requested with
+        uint64 usable_size(void* ptr) {
+            if (!rca.belongs_any_region(ptr)) {
+                return large_allocator.usable_size(ptr);
+            }
+            return allocation_size_(deallocation_context_(ptr), ptr);
+        }
+
+        // large span is moved along with its pages instead of being copied, nullptr if ptr is not a large span
+        // or it could not be moved, ptr stays valid then
+        [[nodiscard]] void* reallocate_large(void* ptr, uint64 new_size, uint64 alignment) {
+            if (rca.belongs_any_region(ptr)) {
+                return nullptr;
+            }
+            return large_allocator.reallocate(ptr, new_size, alignment);
+        }
+
+        // returns every cached block back to the slab allocator, must be done before tla can be considered empty
+        void flush_tcache(ThreadLocalAllocator* tla) {
+            for (uint64 size_class = 0; size_class < conf_slab_num_size_classes; size_class++) {
+                flush_tcache_bin_(tla, size_class, 0);
+            }
         }
 
-        // TODO : make sane create/destroy model
-        void free_tla_resources(ThreadLocalAllocator* tla) {
-            for (uint32 region = 0; region <= conf_max_cached_chunk_size_id; region++) {
-                if (tla->cached_chunks[region]) {
-                    rca.deallocate_chunk(std::exchange(tla->cached_chunks[region], null_region_chunk_allocation));
+        // publishes every buffered cross-thread free, must be done before tla can be considered empty
+        void flush_remote_frees(ThreadLocalAllocator* tla) {
+            auto& buffer = tla->remote_frees;
+            for (auto& batch : buffer.batches) {
+                if (batch) {
+                    publish_remote_batch_(buffer.detach(&batch));
                 }
             }
         }
 
+        // NOTE: can be made smarter. We can limit reclamation amount.
+        bool reclaim(ThreadLocalAllocator* tla) {
+            reclaim_slab_allocator_(tla);
+            reclaim_small_allocator_(tla);
+            reclaim_step_split_allocator_(tla);
+            return tla->empty();
+        }
+
 
         // NOTE : better be served by thread_graveyard
         // After thread is done its thread-local allocator can only go to the .... graveyard
@@ -481,7 +1426,6 @@ namespace cuw3 {
 
             auto* grave_tla = grave_entry_to_tla(grave.data);
             auto reclaimed = reclaim(grave_tla);
-            free_tla_resources(grave_tla);
             if (reclaimed) {
                 remove_dead_tla_(grave);
                 return grave_tla;
@@ -501,8 +1445,15 @@ namespace cuw3 {
         RegionChunkAllocatorSpecs rca_specs{};
         RegionChunkAllocatorPools rca_pools{};
         RegionChunkAllocator rca{};
+        RegionChunkCache chunk_cache{};
 
         ThreadGraveyard tla_graveyard{};
+        SubChunkArenaPool sub_arena_pool{};
+        LargeAllocator large_allocator{};
+        ChunkCommitMode chunk_commit_mode{}; // readonly
+        uint64* end_map{}; // readonly
+        uint64* end_map_summary{}; // readonly
+        void** end_map_segments{}; // atomic, segmented regions only
 
         alignas(conf_cacheline) uint64 current_thread_id{}; // atomic
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <algorithm>
 
 #include "defs.hpp"
 #include "assert.hpp"
@@ -93,6 +94,28 @@ namespace cuw3 {
             push(-1, node, backoff, node_ops);
         }
 
+        // chain first -> ... -> last must be linked already, only the last link is overwritten
+        template<class Backoff, class NodeOps>
+        bool push_chain(int attempts, LinkType first, LinkType last, Backoff&& backoff, NodeOps&& node_ops) {
+            auto head_ref = std::atomic_ref{*head};
+            auto head_old = head_ref.load(std::memory_order_relaxed);
+            for (int curr = attempts; curr != 0; curr -= curr > 0) {
+                node_ops.set_next(last, head_old.next);
+
+                auto head_new = ListHead{head_old.version + 1, first};
+                if (head_ref.compare_exchange_strong(head_old, head_new, std::memory_order_acq_rel)) {
+                    return true;
+                }
+                backoff();
+            }
+            return false;
+        }
+
+        template<class Backoff, class NodeOps>
+        void push_chain(LinkType first, LinkType last, Backoff&& backoff, NodeOps&& node_ops) {
+            push_chain(-1, first, last, backoff, node_ops);
+        }
+
         template<class Backoff, class NodeOps>
         [[nodiscard]] LinkType pop(int attempts, Backoff&& backoff, NodeOps&& node_ops) {
             auto head_ref = std::atomic_ref{*head};
@@ -115,6 +138,37 @@ namespace cuw3 {
             return pop(-1, backoff, node_ops);
         }
 
+        // pops up to max_count nodes at once, popped nodes stay linked so caller walks them with get_next()
+        // links can be overwritten while we walk them but then version changes and cas fails
+        // walk is bounded by max_count so garbage links cannot loop us forever
+        template<class Backoff, class NodeOps>
+        [[nodiscard]] LinkType pop_chain(int attempts, LinkType max_count, LinkType& count, Backoff&& backoff, NodeOps&& node_ops) {
+            CUW3_ASSERT(max_count > 0, "max_count must be greater than zero");
+
+            count = 0;
+            auto head_ref = std::atomic_ref{*head};
+            auto head_old = head_ref.load(std::memory_order_relaxed);
+            for (int curr = attempts; curr != 0; curr -= curr > 0) {
+                if (head_old.next == null_link) {
+                    return null_link;
+                }
+
+                LinkType popped = 1;
+                LinkType next = node_ops.get_next(head_old.next);
+                for (; popped < max_count && next != null_link; popped++) {
+                    next = node_ops.get_next(next);
+                }
+
+                auto head_new = ListHead{head_old.version + 1, next};
+                if (head_ref.compare_exchange_strong(head_old, head_new, std::memory_order_acq_rel)) {
+                    count = popped;
+                    return head_old.next;
+                }
+                backoff();
+            }
+            return op_failed;
+        }
+
         ListHead* head{};
     };
 
@@ -155,6 +209,27 @@ namespace cuw3 {
             return null_link;
         }
 
+        // bumps up to max_count consecutive entries, count is set to the number of bumped ones
+        // overshoot is given back the same way bump() does it
+        [[nodiscard]] LinkType bump(LinkType max_count, LinkType& count) {
+            count = 0;
+            auto top_ref = std::atomic_ref{*top};
+            auto top_old = top_ref.load(std::memory_order_relaxed);
+            if (top_old >= limit) {
+                return null_link;
+            }
+            top_old = top_ref.fetch_add(max_count, std::memory_order_acq_rel);
+            if (top_old >= limit) {
+                top_ref.fetch_sub(max_count, std::memory_order_acq_rel);
+                return null_link;
+            }
+            count = std::min<LinkType>(max_count, limit - top_old);
+            if (count < max_count) {
+                top_ref.fetch_sub(max_count - count, std::memory_order_acq_rel);
+            }
+            return top_old;
+        }
+
         LinkType* top{};
         LinkType limit{};
     };
@@ -69,19 +69,84 @@ namespace cuw3 {
     inline constexpr RegionChunkSizeArray conf_region_chunk_sizes_array = {CUW3_REGION_CHUNK_SIZES_LOG2};
     static_assert(conf_num_region_sizes == conf_num_region_chunk_sizes, "num of regions and num of chunks must be equal.");
 
+    // region segment params
+    inline constexpr uint64 conf_region_segment_size_log2 = CUW3_REGION_SEGMENT_SIZE_LOG2;
+    inline constexpr uint64 conf_address_space_bits = CUW3_ADDRESS_SPACE_BITS;
+    static_assert(conf_region_segment_size_log2 == 0 || conf_region_segment_size_log2 >= conf_max_region_chunk_size_log2, "chunk must fit into a segment");
+    static_assert(conf_region_segment_size_log2 <= *std::min_element(std::begin(conf_region_sizes_log2), std::end(conf_region_sizes_log2)), "region must consist of whole segments");
+    static_assert(conf_region_segment_size_log2 < conf_address_space_bits && conf_address_space_bits <= 64);
+
+    // unified regions: block of the max chunk size keeps a free bit per chunk in a word (top bit is taken)
+    inline constexpr bool conf_unified_regions = CUW3_UNIFIED_REGIONS;
+    static_assert(!conf_unified_regions || all_equal(conf_region_sizes_log2), "unified regions must be of equal size");
+    static_assert(!conf_unified_regions || conf_max_region_chunk_size_log2 - conf_min_region_chunk_size_log2 < 6, "too many chunks per block");
+
     inline constexpr usize conf_max_cached_chunk_size_id = CUW3_MAX_CACHED_CHUNK_SIZE_ID;
     static_assert(conf_max_cached_chunk_size_id < conf_num_region_chunk_sizes);
     inline constexpr usize conf_max_cached_chunk_size = intpow2(conf_region_chunk_sizes_array[conf_max_cached_chunk_size_id]); 
 
+    inline constexpr usize conf_chunk_magazine_size = CUW3_CHUNK_MAGAZINE_SIZE;
+    inline constexpr usize conf_max_magazine_chunk_size_id = CUW3_MAX_MAGAZINE_CHUNK_SIZE_ID;
+    static_assert(conf_max_magazine_chunk_size_id < conf_num_region_chunk_sizes);
+    static_assert(conf_chunk_magazine_size <= 64, "magazine is a part of the thread local allocator, keep it small");
+
+    inline constexpr uint64 conf_chunk_cache_budget = CUW3_CHUNK_CACHE_BUDGET;
+
+    inline constexpr uint64 conf_chunk_cache_shards = CUW3_CHUNK_CACHE_SHARDS;
+    static_assert(is_pow2(conf_chunk_cache_shards));
+    static_assert(conf_chunk_cache_shards <= CUW3_MAX_CONTENTION_SPLIT);
+
+    inline constexpr uint64 conf_chunk_cache_decay_ms = CUW3_CHUNK_CACHE_DECAY_MS;
+
+    inline constexpr uint64 conf_chunk_commit_mode = CUW3_CHUNK_COMMIT_MODE;
+    static_assert(conf_chunk_commit_mode <= 2, "invalid chunk commit mode");
+
+    inline constexpr uint64 conf_arena_commit_step_log2 = CUW3_ARENA_COMMIT_STEP_LOG2;
+    inline constexpr uint64 conf_arena_commit_step = conf_arena_commit_step_log2 ? intpow2(conf_arena_commit_step_log2) : 0;
+    static_assert(conf_arena_commit_step_log2 == 0 || conf_arena_commit_step_log2 >= 16, "commit step must be a multiple of any page size");
+
+    inline constexpr uint64 conf_chunk_hugepage_mode = CUW3_CHUNK_HUGEPAGE_MODE;
+    static_assert(conf_chunk_hugepage_mode <= 2, "invalid chunk hugepage mode");
+    static_assert(conf_min_region_chunk_size % conf_hugepage_size == 0 || conf_chunk_hugepage_mode == 0, "chunks must not share huge pages");
+    static_assert(conf_arena_commit_step % conf_hugepage_size == 0 || conf_chunk_hugepage_mode == 0, "commit step must not split huge pages");
+
+    inline constexpr uint64 conf_chunk_cache_high_watermarks[] = {CUW3_CHUNK_CACHE_HIGH_WATERMARKS};
+    inline constexpr uint64 conf_chunk_cache_low_watermarks[] = {CUW3_CHUNK_CACHE_LOW_WATERMARKS};
+    static_assert(array_size(conf_chunk_cache_high_watermarks) == array_size(conf_chunk_cache_low_watermarks));
+    static_assert(array_size(conf_chunk_cache_high_watermarks) <= conf_max_cached_chunk_size_id + 1, "only cacheable chunk sizes can have watermarks");
+
     
     // region pool params
     inline constexpr usize conf_max_contention_split = CUW3_MAX_CONTENTION_SPLIT;
     static_assert(conf_max_contention_split <= 64 && conf_max_contention_split > 0, "contention split value must be greater than zero.");
 
+    inline constexpr usize conf_region_chunk_pool_contention_split = CUW3_REGION_CHUNK_POOL_CONTENTION_SPLIT;
+    static_assert(conf_region_chunk_pool_contention_split <= conf_max_contention_split, "contention split is too large");
+    static_assert(conf_region_chunk_pool_contention_split == 0 || is_pow2(conf_region_chunk_pool_contention_split), "contention split must be power of two or zero");
+
+    inline constexpr int conf_region_chunk_pool_max_backoff_spins = CUW3_REGION_CHUNK_POOL_MAX_BACKOFF_SPINS;
+    static_assert(conf_region_chunk_pool_max_backoff_spins > 0);
+
 
     // thread graveyard params
     inline constexpr usize conf_graveyard_slot_count = CUW3_GRAVEYARD_SLOT_COUNT;
 
+    // heap params
+    inline constexpr usize conf_max_heaps = CUW3_MAX_HEAPS;
+    inline constexpr usize conf_max_thread_heaps = CUW3_MAX_THREAD_HEAPS;
+    static_assert(conf_max_heaps > 0 && conf_max_thread_heaps > 0);
+
+
+    // large span params
+    inline constexpr usize conf_large_span_table_size = CUW3_LARGE_SPAN_TABLE_SIZE;
+    static_assert(is_pow2(conf_large_span_table_size));
+
+    inline constexpr usize conf_large_span_cache_size = CUW3_LARGE_SPAN_CACHE_SIZE;
+    static_assert(conf_large_span_cache_size <= 64, "cache is scanned linearly, keep it small");
+
+    inline constexpr uint64 conf_max_cached_large_span_log2 = CUW3_MAX_CACHED_LARGE_SPAN_LOG2;
+    static_assert(conf_max_cached_large_span_log2 < conf_address_space_bits);
+
 
     // fast arena allocator params
     inline constexpr gsize conf_min_alignment_log2 = CUW3_MIN_ALIGNMENT_LOG2;
@@ -96,6 +161,10 @@ namespace cuw3 {
 
     static_assert(conf_fast_arena_max_alignment_log2 <= conf_min_region_chunk_size_log2, "fast arena max alignment is greater than minimal region chunk size");
     
+    // thread local allocator keeps arenas up to this alignment, anything above pads the top (see FastArenaView::acquire_padded())
+    inline constexpr bool conf_alignment_agnostic_arenas = CUW3_ALIGNMENT_AGNOSTIC_ARENAS;
+    inline constexpr gsize conf_fast_arena_binned_max_alignment_log2 = conf_alignment_agnostic_arenas ? conf_fast_arena_min_alignment_log2 : conf_fast_arena_max_alignment_log2;
+
     inline constexpr gsize conf_num_fast_arenas = conf_fast_arena_max_alignment_log2 - conf_fast_arena_min_alignment_log2 + 1;
     inline constexpr gsize conf_max_fast_arenas = conf_num_fast_arenas;
 
@@ -109,4 +178,52 @@ namespace cuw3 {
 
     inline constexpr uint64 conf_size_cutoff = CUW3_SIZE_CUTOFF;
     static_assert(conf_size_cutoff > 0);
+
+
+    // slab allocator params
+    // size classes: conf_min_alloc_size step up to conf_slab_linear_size, then conf_slab_classes_per_pow2 classes per power of two
+    inline constexpr uint64 conf_slab_max_size = CUW3_SLAB_MAX_SIZE;
+    static_assert(is_pow2(conf_slab_max_size));
+    static_assert(conf_slab_max_size <= conf_size_cutoff, "slab sizes must be covered by small allocator as well");
+
+    inline constexpr uint64 conf_slab_linear_size = 8 * conf_min_alloc_size;
+    static_assert(conf_slab_linear_size <= conf_slab_max_size);
+
+    inline constexpr uint64 conf_slab_classes_per_pow2_log2 = 2;
+    inline constexpr uint64 conf_slab_classes_per_pow2 = intpow2(conf_slab_classes_per_pow2_log2);
+
+    inline constexpr uint64 conf_slab_num_size_classes = 
+        conf_slab_linear_size / conf_min_alloc_size + 
+        (intlog2(conf_slab_max_size) - intlog2(conf_slab_linear_size)) * conf_slab_classes_per_pow2;
+
+    inline constexpr uint64 conf_slab_pages_per_chunk = CUW3_SLAB_PAGES_PER_CHUNK;
+    static_assert(is_pow2(conf_slab_pages_per_chunk));
+    static_assert(conf_slab_pages_per_chunk >= 2 && conf_slab_pages_per_chunk <= 64, "page bitmap must fit into single word");
+
+    inline constexpr uint64 conf_slab_pages_per_chunk_log2 = intlog2(conf_slab_pages_per_chunk);
+    inline constexpr uint64 conf_slab_min_page_size = conf_min_region_chunk_size / conf_slab_pages_per_chunk;
+    static_assert(conf_slab_min_page_size >= 16 * conf_slab_max_size, "slab page is too small to hold enough blocks");
+
+
+    // sub-chunk arena params
+    inline constexpr uint64 conf_sub_chunk_arena_size_log2 = CUW3_SUB_CHUNK_ARENA_SIZE_LOG2;
+    inline constexpr uint64 conf_sub_chunk_arena_size = intpow2(conf_sub_chunk_arena_size_log2);
+    inline constexpr uint64 conf_sub_chunk_arena_thread_limit = CUW3_SUB_CHUNK_ARENA_THREAD_LIMIT;
+    inline constexpr uint64 conf_sub_chunk_arenas_per_chunk = conf_min_region_chunk_size / conf_sub_chunk_arena_size;
+    static_assert(conf_sub_chunk_arena_size >= conf_size_cutoff, "sub-chunk arena must fit any small allocation");
+    static_assert(conf_sub_chunk_arenas_per_chunk >= 2, "sub-chunk arena is too big");
+    static_assert(conf_sub_chunk_arenas_per_chunk * (conf_control_block_size + sizeof(uint32)) <= conf_sub_chunk_arena_size, "sub-chunk control blocks do not fit into the first arena slot");
+
+
+    // thread local cache params
+    inline constexpr uint64 conf_tcache_bin_capacity = CUW3_TCACHE_BIN_CAPACITY;
+    inline constexpr uint64 conf_tcache_flush_batch = conf_tcache_bin_capacity / 2;
+    static_assert(conf_tcache_bin_capacity == 0 || conf_tcache_flush_batch > 0, "bin capacity is too small");
+
+    // remote free buffer
+    inline constexpr uint64 conf_remote_free_max_batches = 64;
+    inline constexpr uint64 conf_remote_free_batches = CUW3_REMOTE_FREE_BATCHES;
+    inline constexpr uint64 conf_remote_free_batch_capacity = CUW3_REMOTE_FREE_BATCH_CAPACITY;
+    static_assert(conf_remote_free_batches <= conf_remote_free_max_batches, "too many remote free batches");
+    static_assert(conf_remote_free_batches == 0 || conf_remote_free_batch_capacity > 0, "batch capacity is too small");
 }
\ No newline at end of file
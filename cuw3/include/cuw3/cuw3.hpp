@@ -4,8 +4,46 @@
 #include "typedefs.hpp"
 
 extern "C" {
+    // independent heap: own regions, chunk pools, caches and thread local allocators
+    // memory of a heap must be freed through the same heap, heap is destroyed with everything still allocated from it
+    typedef struct cuw3_heap cuw3_heap;
+
+    // runtime part of the allocator config, start from cuw3_heap_default_config() (compile time defaults)
+    typedef struct cuw3_heap_config {
+        uint64_t region_size_log2; // size of the region of every chunk size, bounds the heap (large spans aside)
+        uint64_t chunk_cache_budget; // bytes of committed chunks kept cached
+        uint64_t contention_split; // pool splits per region, power of two, 0 - by hardware threads
+        uint64_t num_grave_entries;
+        uint32_t chunk_commit_mode; // see ChunkCommitMode
+        uint32_t chunk_huge_page_mode; // see ChunkHugePageMode
+    } cuw3_heap_config;
+
+    // monotonic arena: allocation is a pointer bump, memory is given back only by rewind or release
+    // arena belongs to the thread that created it and must be released by that thread before it exits
+    typedef struct cuw3_arena cuw3_arena;
+
     CUW3_API void* cuw3_alloc(uint64_t size, uint64_t alignment);
     CUW3_API void cuw3_free(void* ptr, uint64_t size);
+    CUW3_API void cuw3_free_unsized(void* ptr); // slower than sized free, size is looked up
+    CUW3_API uint64_t cuw3_alloc_batch(uint64_t size, uint64_t alignment, uint64_t count, void** ptrs); // returns amount allocated, fewer than count only if out of memory
+    CUW3_API void cuw3_free_batch(void* const* ptrs, const uint64_t* sizes, uint64_t count); // pointers of the same batch better go together
+    CUW3_API uint64_t cuw3_usable_size(void* ptr); // at least the size ptr was allocated with
+    CUW3_API int cuw3_try_resize(void* ptr, uint64_t size, uint64_t new_size); // non-zero if resized in place, free with new_size then
+    CUW3_API void* cuw3_realloc(void* ptr, uint64_t size, uint64_t new_size, uint64_t alignment); // copies only if in place resize fails
     CUW3_API void cuw3_reclaim();
+    CUW3_API uint64_t cuw3_purge(uint64_t max_bytes); // returns amount of bytes given back to the OS
+    CUW3_API uint64_t cuw3_chunk_pool_cas_failures(); // failed cas attempts on region chunk pools, diagnostics only
     CUW3_API void cuw3_cleanup();
+
+    CUW3_API void cuw3_heap_default_config(cuw3_heap_config* config);
+    CUW3_API cuw3_heap* cuw3_heap_create(const cuw3_heap_config* config); // null config - defaults, null on failure
+    CUW3_API void cuw3_heap_destroy(cuw3_heap* heap); // nobody may use the heap meanwhile, threads may still be alive
+    CUW3_API void* cuw3_heap_alloc(cuw3_heap* heap, uint64_t size, uint64_t alignment);
+    CUW3_API void cuw3_heap_free(cuw3_heap* heap, void* ptr, uint64_t size);
+
+    CUW3_API cuw3_arena* cuw3_arena_create(uint64_t size); // size - expected usage, only picks the first chunk
+    CUW3_API void* cuw3_arena_alloc(cuw3_arena* arena, uint64_t size, uint64_t alignment); // any power of two alignment up to the max chunk size, padding comes from the arena
+    CUW3_API void* cuw3_arena_mark(cuw3_arena* arena);
+    CUW3_API void cuw3_arena_rewind(cuw3_arena* arena, void* mark); // marks are rewound in stack order, later marks become invalid
+    CUW3_API void cuw3_arena_release(cuw3_arena* arena); // everything allocated from the arena is freed at once
 }
\ No newline at end of file
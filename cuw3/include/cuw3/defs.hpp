@@ -22,10 +22,63 @@
 #define CUW3_REGION_SIZES_LOG2       36,36,36,36,36,36
 #define CUW3_REGION_CHUNK_SIZES_LOG2 21,22,23,24,25,26
 
+// regions are reserved in segments of this size, segment is reserved once its first chunk is allocated
+// 0 - every region is reserved up front in one go
+// address space bits bound the pointer -> segment map (one entry per segment sized slot of the address space)
+#ifndef CUW3_REGION_SEGMENT_SIZE_LOG2
+#define CUW3_REGION_SEGMENT_SIZE_LOG2 30
+#endif
+#define CUW3_ADDRESS_SPACE_BITS 48
+
+// 0 - every chunk size has its own region, 1 - all chunk sizes share a single region (region sizes must be equal):
+// region is carved into blocks of the max chunk size, free block is split into chunks of whichever size needs it
+// and merged back once all its chunks are free (see RegionChunkBlock)
+#ifndef CUW3_UNIFIED_REGIONS
+#define CUW3_UNIFIED_REGIONS 0
+#endif
+
 // simplified check, if chunk size is less than or equal to this value then we can cache it
 #define CUW3_MAX_CACHED_CHUNK_SIZE_ID 5
 
-#define CUW3_REGION_CHUNK_POOL_CONTENTION_SPLIT 2
+// global chunk cache, shared by all threads
+// watermarks are listed per region (in chunks), up to CUW3_MAX_CACHED_CHUNK_SIZE_ID
+#define CUW3_CHUNK_CACHE_BUDGET (1ull << 28)
+#define CUW3_CHUNK_CACHE_SHARDS 4
+#define CUW3_CHUNK_CACHE_HIGH_WATERMARKS 16,8,4,2,2,1
+#define CUW3_CHUNK_CACHE_LOW_WATERMARKS   4,2,1,0,0,0
+// idle region gives its cached chunks back to the OS within this time (see cuw3_purge), -1 disables decay
+#define CUW3_CHUNK_CACHE_DECAY_MS 10000
+
+// thread takes fresh chunks of small sizes (up to CUW3_MAX_MAGAZINE_CHUNK_SIZE_ID) from the region pools in batches of this size
+// 0 disables batching
+#ifndef CUW3_CHUNK_MAGAZINE_SIZE
+#define CUW3_CHUNK_MAGAZINE_SIZE 4
+#endif
+#define CUW3_MAX_MAGAZINE_CHUNK_SIZE_ID 1
+
+// 0 - mprotect commit/decommit, 1 - regions are read-write, decommit is MADV_FREE, 2 - same but MADV_DONTNEED
+// can be overriden from the command line to benchmark different modes
+#ifndef CUW3_CHUNK_COMMIT_MODE
+#define CUW3_CHUNK_COMMIT_MODE 0
+#endif
+
+// arena commits its chunk in steps of this size as the top advances (mode 0 only), 0 commits the whole chunk at once
+#ifndef CUW3_ARENA_COMMIT_STEP_LOG2
+#define CUW3_ARENA_COMMIT_STEP_LOG2 21
+#endif
+
+// 0 - regular pages, 1 - transparent huge pages (MADV_HUGEPAGE), 2 - MAP_HUGETLB with fallback to 1
+#ifndef CUW3_CHUNK_HUGEPAGE_MODE
+#define CUW3_CHUNK_HUGEPAGE_MODE 0
+#endif
+
+// number of region pool splits, 0 - hardware threads count rounded up to power of two and clamped by CUW3_MAX_CONTENTION_SPLIT
+#ifndef CUW3_REGION_CHUNK_POOL_CONTENTION_SPLIT
+#define CUW3_REGION_CHUNK_POOL_CONTENTION_SPLIT 0
+#endif
+
+// spin cap of the exponential backoff on region pool cas failures
+#define CUW3_REGION_CHUNK_POOL_MAX_BACKOFF_SPINS 256
 
 #define CUW3_MAX_CONTENTION_SPLIT 16
 
@@ -34,17 +87,51 @@
 
 #define CUW3_GRAVEYARD_SLOT_COUNT 16
 
+// independent heaps (see cuw3_heap_create()): heaps alive at once and heaps a single thread can use at once
+#define CUW3_MAX_HEAPS 64
+#define CUW3_MAX_THREAD_HEAPS 16
+
+// allocations above the max chunk size get dedicated spans, live spans are tracked in a table of this many slots
+#define CUW3_LARGE_SPAN_TABLE_SIZE 4096
+// freed spans kept mapped for reuse (0 disables the cache) and the biggest span that can be kept
+#ifndef CUW3_LARGE_SPAN_CACHE_SIZE
+#define CUW3_LARGE_SPAN_CACHE_SIZE 4
+#endif
+#define CUW3_MAX_CACHED_LARGE_SPAN_LOG2 32
+
 #define CUW3_MIN_CHUNK_LOG2 4
 #define CUW3_MAX_CHUNK_LOG2 13
 
 #define CUW3_MIN_ALIGNMENT_LOG2 4
 #define CUW3_MAX_ALIGNMENT_LOG2 12
 
+// 0 - separate arenas for every alignment, 1 - alignment-agnostic arenas: min aligned arenas only, bigger alignments pad the top
+// can be overriden from the command line to benchmark both layouts
+#ifndef CUW3_ALIGNMENT_AGNOSTIC_ARENAS
+#define CUW3_ALIGNMENT_AGNOSTIC_ARENAS 0
+#endif
+
 #define CUW3_MAX_FAST_ARENA_LOOKUP_SPLIT 128
 #define CUW3_MAX_FAST_ARENA_LOOKUP_STEPS 11
 
 #define CUW3_SIZE_CUTOFF (1 << 14)
 
+#define CUW3_SLAB_MAX_SIZE 1024
+#define CUW3_SLAB_PAGES_PER_CHUNK 32
+
+// sub-chunk arenas: small arenas carved from a single region chunk, served to threads until they graduate
+// thread limit is the chunk storage a thread may hold before it switches to whole chunks, 0 disables sub-chunk arenas
+#define CUW3_SUB_CHUNK_ARENA_SIZE_LOG2 16
+#ifndef CUW3_SUB_CHUNK_ARENA_THREAD_LIMIT
+#define CUW3_SUB_CHUNK_ARENA_THREAD_LIMIT (1 << 19)
+#endif
+
+#define CUW3_TCACHE_BIN_CAPACITY 64
+
+// cross-thread frees are batched per target chunk: amount of chunks buffered at once and frees per batch
+#define CUW3_REMOTE_FREE_BATCHES 16
+#define CUW3_REMOTE_FREE_BATCH_CAPACITY 32
+
 
 #if __has_feature(address_sanitizer) || defined(__SANITIZE_ADDRESS__)
     #define CUW3_ASAN_ENABLED
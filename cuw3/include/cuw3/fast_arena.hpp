@@ -3,6 +3,7 @@
 #include "conf.hpp"
 #include "cuw3/defs.hpp"
 #include "list.hpp"
+#include "vmem.hpp"
 #include "utils.hpp"
 #include "assert.hpp"
 #include "backoff.hpp"
@@ -11,7 +12,7 @@
 
 namespace cuw3 {
     // NOTE : fast arenas can allocate even for bigger alignments at a cost of wating little big of memory
-    // algorithm is the following:
+    // algorithm is the following (see acquire_padded()):
     // 1. we allocate-free (just inc freed value) memory that precedes the alignment boundary
     // 2. we make an allocation if there is enough space
     using FastArenaListEntry = DefaultListEntry;
@@ -19,6 +20,24 @@ namespace cuw3 {
 
     using FastArenaBackoff = SimpleBackoff;
 
+    // allocation end map: out-of-line bitmap with one bit per granule of the arena memory
+    // * bit is set at the granule where allocation ends (that is where the next one starts), owner sets it before allocation is handed out
+    //   so any thread holding the pointer can recover allocation size: distance to the first set bit after the allocation start
+    // * no set bit means that allocation spans up to the arena end
+    // * summary has one bit per map word so big allocations are skipped quickly
+    // * owner is the only writer, map is cleared on reset so map of a dead arena is all zeroes
+    inline constexpr uint64 fast_arena_end_map_granule = conf_min_alloc_alignment;
+    inline constexpr uint64 fast_arena_end_map_ratio = fast_arena_end_map_granule * bitsize<uint8>(); // arena bytes per map byte
+    inline constexpr uint64 fast_arena_end_map_word_span = fast_arena_end_map_granule * bitsize<uint64>(); // arena bytes per map word
+    inline constexpr uint64 fast_arena_end_map_summary_ratio = fast_arena_end_map_ratio * bitsize<uint64>(); // arena bytes per summary byte
+    inline constexpr uint64 fast_arena_end_map_summary_word_span = fast_arena_end_map_word_span * bitsize<uint64>(); // arena bytes per summary word
+
+    // incremental commit: arena memory is only reserved, owner commits it in conf_arena_commit_step steps as the top advances
+    // * committed is the high-water mark: memory below it is accessible
+    // * reset expects the next cycle to use as much as this one did and decommits everything above the top
+    // * arena that does not commit by itself has committed set to fast_arena_fully_committed
+    inline constexpr uint64 fast_arena_fully_committed = ~(uint64)0;
+
     // THINK : something must be done with view and const-view issue. Basically, when we want to provide some const-correctness.
     // * kind of solved: whatever the const view can do  general view can do too, so general view inherits from the const one
     // THINK : do something with the cache alignment issue (make it more convenient)
@@ -33,6 +52,8 @@ namespace cuw3 {
         CUW3_NEW_CACHELINE // least volatile data
         RegionChunkHandleHeader region_chunk_header{}; // does not change until arena dies
         RetireReclaimEntry retire_reclaim_entry{}; // volatile but we assume that it wont be changed often
+        uint64* end_map{}; // optional, see fast_arena_end_map_granule
+        uint64* end_map_summary{};
 
     #ifdef CUW3_ENABLE_DEBUG_CODE
         uint64 debug_label{};
@@ -47,6 +68,7 @@ namespace cuw3 {
         uint64 arena_alignment{};
         
         void* arena_memory{};
+        uint64 committed{}; // owner only
     };
 
     static_assert(sizeof(FastArena) <= conf_control_block_size, "pack struct field better or increase size of the control block");
@@ -61,6 +83,14 @@ namespace cuw3 {
         uint64 arena_alignment{};
 
         RetireReclaimRawPtr retire_reclaim_flags{};
+
+        // both null or both set, arena memory size must be a multiple of fast_arena_end_map_summary_word_span then
+        // map must be zeroed
+        uint64* end_map{};
+        uint64* end_map_summary{};
+
+        // arena memory is reserved only, see fast_arena_fully_committed
+        bool incremental_commit{};
     };
 
     // arena memory must be aligned to alignment
@@ -76,6 +106,9 @@ namespace cuw3 {
             CUW3_CHECK_RETURN_VAL(is_alignment(config.arena_alignment) && config.arena_alignment >= conf_min_alloc_alignment, nullptr, "invalid alignment provided");
             CUW3_CHECK_RETURN_VAL(is_aligned(config.arena_memory_size, config.arena_alignment), nullptr, "arena size is not properly aligned");
             CUW3_CHECK_RETURN_VAL(is_aligned(config.arena_memory, config.arena_alignment), nullptr, "arena memory is not properly aligned");
+            CUW3_CHECK_RETURN_VAL(!config.end_map == !config.end_map_summary, nullptr, "end map requires summary");
+            CUW3_CHECK_RETURN_VAL(!config.end_map || is_aligned(config.arena_memory_size, fast_arena_end_map_summary_word_span), nullptr, "arena size is not aligned to end map summary word");
+            CUW3_CHECK_RETURN_VAL(!config.incremental_commit || conf_arena_commit_step, nullptr, "incremental commit is disabled");
 
             auto* arena = new (memory.get()) FastArena{};
             arena->region_chunk_header = RegionChunkHandleHeader::from(config.owner, config.arena_type);
@@ -84,6 +117,9 @@ namespace cuw3 {
             arena->top = 0;
             arena->arena_memory_size = config.arena_memory_size;
             arena->arena_memory = config.arena_memory;
+            arena->end_map = config.end_map;
+            arena->end_map_summary = config.end_map_summary;
+            arena->committed = config.incremental_commit ? 0 : fast_arena_fully_committed;
 
             auto* retire_reclaim_entry = RetireReclaimEntryView::create(
                 Memory::from(&arena->retire_reclaim_entry),
@@ -110,13 +146,116 @@ namespace cuw3 {
             if (remaining < required_space) {
                 return nullptr;
             }
+            if (!commit_up_to_(arena->top + required_space)) {
+                return nullptr;
+            }
             arena->top += required_space;
+            if (arena->end_map && arena->top != arena->arena_memory_size) {
+                mark_end_(arena->top);
+            }
 
             void* mem = advance_ptr(arena->arena_memory, old_top);
             CUW3_UNPOISON_MEMORY_REGION(mem, required_space);
             return mem;
         }
 
+        // alignment above the arena one: padding up to the alignment boundary is allocated and freed at once
+        // end mark of the previous allocation stays at the old top so padding never counts into its size
+        // returns nullptr if padded allocation does not fit
+        [[nodiscard]] void* acquire_padded(uint64 size, uint64 alignment) {
+            CUW3_CHECK(is_alignment(alignment), "invalid alignment");
+
+            if (alignment <= arena->arena_alignment) {
+                return acquire(size);
+            }
+
+            uint64 skipped = padding(alignment);
+            uint64 rem = remaining();
+            if (rem < skipped || rem - skipped < align(size, arena->arena_alignment)) {
+                return nullptr;
+            }
+            if (!commit_up_to_(arena->top + skipped + align(size, arena->arena_alignment))) {
+                return nullptr;
+            }
+            arena->top += skipped;
+            arena->freed += skipped;
+            return acquire(size);
+        }
+
+        // bytes to skip so the top gets aligned
+        uint64 padding(uint64 alignment) const {
+            auto top = (uintptr)advance_ptr(arena->arena_memory, arena->top);
+            return align(top, alignment) - top;
+        }
+
+        // allocation can be resized in place only if it is the last one: it ends at the top, new end must fit
+        bool can_resize(void* memory, uint64 size, uint64 new_size) const {
+            auto offset = subptr(memory, arena->arena_memory);
+            if (offset < 0 || (uint64)offset >= arena->arena_memory_size) {
+                return false;
+            }
+            if ((uint64)offset + align(size, arena->arena_alignment) != arena->top) {
+                return false;
+            }
+            return align(new_size, arena->arena_alignment) <= arena->arena_memory_size - (uint64)offset;
+        }
+
+        // moves the top, end mark moves along with it
+        // returns false if memory for the grown allocation cannot be committed
+        [[nodiscard]] bool resize(void* memory, uint64 size, uint64 new_size) {
+            CUW3_CHECK(can_resize(memory, size, new_size), "allocation cannot be resized in place");
+
+            uint64 old_top = arena->top;
+            uint64 new_top = (uint64)subptr(memory, arena->arena_memory) + align(new_size, arena->arena_alignment);
+            if (new_top == old_top) {
+                return true;
+            }
+            if (!commit_up_to_(new_top)) {
+                return false;
+            }
+            if (arena->end_map) {
+                if (old_top != arena->arena_memory_size) {
+                    clear_end_(old_top);
+                }
+                if (new_top != arena->arena_memory_size) {
+                    mark_end_(new_top);
+                }
+            }
+            arena->top = new_top;
+
+            if (new_top > old_top) {
+                CUW3_UNPOISON_MEMORY_REGION(advance_ptr(arena->arena_memory, old_top), new_top - old_top);
+            } else {
+                CUW3_POISON_MEMORY_REGION(advance_ptr(arena->arena_memory, new_top), old_top - new_top);
+            }
+            return true;
+        }
+
+        // commits whole steps so that memory up to end becomes accessible
+        [[nodiscard]] bool commit_up_to_(uint64 end) {
+            if (end <= arena->committed) {
+                return true;
+            }
+
+            uint64 new_committed = std::min(align(end, conf_arena_commit_step), arena->arena_memory_size);
+            if (!vmem_commit(advance_ptr(arena->arena_memory, arena->committed), new_committed - arena->committed)) {
+                return false;
+            }
+            arena->committed = new_committed;
+            return true;
+        }
+
+        // keeps steps used by the current top, the rest goes back to the OS
+        void decommit_above_top_() {
+            uint64 keep = std::min(align(arena->top, conf_arena_commit_step), arena->arena_memory_size);
+            if (keep >= arena->committed) {
+                return;
+            }
+            if (vmem_decommit(advance_ptr(arena->arena_memory, keep), arena->committed - keep)) {
+                arena->committed = keep;
+            }
+        }
+
         void release_reclaimed(uint64 size) {
             CUW3_CHECK(is_aligned(size, alignment()), "size is not aligned");
 
@@ -144,13 +283,109 @@ namespace cuw3 {
 
         void reset() {
             CUW3_CHECK(resettable(), "arena was not resettable");
-            
+
+            if (arena->end_map) {
+                clear_end_map_();
+            }
+            if (arena->committed != fast_arena_fully_committed) {
+                decommit_above_top_();
+            }
             arena->top = 0;
             arena->freed = 0;
 
             CUW3_POISON_MEMORY_REGION(arena->arena_memory, arena->arena_memory_size);
         }
 
+        bool has_end_map() const {
+            return arena->end_map;
+        }
+
+        // size of the allocation starting at memory (aligned size it was acquired with), arena must have end map
+        // can be called from any thread that legitimately holds the allocation
+        uint64 allocation_size(void* memory) const {
+            CUW3_CHECK(arena->end_map, "arena has no end map");
+
+            auto offset = subptr(memory, arena->arena_memory);
+            CUW3_CHECK(offset >= 0 && (uint64)offset < arena->arena_memory_size, "memory does not belong to the arena");
+            CUW3_CHECK(is_aligned((uint64)offset, arena->arena_alignment), "memory is misaligned");
+
+            uint64 start = (uint64)offset / fast_arena_end_map_granule + 1;
+            return find_end_(start) * fast_arena_end_map_granule - (uint64)offset;
+        }
+
+        // returns granule where the allocation ends, search starts from the granule start
+        uint64 find_end_(uint64 start) const {
+            uint64 num_granules = arena->arena_memory_size / fast_arena_end_map_granule;
+            uint64 num_words = num_granules / bitsize<uint64>();
+            if (start >= num_granules) {
+                return num_granules;
+            }
+
+            uint64 word = start / bitsize<uint64>();
+            uint64 bits = load_word_(arena->end_map, word) & ~(uint64)0 << (start % bitsize<uint64>());
+            if (bits) {
+                return word * bitsize<uint64>() + std::countr_zero(bits);
+            }
+
+            // skip empty words via summary
+            word++;
+            while (word < num_words) {
+                uint64 summary_word = word / bitsize<uint64>();
+                uint64 summary = load_word_(arena->end_map_summary, summary_word) & ~(uint64)0 << (word % bitsize<uint64>());
+                if (!summary) {
+                    word = (summary_word + 1) * bitsize<uint64>();
+                    continue;
+                }
+
+                word = summary_word * bitsize<uint64>() + std::countr_zero(summary);
+                if (uint64 bits = load_word_(arena->end_map, word)) {
+                    return word * bitsize<uint64>() + std::countr_zero(bits);
+                }
+                word++; // summary raced ahead of the map, bit belongs to somebody else's allocation anyway
+            }
+            return num_granules;
+        }
+
+        // owner is the only writer so plain read-modify-write is enough, atomic store is for the concurrent readers
+        void mark_end_(uint64 end) {
+            uint64 granule = end / fast_arena_end_map_granule;
+            uint64 word = granule / bitsize<uint64>();
+            set_bit_(arena->end_map, granule);
+            set_bit_(arena->end_map_summary, word);
+        }
+
+        // summary bit goes away along with the last bit of the word
+        void clear_end_(uint64 end) {
+            uint64 granule = end / fast_arena_end_map_granule;
+            uint64 word = granule / bitsize<uint64>();
+            clear_bit_(arena->end_map, granule);
+            if (!load_word_(arena->end_map, word)) {
+                clear_bit_(arena->end_map_summary, word);
+            }
+        }
+
+        // clears everything up to the top (top granule itself is the last possible end)
+        void clear_end_map_() {
+            uint64 num_words = arena->arena_memory_size / fast_arena_end_map_word_span;
+            uint64 last_word = std::min(arena->top / fast_arena_end_map_word_span, num_words - 1);
+            std::memset(arena->end_map, 0, (last_word + 1) * sizeof(uint64));
+            std::memset(arena->end_map_summary, 0, (last_word / bitsize<uint64>() + 1) * sizeof(uint64));
+        }
+
+        static uint64 load_word_(uint64* words, uint64 word) {
+            return std::atomic_ref{words[word]}.load(std::memory_order_relaxed);
+        }
+
+        static void set_bit_(uint64* words, uint64 bit) {
+            auto word_ref = std::atomic_ref{words[bit / bitsize<uint64>()]};
+            word_ref.store(word_ref.load(std::memory_order_relaxed) | (uint64)1 << (bit % bitsize<uint64>()), std::memory_order_relaxed);
+        }
+
+        static void clear_bit_(uint64* words, uint64 bit) {
+            auto word_ref = std::atomic_ref{words[bit / bitsize<uint64>()]};
+            word_ref.store(word_ref.load(std::memory_order_relaxed) & ~((uint64)1 << (bit % bitsize<uint64>())), std::memory_order_relaxed);
+        }
+
         bool has_memory_range(void* memory, uint64 size) {
             auto mem_val = (uintptr)memory;
             auto arena_start = (uintptr)arena->arena_memory;
@@ -192,6 +427,11 @@ namespace cuw3 {
             return arena->arena_memory_size;
         }
 
+        // fast_arena_fully_committed if arena does not commit by itself
+        uint64 committed() const {
+            return arena->committed;
+        }
+
         uint64 remaining() const {
             CUW3_CHECK(arena->arena_memory_size >= arena->top, "top is greater than memory size");
 
@@ -224,13 +464,24 @@ namespace cuw3 {
         }
 
         [[nodiscard]] RetireReclaimPtr retire_allocation(void* memory, uint64 size) {
+            return retire_allocations(defer_retire_allocation(memory, size));
+        }
+
+        // first half of the retire: allocation is considered dead, its aligned size must be retired later
+        [[nodiscard]] uint64 defer_retire_allocation(void* memory, uint64 size) {
             uint64 size_aligned = align(size, arena->arena_alignment);
             CUW3_POISON_MEMORY_REGION(memory, size_aligned);
 
             CUW3_CHECK(has_memory_range(memory, size_aligned), "invalid memory range to retire");
+            return size_aligned;
+        }
+
+        // total_size is the sum of aligned sizes of deferred allocations
+        [[nodiscard]] RetireReclaimPtr retire_allocations(uint64 total_size) {
+            CUW3_CHECK(is_aligned(total_size, arena->arena_alignment), "total size is not aligned");
 
             auto retire_reclaim_entry_view = RetireReclaimPtrView{&arena->retire_reclaim_entry.head};
-            return retire_reclaim_entry_view.retire_data(size, FastArenaBackoff{});
+            return retire_reclaim_entry_view.retire_data(total_size, FastArenaBackoff{});
         }
 
         // fast arena is a leaf resource so we always reclaim and reset    
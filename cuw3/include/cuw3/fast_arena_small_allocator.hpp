@@ -258,6 +258,10 @@ namespace cuw3 {
             return bins.num_alignments;
         }
 
+        uint64 get_max_alignment() const {
+            return get_alignment(bins.num_alignments - 1);
+        }
+
         // arena will be extracted from the data structure
         [[nodiscard]] AcquiredTypedResource<FastArena> acquire(uint64 size, uint64 alignment) {
             auto alignment_id = bins.locate_alignment(alignment);
@@ -311,6 +315,51 @@ namespace cuw3 {
             return allocated;
         }
 
+        // arena is not in the data structure
+        // carves up to n blocks of the size while the arena has room, returns amount of blocks carved (at least one)
+        [[nodiscard]] uint64 allocate_batch(FastArena* arena, uint64 size, uint64 n, void** out) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(size, "size was zero");
+            CUW3_CHECK(n, "nothing to allocate");
+
+            auto arena_view = FastArenaView{arena};
+            auto alignment_id = bins.locate_alignment(arena_view.alignment());
+            CUW3_CHECK(bins.valid_alignment_id(alignment_id), "invalid alignment");
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaSmallAllocator, "arena has invalid type");
+
+            uint64 count = 0;
+            while (count < n) {
+                void* allocated = arena_view.acquire(size);
+                if (!allocated) {
+                    break;
+                }
+                out[count++] = allocated;
+            }
+            CUW3_CHECK(count, "invariant violation: we cannot allocate proper size");
+
+            bins.release(arena, alignment_id);
+            return count;
+        }
+
+        // arena is not in the data structure
+        // arena must have been acquired for the worst case padded size: size + alignment - arena alignment
+        [[nodiscard]] void* allocate_padded(FastArena* arena, uint64 size, uint64 alignment) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(size, "size was zero");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaSmallAllocator, "arena has invalid type");
+
+            auto alignment_id = bins.locate_alignment(arena_view.alignment());
+            CUW3_CHECK(bins.valid_alignment_id(alignment_id), "invalid alignment");
+
+            void* allocated = arena_view.acquire_padded(size, alignment);
+            CUW3_CHECK(allocated, "invariant violation: we cannot allocate proper size");
+
+            bins.release(arena, alignment_id);
+            return allocated;
+        }
+
         // arena is in the data structure
         [[nodiscard]] FastArena* deallocate(FastArena* arena, void* ptr, uint64 size) {
             CUW3_CHECK(arena, "arena was nullptr");
@@ -331,6 +380,45 @@ namespace cuw3 {
             return arena;
         }
 
+        // several allocations of the arena freed at once, total_size is the sum of their aligned sizes
+        [[nodiscard]] FastArena* deallocate_batch(FastArena* arena, uint64 total_size) {
+            CUW3_CHECK(arena, "arena was nullptr");
+            CUW3_CHECK(total_size, "size was zero");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaSmallAllocator, "arena has invalid type");
+
+            arena_view.release_reclaimed(total_size);
+            if (!arena_view.resettable()) {
+                return nullptr;
+            }
+
+            auto alignment_id = bins.locate_alignment(arena_view.alignment());
+            bins.extract(arena, alignment_id);
+            arena_view.reset();
+            return arena;
+        }
+
+        // arena is in the data structure
+        // remaining size changes so arena is rebinned
+        [[nodiscard]] bool resize(FastArena* arena, void* ptr, uint64 size, uint64 new_size) {
+            CUW3_CHECK(arena, "arena was nullptr");
+            CUW3_CHECK(size && new_size, "size was zero");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaSmallAllocator, "arena has invalid type");
+
+            if (!arena_view.can_resize(ptr, size, new_size)) {
+                return false;
+            }
+
+            auto alignment_id = bins.locate_alignment(arena_view.alignment());
+            bins.extract(arena, alignment_id);
+            bool resized = arena_view.resize(ptr, size, new_size);
+            bins.release(arena, alignment_id);
+            return resized;
+        }
+
         // called from the non-owning thread
         // puts retired arenas in the list
         // arena pointer is stored as is - no offsetting will be required on reclaim
@@ -342,7 +430,22 @@ namespace cuw3 {
             auto arena_view = FastArenaView{arena};
             CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaSmallAllocator, "arena does not belong to this allocator");
 
-            auto retired = arena_view.retire_allocation(ptr, size);
+            return retire_arena_(arena, arena_view.retire_allocation(ptr, size));
+        }
+
+        // called from the non-owning thread
+        // retires several allocations at once, total_size is the sum of their deferred aligned sizes
+        [[nodiscard]] RetireReclaimPtr retire_batch(FastArena* arena, uint64 total_size) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(total_size, "size was zero");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaSmallAllocator, "arena does not belong to this allocator");
+
+            return retire_arena_(arena, arena_view.retire_allocations(total_size));
+        }
+
+        [[nodiscard]] RetireReclaimPtr retire_arena_(FastArena* arena, RetireReclaimPtr retired) {
             if (RetireReclaimFlagsHelper{retired}.retired()) {
                 return retired;
             }
@@ -817,6 +817,46 @@ namespace cuw3 {
             return allocated;
         }
 
+        // same as allocate() but carves up to n blocks while the arena has room, returns amount of blocks carved (at least one)
+        [[nodiscard]] uint64 allocate_batch(FastArena* arena, uint64 size, uint64 n, void** out) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(size, "cannot make zero allocation");
+            CUW3_CHECK(n, "nothing to allocate");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(!arena_view.in_list(), "arena must not be in any list");
+            CUW3_CHECK(arena_view.empty() || !arena_view.resettable(), "arena must be either fresh (empty) or not resettable (we must have resetted it before)");
+
+            uint64 count = 0;
+            while (count < n) {
+                void* allocated = arena_view.acquire(size);
+                if (!allocated) {
+                    break;
+                }
+                out[count++] = allocated;
+            }
+            CUW3_CHECK(count, "arena must have had enough space");
+
+            fast_arena_bins.release_arena(arena);
+            return count;
+        }
+
+        // arena must have been acquired for the worst case padded size: size + alignment - arena alignment
+        [[nodiscard]] void* allocate_padded(FastArena* arena, uint64 size, uint64 alignment) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(size, "cannot make zero allocation");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(!arena_view.in_list(), "arena must not be in any list");
+            CUW3_CHECK(arena_view.empty() || !arena_view.resettable(), "arena must be either fresh (empty) or not resettable (we must have resetted it before)");
+
+            void* allocated = arena_view.acquire_padded(size, alignment);
+            CUW3_CHECK(allocated, "arena must have had enough space");
+
+            fast_arena_bins.release_arena(arena);
+            return allocated;
+        }
+
         // arena is retrieved externally (in some magic way)
         // arena is in the data structure (either cached or in the bins)
         // resets resettable arena and returns it
@@ -840,6 +880,43 @@ namespace cuw3 {
             return arena;
         }
 
+        // several allocations of the arena freed at once, total_size is the sum of their aligned sizes
+        [[nodiscard]] FastArena* deallocate_batch(FastArena* arena, uint64 total_size) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(total_size, "size was zero");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaStepSplitAllocator, "arena does not belong to this allocator");
+
+            arena_view.release_reclaimed(total_size);
+            if (!arena_view.resettable()) {
+                return nullptr;
+            }
+
+            fast_arena_bins.extract_arena(arena);
+            arena_view.reset();
+            return arena;
+        }
+
+        // arena is in the data structure (either cached or in the bins)
+        // remaining size changes so arena must be extracted first to be found in its bin
+        [[nodiscard]] bool resize(FastArena* arena, void* memory, uint64 size, uint64 new_size) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(size && new_size, "size was zero");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaStepSplitAllocator, "arena does not belong to this allocator");
+
+            if (!arena_view.can_resize(memory, size, new_size)) {
+                return false;
+            }
+
+            fast_arena_bins.extract_arena(arena);
+            bool resized = arena_view.resize(memory, size, new_size);
+            fast_arena_bins.release_arena(arena);
+            return resized;
+        }
+
         // called from the non-owning thread
         // puts retired arenas in the list
         // arena pointer is stored as is - no offsetting will be required on reclaim
@@ -851,7 +928,22 @@ namespace cuw3 {
             auto arena_view = FastArenaView{arena};
             CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaStepSplitAllocator, "arena does not belong to this allocator");
 
-            auto old_resource = arena_view.retire_allocation(ptr, size);
+            return retire_arena_(arena, arena_view.retire_allocation(ptr, size));
+        }
+
+        // called from the non-owning thread
+        // retires several allocations at once, total_size is the sum of their deferred aligned sizes
+        [[nodiscard]] RetireReclaimPtr retire_batch(FastArena* arena, uint64 total_size) {
+            CUW3_CHECK(arena, "arena was null");
+            CUW3_CHECK(total_size, "size was zero");
+
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.type() == (uint64)RegionChunkType::FastArenaStepSplitAllocator, "arena does not belong to this allocator");
+
+            return retire_arena_(arena, arena_view.retire_allocations(total_size));
+        }
+
+        [[nodiscard]] RetireReclaimPtr retire_arena_(FastArena* arena, RetireReclaimPtr old_resource) {
             if (RetireReclaimFlagsHelper{old_resource}.retired()) {
                 return old_resource; // we observed the resource as retired, we cannot proceed
             }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "cuw3.hpp"
+#include "export.hpp"
+#include "allocator.hpp"
+#include "thread_local_allocator.hpp"
+
+// header inline fast path: same thread small alloc / free served by the tcache without a call into the library
+// * allocator and tla pointers are plain globals: no static init guard, tla is an initial-exec tls slot (one fs relative load)
+// * tla pointer is null until the thread goes through cuw3_alloc / cuw3_free once and after the thread has released its tla
+// * everything else (empty or full bin, remote pointer, periodic reclaim and graveyard cleanup) goes through cuw3_alloc / cuw3_free
+// * initial-exec tls requires the library to be loaded at startup (linked, not dlopen-ed)
+// * thread local data cannot be imported from a dll so on windows the fast path is just a call
+#if !defined _WIN32
+    #define CUW3_INLINE_FAST_PATH 1
+#else
+    #define CUW3_INLINE_FAST_PATH 0
+#endif
+
+namespace cuw3 {
+#if CUW3_INLINE_FAST_PATH
+    CUW3_API extern constinit Allocator* fast_path_allocator; // set once the allocator is created, never reset
+    CUW3_API extern constinit thread_local ThreadLocalAllocator* fast_path_tla [[gnu::tls_model("initial-exec")]];
+#endif
+
+    inline void* alloc_inline(uint64 size, uint64 alignment) {
+#if CUW3_INLINE_FAST_PATH
+        if (auto* tla = fast_path_tla) {
+            if (void* block = fast_path_allocator->try_allocate_cached(tla, size, alignment)) {
+                return block;
+            }
+        }
+#endif
+        return cuw3_alloc(size, alignment);
+    }
+
+    // counts as a free for both cleanup cadences: free that is due for reclaim or graveyard cleanup goes the full path
+    // so inline frees run both cleanups as often as cuw3_free does
+    inline void free_inline(void* ptr, uint64 size) {
+#if CUW3_INLINE_FAST_PATH
+        auto* tla = fast_path_tla;
+        if (tla && (tla->this_cleanup_counter + 1) % cuw3_try_reclaim_each_op != 0 && (tla->grave_cleanup_counter + 1) % cuw3_try_cleanup_each_op != 0) {
+            if (fast_path_allocator->try_deallocate_cached(tla, ptr, size)) {
+                tla->this_cleanup_counter++;
+                tla->grave_cleanup_counter++;
+                return;
+            }
+        }
+#endif
+        cuw3_free(ptr, size);
+    }
+}
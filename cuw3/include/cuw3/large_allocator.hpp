@@ -0,0 +1,259 @@
+#pragma once
+
+#include <atomic>
+
+#include "conf.hpp"
+#include "vmem.hpp"
+#include "funcs.hpp"
+#include "utils.hpp"
+#include "assert.hpp"
+
+namespace cuw3 {
+    inline constexpr uint64 large_span_empty_key = 0;
+    inline constexpr uint64 large_span_tombstone_key = 1;
+
+    // cached span is packed into a single word: address and size both in pages
+    inline constexpr uint64 large_span_cache_unit_log2 = intlog2<uint64>(CUW3_PAGE_SIZE);
+    inline constexpr uint64 large_span_cache_size_shift = conf_address_space_bits - large_span_cache_unit_log2;
+    static_assert(large_span_cache_size_shift + conf_max_cached_large_span_log2 - large_span_cache_unit_log2 < 64, "cached span does not fit into a word");
+
+    // allocations that no region chunk can hold get a dedicated vmem span
+    // * spans have no headers: span address is the key of a global open addressing table (linear probing)
+    //   that stores span size, so the pointer is looked up the same way from any thread
+    // * slot is claimed with a cas on the key, size is written after: only whoever holds the pointer reads it
+    //   and pointer is published after the size is written. Freed slot becomes a tombstone so probe chains stay intact
+    // * a few freed spans are kept mapped (lazily purged) so big buffers allocated in a loop do not mmap/munmap each time
+    // * spans are resized with vmem_remap(): pages are moved by the kernel, nothing is copied
+    struct LargeSpanEntry {
+        uint64 key{}; // atomic, span address
+        uint64 size{}; // atomic, page aligned
+    };
+
+    struct LargeAllocatorConfig {
+        VMemAllocType span_alloc_type{}; // VMemReserveCommit with optional huge page hints
+    };
+
+    struct LargeAllocator {
+        [[nodiscard]] static LargeAllocator* create(Memory memory, const LargeAllocatorConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<LargeAllocator>(), nullptr, "invalid memory");
+            CUW3_CHECK_RETURN_VAL((config.span_alloc_type & VMemReserveCommit) == VMemReserveCommit, nullptr, "spans must be committed");
+
+            auto* large = new (memory.get()) LargeAllocator{};
+            large->span_alloc_type = config.span_alloc_type;
+            large->page_size = vmem_page_size();
+            CUW3_CHECK_RETURN_VAL(large->page_size >= CUW3_PAGE_SIZE, nullptr, "page is smaller than the cache unit");
+            return large;
+        }
+
+        // live spans are released too, allocator is gone anyway
+        static void destroy(LargeAllocator* large) {
+            for (auto& entry : large->table) {
+                if (entry.key > large_span_tombstone_key) {
+                    vmem_free((void*)entry.key, entry.size);
+                    entry = {};
+                }
+            }
+            large->release_cached_spans(~(uint64)0);
+        }
+
+
+        uint64 hash_(uint64 key) const {
+            return (divpow2(key, large_span_cache_unit_log2) * 0x9E3779B97F4A7C15ull) >> (64 - intlog2(conf_large_span_table_size));
+        }
+
+        [[nodiscard]] bool insert_(void* span, uint64 size) {
+            auto key = (uint64)span;
+            auto start = hash_(key);
+            for (uint64 i = 0; i < conf_large_span_table_size; i++) {
+                auto& entry = table[(start + i) & (conf_large_span_table_size - 1)];
+                auto key_ref = std::atomic_ref{entry.key};
+                uint64 curr = key_ref.load(std::memory_order_relaxed);
+                while (curr <= large_span_tombstone_key) {
+                    if (key_ref.compare_exchange_weak(curr, key, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                        std::atomic_ref{entry.size}.store(size, std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] LargeSpanEntry* find_(void* span) {
+            auto key = (uint64)span;
+            auto start = hash_(key);
+            for (uint64 i = 0; i < conf_large_span_table_size; i++) {
+                auto& entry = table[(start + i) & (conf_large_span_table_size - 1)];
+                uint64 curr = std::atomic_ref{entry.key}.load(std::memory_order_relaxed);
+                if (curr == key) {
+                    return &entry;
+                }
+                if (curr == large_span_empty_key) {
+                    return nullptr;
+                }
+            }
+            return nullptr;
+        }
+
+        void erase_(LargeSpanEntry* entry) {
+            std::atomic_ref{entry->key}.store(large_span_tombstone_key, std::memory_order_relaxed);
+        }
+
+        uint64 span_size_(uint64 size) const {
+            return align(std::max<uint64>(size, 1), page_size);
+        }
+
+
+        // takes any cached span that fits the size and is not too wasteful (within 1.25x)
+        [[nodiscard]] void* take_cached_span_(uint64 size, uint64 alignment, uint64& span_size) {
+            for (auto& slot : cached_spans) {
+                auto slot_ref = std::atomic_ref{slot};
+                uint64 packed = slot_ref.load(std::memory_order_relaxed);
+                if (!packed) {
+                    continue;
+                }
+                void* span = (void*)mulpow2(modpow2(packed, large_span_cache_size_shift), large_span_cache_unit_log2);
+                uint64 cached_size = mulpow2(divpow2(packed, large_span_cache_size_shift), large_span_cache_unit_log2);
+                if (cached_size < size || cached_size - size > size / 4 || !is_aligned(span, alignment)) {
+                    continue;
+                }
+                if (slot_ref.compare_exchange_strong(packed, 0, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    span_size = cached_size;
+                    return span;
+                }
+            }
+            return nullptr;
+        }
+
+        [[nodiscard]] bool put_cached_span_(void* span, uint64 span_size) {
+            if (span_size > intpow2(conf_max_cached_large_span_log2)) {
+                return false;
+            }
+            uint64 packed = divpow2((uint64)span, large_span_cache_unit_log2) | mulpow2(divpow2(span_size, large_span_cache_unit_log2), large_span_cache_size_shift);
+            for (auto& slot : cached_spans) {
+                auto slot_ref = std::atomic_ref{slot};
+                uint64 expected = 0;
+                if (slot_ref.load(std::memory_order_relaxed) == 0 && slot_ref.compare_exchange_strong(expected, packed, std::memory_order_release, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void release_span_(void* span, uint64 span_size) {
+            // pages are given back lazily, span is reused as is if nobody needed the memory meanwhile
+            if (conf_large_span_cache_size && vmem_purge(span, span_size, VMemPurgeFree) && put_cached_span_(span, span_size)) {
+                return;
+            }
+            vmem_free(span, span_size);
+        }
+
+
+        // API
+        [[nodiscard]] void* allocate(uint64 size, uint64 alignment) {
+            if (size > intpow2(conf_address_space_bits) || alignment > intpow2(conf_address_space_bits)) {
+                return nullptr;
+            }
+            uint64 span_size = span_size_(size);
+            void* span = take_cached_span_(span_size, alignment, span_size);
+            if (!span) {
+                span = vmem_alloc_aligned(span_size, span_alloc_type, alignment);
+                if (!span) {
+                    return nullptr;
+                }
+            }
+            if (!insert_(span, span_size)) {
+                vmem_free(span, span_size);
+                return nullptr;
+            }
+            return span;
+        }
+
+        // ptr must be the address returned by allocate()
+        bool owns(void* ptr) {
+            return find_(ptr) != nullptr;
+        }
+
+        void deallocate(void* ptr) {
+            auto* entry = find_(ptr);
+            CUW3_CHECK(entry, "attempt to deallocate invalid pointer");
+
+            uint64 span_size = std::atomic_ref{entry->size}.load(std::memory_order_relaxed);
+            erase_(entry);
+            release_span_(ptr, span_size);
+        }
+
+        uint64 usable_size(void* ptr) {
+            auto* entry = find_(ptr);
+            CUW3_CHECK(entry, "invalid pointer");
+
+            return std::atomic_ref{entry->size}.load(std::memory_order_relaxed);
+        }
+
+        // span keeps its address: shrink always succeeds (except windows), grow succeeds if the pages after the span are free
+        [[nodiscard]] bool try_resize(void* ptr, uint64 new_size) {
+            auto* entry = find_(ptr);
+            CUW3_CHECK(entry, "invalid pointer");
+
+            uint64 span_size = std::atomic_ref{entry->size}.load(std::memory_order_relaxed);
+            uint64 new_span_size = span_size_(new_size);
+            if (new_span_size == span_size) {
+                return true;
+            }
+            if (!vmem_remap(ptr, span_size, new_span_size, false)) {
+                return false;
+            }
+            std::atomic_ref{entry->size}.store(new_span_size, std::memory_order_relaxed);
+            return true;
+        }
+
+        // span may move, its pages move along with it, returns nullptr if the span was left intact
+        // only page alignment survives the move
+        [[nodiscard]] void* reallocate(void* ptr, uint64 new_size, uint64 alignment) {
+            if (try_resize(ptr, new_size)) {
+                return ptr;
+            }
+            if (alignment > page_size) {
+                return nullptr;
+            }
+
+            auto* entry = find_(ptr);
+            uint64 span_size = std::atomic_ref{entry->size}.load(std::memory_order_relaxed);
+            uint64 new_span_size = span_size_(new_size);
+            void* new_ptr = vmem_remap(ptr, span_size, new_span_size, true);
+            if (!new_ptr) {
+                return nullptr;
+            }
+            erase_(entry);
+            if (!insert_(new_ptr, new_span_size)) {
+                // table is full only if the slot we have just freed was taken, give up on the span
+                vmem_free(new_ptr, new_span_size);
+                return nullptr;
+            }
+            return new_ptr;
+        }
+
+        // unmaps cached spans until max_bytes were released, returns amount of bytes released
+        uint64 release_cached_spans(uint64 max_bytes) {
+            uint64 released{};
+            for (auto& slot : cached_spans) {
+                if (released >= max_bytes) {
+                    break;
+                }
+                uint64 packed = std::atomic_ref{slot}.exchange(0, std::memory_order_acquire);
+                if (!packed) {
+                    continue;
+                }
+                void* span = (void*)mulpow2(modpow2(packed, large_span_cache_size_shift), large_span_cache_unit_log2);
+                uint64 span_size = mulpow2(divpow2(packed, large_span_cache_size_shift), large_span_cache_unit_log2);
+                vmem_free(span, span_size);
+                released += span_size;
+            }
+            return released;
+        }
+
+        LargeSpanEntry table[conf_large_span_table_size] = {};
+        uint64 cached_spans[std::max<usize>(conf_large_span_cache_size, 1)] = {}; // atomic, packed span, zero if empty
+        VMemAllocType span_alloc_type{}; // readonly
+        uint64 page_size{}; // readonly
+    };
+}
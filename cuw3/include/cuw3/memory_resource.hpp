@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cuw3.hpp"
+#include "export.hpp"
+#include "fast_path.hpp"
+
+#include <new>
+#include <limits>
+#include <cstddef>
+#include <memory_resource>
+
+namespace cuw3 {
+    // std::pmr adapter: deallocate already knows size and alignment so it goes straight into the sized free
+    // stateless, all instances are equal, allocation may be freed by any thread
+    class CUW3_API MemoryResource final : public std::pmr::memory_resource {
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override; // throws std::bad_alloc on failure
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    // process wide instance, never destroyed
+    CUW3_API MemoryResource* get_memory_resource();
+
+
+    // std allocator adapter: n of deallocate gives the size for the sized free, tcache hits are served inline (see fast_path.hpp)
+    template<class T>
+    struct StlAllocator {
+        using value_type = T;
+
+        StlAllocator() noexcept = default;
+
+        template<class U>
+        StlAllocator(const StlAllocator<U>&) noexcept {}
+
+        [[nodiscard]] T* allocate(std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            void* ptr = alloc_inline(n * sizeof(T), alignof(T));
+            if (!ptr) {
+                throw std::bad_alloc();
+            }
+            return (T*)ptr;
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept {
+            free_inline(ptr, n * sizeof(T));
+        }
+
+        template<class U>
+        bool operator==(const StlAllocator<U>&) const noexcept {
+            return true;
+        }
+    };
+}
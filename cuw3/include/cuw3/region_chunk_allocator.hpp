@@ -3,6 +3,7 @@
 #include "ptr.hpp"
 #include "defs.hpp"
 #include "conf.hpp"
+#include "vmem.hpp"
 #include "funcs.hpp"
 #include "assert.hpp"
 #include "atomic.hpp"
@@ -12,6 +13,10 @@
 namespace cuw3 {
     inline constexpr uint32 region_chunk_allocator_null_value = 0xFFFFFFFF;
     inline constexpr uint32 region_chunk_allocator_failed_value = 0xFFFFFFFE;
+    inline constexpr uint64 region_chunk_allocator_null_offset = ~(uint64)0;
+
+    inline constexpr uint64 region_chunk_block_listed = (uint64)1 << 63;
+    inline constexpr uint64 region_chunk_block_max_chunks_log2 = 5;
 
     struct RegionChunkAllocatorSpecsConfig {
         const uint64* region_sizes{};
@@ -23,6 +28,11 @@ namespace cuw3 {
         uint64 handle_size{};
         uint64 region_alignment{};
         uint64 handle_alignment{};
+
+        uint64 segment_size_log2{}; // 0 - regions are a single contiguous range
+        uint64 address_space_bits{}; // used only with segments
+
+        bool unified{}; // all regions share a single range, see RegionChunkBlock
     };
 
     struct RegionSpec {
@@ -98,11 +108,27 @@ namespace cuw3 {
 
     inline constexpr RegionChunkLocation null_region_chunk_location = {region_chunk_allocator_null_value};
 
-    // NOTE : this is, I think, the most simple version of what can be done
-    // Of course, this implementation can be made more adaptable to real-world circumstances
-    // Instead of preallocated range of reserved virtual memory we can have several slots (pointers)  
-    // Like, one slot points to some allocation of predefined amount of space. We add another one I we truely need it.
-    // This may help to save some virtual memory space as well ... it may become an issue with this allocator
+    // unified regions: every region spans the same range that is carved into blocks of the max chunk size
+    // * free block is taken from the block pool by a region and split into its chunks, free chunks are bits of free_chunks
+    // * block with free chunks is listed in a pool of its region (region_chunk_block_listed is set while it is listed or held),
+    //   whoever frees a chunk of an unlisted block lists it back
+    // * block is merged back into the block pool once all its chunks are free: right away if it is not listed,
+    //   lazily otherwise: listed blocks are swept only when the block pool runs dry
+    // * chunk lookup stays O(1): offset -> block -> owner region -> chunk
+    // * handles are still per region so handle of a chunk is valid only while the block is owned by the region
+    struct RegionChunkBlock {
+        uint64 free_chunks{}; // atomic, bit per free chunk of the owner region + region_chunk_block_listed
+        RegionChunkPoolLinkType next{}; // atomic, link within the block pool or within the owner pool
+        uint32 region{}; // atomic, owner region, valid while any chunk of the block is allocated
+        uint32 split{}; // atomic, owner pool split
+    };
+
+    // regions are laid out in a single logical range, offset within it is what chunk lookup works with
+    // the range is either backed by one contiguous reservation or by segments:
+    // * segment is an aligned reservation of segment size, it is reserved once its first chunk is allocated
+    // * logical offset -> ptr: segment table indexed by the logical segment
+    // * ptr -> logical offset: segment map indexed by the address slot of the segment (address >> segment size log2)
+    //   so the lookup stays O(1), segment alignment guarantees that no chunk straddles segments
     //
     // stores layout of the regions and handles
     // this is a read-only data structure
@@ -117,8 +143,25 @@ namespace cuw3 {
             CUW3_CHECK_RETURN_VAL(is_alignment(config.region_alignment), nullptr, "invalid alignment value for region_storage");
             CUW3_CHECK_RETURN_VAL(is_alignment(config.handle_alignment), nullptr, "invalid handle storage alignment");
             CUW3_CHECK_RETURN_VAL(is_aligned(config.handle_size, config.handle_alignment), nullptr, "handle_size is not aligned");
+            if (config.segment_size_log2) {
+                CUW3_CHECK_RETURN_VAL(config.segment_size_log2 < config.address_space_bits && config.address_space_bits <= 64, nullptr, "invalid address space bits");
+                CUW3_CHECK_RETURN_VAL(config.region_alignment <= intpow2(config.segment_size_log2), nullptr, "region alignment exceeds segment size");
+                for (usize i = 0; i < config.num_region_sizes; i++) {
+                    CUW3_CHECK_RETURN_VAL(config.region_sizes[i] >= config.segment_size_log2, nullptr, "region must consist of whole segments");
+                    CUW3_CHECK_RETURN_VAL(config.region_chunk_sizes[i] <= config.segment_size_log2, nullptr, "chunk does not fit into a segment");
+                }
+            }
 
             bool all_region_sizes_equal = all_equal(config.region_sizes, config.region_sizes + config.num_region_sizes);
+            uint64 block_size_log2 = config.region_chunk_sizes[config.num_region_chunk_sizes - 1];
+            if (config.unified) {
+                CUW3_CHECK_RETURN_VAL(all_region_sizes_equal, nullptr, "unified regions must be of equal size");
+                CUW3_CHECK_RETURN_VAL(config.region_sizes[0] >= block_size_log2, nullptr, "region must consist of whole blocks");
+                for (usize i = 0; i < config.num_region_chunk_sizes; i++) {
+                    CUW3_CHECK_RETURN_VAL(config.region_chunk_sizes[i] <= block_size_log2, nullptr, "chunk does not fit into a block");
+                    CUW3_CHECK_RETURN_VAL(block_size_log2 - config.region_chunk_sizes[i] <= region_chunk_block_max_chunks_log2, nullptr, "too many chunks per block");
+                }
+            }
             uint64 region_size = all_region_sizes_equal ? align(intpow2(config.region_sizes[0]), config.region_alignment) : 0;
             uint64 region_size_log2 = all_region_sizes_equal ? pow2log2(region_size) : 0;
 
@@ -154,16 +197,33 @@ namespace cuw3 {
                 specs->region_search_sentinels[i] = region_offset + region_size;
 
                 handle_offset += num_handles;
-                region_offset += region_size;
+                region_offset += config.unified ? 0 : region_size;
             }
 
-            specs->total_regions_size = region_offset;
+            specs->total_regions_size = config.unified ? specs->region_specs[0].region_size : region_offset;
             specs->total_handles_size = align(mulpow2(handle_offset, specs->handle_size_log2), specs->handle_alignment);
             specs->num_handles = handle_offset;
 
             specs->total_pool_handles_size = sizeof(RegionChunkPoolLinkType) * specs->num_handles;
             specs->pool_handles_alignment = alignof(RegionChunkPoolLinkType);
 
+            if (config.unified) {
+                specs->unified = true;
+                specs->block_size_log2 = block_size_log2;
+                specs->num_blocks = divpow2(specs->total_regions_size, block_size_log2);
+                specs->total_blocks_size = sizeof(RegionChunkBlock) * specs->num_blocks;
+                specs->blocks_alignment = alignof(RegionChunkBlock);
+                CUW3_CHECK_RETURN_VAL(specs->num_blocks < region_chunk_allocator_failed_value, nullptr, "too many blocks");
+            }
+
+            if (config.segment_size_log2) {
+                specs->segment_size_log2 = config.segment_size_log2;
+                specs->num_segments = divpow2(specs->total_regions_size, config.segment_size_log2);
+                specs->total_segments_size = sizeof(void*) * specs->num_segments;
+                specs->num_segment_slots = intpow2(config.address_space_bits - config.segment_size_log2);
+                specs->total_segment_map_size = sizeof(uint32) * specs->num_segment_slots;
+            }
+
             return specs;
         }
 
@@ -213,7 +273,14 @@ namespace cuw3 {
             return region_chunk_allocator_null_value;
         }
 
+        // unified regions share offsets, region is known from the owner of the block
+        [[nodiscard]] RegionChunkLocation locate_region_chunk(uint64 relptr, uint32 region) const {
+            return locate_chunk_common_(relptr, region);
+        }
+
         [[nodiscard]] RegionChunkLocation locate_chunk(uint64 relptr) const {
+            CUW3_ASSERT(!unified, "chunk of unified regions cannot be located by offset only");
+
             if (region_size) {
                 return locate_chunk_all_regions_equal_(relptr);
             }
@@ -255,6 +322,18 @@ namespace cuw3 {
 
         uint64 total_pool_handles_size{}; // readonly, in bytes
         uint64 pool_handles_alignment{}; // readonly, in bytes
+
+        uint64 segment_size_log2{}; // readonly, zero if regions are contiguous
+        uint64 num_segments{}; // readonly
+        uint64 total_segments_size{}; // readonly, in bytes, size of the segment table
+        uint64 num_segment_slots{}; // readonly, segment sized slots of the address space
+        uint64 total_segment_map_size{}; // readonly, in bytes
+
+        bool unified{}; // readonly, all regions share a single range
+        uint64 block_size_log2{}; // readonly, unified regions only, intlog2(max chunk size)
+        uint64 num_blocks{}; // readonly
+        uint64 total_blocks_size{}; // readonly, in bytes
+        uint64 blocks_alignment{}; // readonly
     };
 
 
@@ -279,11 +358,25 @@ namespace cuw3 {
     using RegionChunkPoolStackTop = RegionChunkPoolLinkType;
     using RegionChunkPoolStackView = AtomicBumpStackView<RegionPoolCommonTraits>;
 
-    using RegionChunkAllocatorBackoff = SimpleBackoff;
+    // spins grow exponentially with every failed cas, failures are counted so pools can report contention
+    struct RegionChunkAllocatorBackoff {
+        void operator() () {
+            failures++;
+            backoff();
+        }
+
+        ExpBackoff<2, 1, conf_region_chunk_pool_max_backoff_spins> backoff{};
+        uint32 failures{};
+    };
 
+    // free list and stack are hammered by different traffic (reuse vs fresh chunks) so they do not share a cache line
+    // stack is exhausted once and then only read, bounds live next to it
+    // cas failures counter is only touched after a failed cas so it shares the (already contended) list cache line
     struct alignas(conf_cacheline) RegionPoolEntry {
         RegionChunkPoolListHead free_list{}; // atomic
-        RegionChunkPoolStackTop free_stack{}; // atomic
+        uint64 cas_failures{}; // atomic, statistics
+
+        alignas(conf_cacheline) RegionChunkPoolStackTop free_stack{}; // atomic
         RegionChunkPoolLinkType first_handle{}; // readonly
         RegionChunkPoolLinkType last_handle{}; // readonly
     };
@@ -311,10 +404,15 @@ namespace cuw3 {
             for (usize pool = 0; pool < conf_max_region_sizes; pool++) {
                 auto& region_specs = specs->region_specs[pool];
 
+                // unified regions: pools list blocks, fresh chunks come from the blocks of the block pool so stacks are empty
                 uint32 handles_per_split = (region_specs.num_handles + contention_split - 1) / contention_split;
                 for (usize split = 0; split < conf_max_contention_split; split++) {
                     uint64 first_handle = region_specs.handle_offset + std::min<uint32>(handles_per_split * split, region_specs.num_handles);
                     uint64 last_handle = region_specs.handle_offset + std::min<uint32>(handles_per_split * (split + 1), region_specs.num_handles);
+                    if (specs->unified) {
+                        first_handle = 0;
+                        last_handle = 0;
+                    }
 
                     auto& pool_entry = pools->pool_entries[pool][split];
                     pool_entry.free_list = {0, region_chunk_pool_null_link};
@@ -325,6 +423,11 @@ namespace cuw3 {
                     pools->split_search_sentinels[pool][split] = last_handle;
                 }
             }
+
+            pools->block_pool.free_list = {0, region_chunk_pool_null_link};
+            pools->block_pool.free_stack = 0;
+            pools->block_pool.first_handle = 0;
+            pools->block_pool.last_handle = specs->num_blocks;
             return pools;
         }
 
@@ -348,14 +451,32 @@ namespace cuw3 {
         }
 
 
+        // cas_failures accumulates failed cas attempts of the call
         template<class PoolOps>
-        [[nodiscard]] RegionChunkPoolLinkType allocate_from_list(uint32 region, uint32 split, int alloc_attempts, PoolOps&& ops) {
+        [[nodiscard]] RegionChunkPoolLinkType allocate_from_list(uint32 region, uint32 split, int alloc_attempts, uint32& cas_failures, PoolOps&& ops) {
             CUW3_CHECK(region < num_regions, "invalid region");
             CUW3_CHECK(split < num_splits, "invalid split");
 
             auto& entry = pool_entries[region][split];
             auto list_view = RegionChunkPoolListView{&entry.free_list};
-            return list_view.pop(alloc_attempts, RegionChunkAllocatorBackoff{}, ops);
+            RegionChunkAllocatorBackoff backoff{};
+            auto handle = list_view.pop(alloc_attempts, backoff, ops);
+            cas_failures += record_contention_(entry, backoff);
+            return handle;
+        }
+
+        // popped handles stay linked through the pool handles
+        template<class PoolOps>
+        [[nodiscard]] RegionChunkPoolLinkType allocate_chain_from_list(uint32 region, uint32 split, uint32 max_count, uint32& count, int alloc_attempts, uint32& cas_failures, PoolOps&& ops) {
+            CUW3_CHECK(region < num_regions, "invalid region");
+            CUW3_CHECK(split < num_splits, "invalid split");
+
+            auto& entry = pool_entries[region][split];
+            auto list_view = RegionChunkPoolListView{&entry.free_list};
+            RegionChunkAllocatorBackoff backoff{};
+            auto handle = list_view.pop_chain(alloc_attempts, max_count, count, backoff, ops);
+            cas_failures += record_contention_(entry, backoff);
+            return handle;
         }
 
         RegionChunkPoolLinkType allocate_from_stack(uint32 region, uint32 split) {
@@ -367,6 +488,16 @@ namespace cuw3 {
             return stack_view.bump();
         }
 
+        // returns first of count consecutive handles
+        RegionChunkPoolLinkType allocate_range_from_stack(uint32 region, uint32 split, uint32 max_count, uint32& count) {
+            CUW3_CHECK(region < num_regions, "invalid region");
+            CUW3_CHECK(split < num_splits, "invalid split");
+
+            auto& pool_entry = pool_entries[region][split];
+            auto stack_view = RegionChunkPoolStackView{&pool_entry.free_stack, pool_entry.last_handle};
+            return stack_view.bump(max_count, count);
+        }
+
         template<class PoolOps>
         void deallocate(RegionChunkPoolLinkType handle, uint32 region, uint32 split, PoolOps&& ops) {
             CUW3_CHECK(region < num_regions, "invalid region");
@@ -374,17 +505,73 @@ namespace cuw3 {
 
             auto& pool_entry = pool_entries[region][split];
             auto list_view = RegionChunkPoolListView{&pool_entry.free_list};
-            list_view.push(handle, RegionChunkAllocatorBackoff{}, ops);
+            RegionChunkAllocatorBackoff backoff{};
+            list_view.push(handle, backoff, ops);
+            record_contention_(pool_entry, backoff);
+        }
+
+        // first -> ... -> last must be linked through the pool handles
+        template<class PoolOps>
+        void deallocate_chain(RegionChunkPoolLinkType first, RegionChunkPoolLinkType last, uint32 region, uint32 split, PoolOps&& ops) {
+            CUW3_CHECK(region < num_regions, "invalid region");
+            CUW3_CHECK(split < num_splits, "invalid split");
+
+            auto& pool_entry = pool_entries[region][split];
+            auto list_view = RegionChunkPoolListView{&pool_entry.free_list};
+            RegionChunkAllocatorBackoff backoff{};
+            list_view.push_chain(first, last, backoff, ops);
+            record_contention_(pool_entry, backoff);
+        }
+
+        // unified regions only: whole free block, merged ones go first
+        template<class PoolOps>
+        [[nodiscard]] RegionChunkPoolLinkType allocate_block(int alloc_attempts, uint32& cas_failures, PoolOps&& ops) {
+            auto list_view = RegionChunkPoolListView{&block_pool.free_list};
+            RegionChunkAllocatorBackoff backoff{};
+            auto block = list_view.pop(alloc_attempts, backoff, ops);
+            cas_failures += record_contention_(block_pool, backoff);
+            if (block != region_chunk_pool_null_link) {
+                return block;
+            }
+
+            auto stack_view = RegionChunkPoolStackView{&block_pool.free_stack, block_pool.last_handle};
+            return stack_view.bump();
+        }
+
+        template<class PoolOps>
+        void deallocate_block(RegionChunkPoolLinkType block, PoolOps&& ops) {
+            auto list_view = RegionChunkPoolListView{&block_pool.free_list};
+            RegionChunkAllocatorBackoff backoff{};
+            list_view.push(block, backoff, ops);
+            record_contention_(block_pool, backoff);
+        }
+
+        // total number of failed cas attempts on the free list of the pool split
+        uint64 cas_failures(uint32 region, uint32 split) {
+            CUW3_CHECK(region < num_regions, "invalid region");
+            CUW3_CHECK(split < num_splits, "invalid split");
+
+            return std::atomic_ref{pool_entries[region][split].cas_failures}.load(std::memory_order_relaxed);
+        }
+
+        uint32 record_contention_(RegionPoolEntry& entry, const RegionChunkAllocatorBackoff& backoff) {
+            if (backoff.failures) {
+                std::atomic_ref{entry.cas_failures}.fetch_add(backoff.failures, std::memory_order_relaxed);
+            }
+            return backoff.failures;
         }
 
 
         // NOTE : this layout is not ideal and subject to experimentation and future changes
         // while it is originally aimed to split contention between several thread it is truely unknown how effective it will be
         // Possible experimentation points can be:
-        // * store free_stack and stack_limit separately from free_list
         // * free_stack can be sharded separately from free_lists
+        // threads start from different splits (see ThreadLocalAllocator::create()) so they do not pile up on the first one
         RegionPoolEntry pool_entries[conf_max_region_sizes][conf_max_contention_split] = {};
 
+        // unified regions only: whole free blocks shared by all regions, empty otherwise
+        RegionPoolEntry block_pool{};
+
         // in fact, it is enough to search using stack_limit from pool entry
         // but it is too volatile, its cacheline can be modified by multiple threads
         // so it is better to store all sentinels outside of the pool entry
@@ -402,6 +589,7 @@ namespace cuw3 {
         int attempts = -1; // pool allocation attempts
         uint split_start = 0;
         uint split_step = 1;
+        uint32* cas_failures = nullptr; // optional, failed cas attempts on the pool free lists are added to it
     };
 
     // NOTE : it would be more convenient if this structure stored chunk_size with it
@@ -431,6 +619,22 @@ namespace cuw3 {
     inline constexpr RegionChunkAllocation null_region_chunk_allocation = {region_chunk_allocator_null_value};
     inline constexpr RegionChunkAllocation failed_region_chunk_allocation = {region_chunk_allocator_failed_value};
 
+    // thread local stash of fresh chunks of a single region, refilled with RegionChunkAllocator::allocate_chunks() in one go
+    // chunks are only reserved, whoever takes them commits them
+    struct RegionChunkMagazine {
+        bool empty() const {
+            return count == 0;
+        }
+
+        [[nodiscard]] RegionChunkAllocation pop() {
+            CUW3_ASSERT(!empty(), "attempt to pop from empty magazine");
+            return chunks[--count];
+        }
+
+        RegionChunkAllocation chunks[std::max<usize>(conf_chunk_magazine_size, 1)] = {};
+        uint32 count{};
+    };
+
     // NOTE : can be named better, does not properly reflect that is contains both chunk memory + its handle
     struct RegionChunkMemory {
         explicit operator bool() const {
@@ -450,15 +654,21 @@ namespace cuw3 {
     struct RegionAllocatorConfig {
         const RegionChunkAllocatorSpecs* specs{};
         RegionChunkAllocatorPools* pools{};
-        void* regions{};
+        void* regions{}; // contiguous regions only
         void* handles{};
         void* pool_handles{};
+        RegionChunkBlock* blocks{}; // unified regions only, zeroed
+
+        // segmented regions only
+        void** segments{}; // zeroed
+        uint32* segment_map{}; // zeroed
+        VMemAllocType segment_alloc_type{};
     };
 
-    // NOTE : we can add here cache that will store some retired region chunks
-    //   so we can fastly store them there without decommitting memory
-    //   and we can fastly acquire them from there without committing memory
-    // NOTE : we can commit them not all at once but sequentially when needed
+    // NOTE : committed chunks are cached outside, see region_chunk_cache.hpp
+    // NOTE : arena chunks are committed sequentially by the arena itself, see FastArenaView::acquire()
+    //
+    // segments are never released until the allocator is destroyed: chunk lookup would have to synchronize with it
     //
     // this is commonly a global shared entity
     struct RegionChunkAllocator {
@@ -484,19 +694,98 @@ namespace cuw3 {
             RegionChunkAllocator* alloc{};
         };
 
+        struct RegionAllocatorBlockOps {
+            void set_next(RegionChunkPoolLinkType node, RegionChunkPoolLinkType next) {
+                CUW3_CHECK(node < alloc->specs->num_blocks, "invalid link value 'node' passed");
+                CUW3_CHECK(next < alloc->specs->num_blocks || next == region_chunk_pool_null_link, "invalid link value 'next' passed");
+
+                std::atomic_ref{alloc->blocks[node].next}.store(next, std::memory_order_relaxed);
+            }
+
+            RegionChunkPoolLinkType get_next(RegionChunkPoolLinkType node) {
+                CUW3_CHECK(node < alloc->specs->num_blocks, "invalid node block passed");
+
+                return std::atomic_ref{alloc->blocks[node].next}.load(std::memory_order_relaxed);
+            }
+
+            RegionChunkAllocator* alloc{};
+        };
+
 
         [[nodiscard]] static RegionChunkAllocator* create(Memory memory, const RegionAllocatorConfig& config) {
             CUW3_CHECK_RETURN_VAL(memory.fits<RegionChunkAllocator>(), nullptr, "invalid memory");
 
+            if (config.specs->segment_size_log2) {
+                CUW3_CHECK_RETURN_VAL(config.segments && config.segment_map, nullptr, "segment tables were not provided");
+            } else {
+                CUW3_CHECK_RETURN_VAL(config.regions, nullptr, "regions were not provided");
+            }
+            if (config.specs->unified) {
+                CUW3_CHECK_RETURN_VAL(config.blocks, nullptr, "blocks were not provided");
+            }
+
             auto* alloc = new (memory.get()) RegionChunkAllocator{};
             alloc->specs = config.specs;
             alloc->pools = config.pools;
             alloc->regions = config.regions;
             alloc->handles = config.handles;
             alloc->pool_handles = config.pool_handles;
+            alloc->blocks = config.blocks;
+            alloc->segments = config.segments;
+            alloc->segment_map = config.segment_map;
+            alloc->segment_alloc_type = config.segment_alloc_type;
             return alloc;
         }
 
+        // frees all reserved segments, nothing must be allocated from the allocator at this point
+        void release_segments() {
+            if (!specs->segment_size_log2) {
+                return;
+            }
+            for (uint64 segment = 0; segment < specs->num_segments; segment++) {
+                if (void* segment_memory = segments[segment]) {
+                    segment_map[divpow2((uintptr)segment_memory, specs->segment_size_log2)] = 0;
+                    vmem_free(segment_memory, intpow2(specs->segment_size_log2));
+                    segments[segment] = nullptr;
+                }
+            }
+        }
+
+
+        // reserves segment of the chunk if it is not reserved yet
+        // map entry is published before the segment itself so anyone who sees the segment can also look its pointers up
+        [[nodiscard]] bool reserve_segment_(uint32 region, uint32 chunk) {
+            if (!specs->segment_size_log2) {
+                return true;
+            }
+
+            uint64 segment = divpow2(specs->region_specs[region].get_relchunk(chunk), specs->segment_size_log2);
+            auto segment_ref = std::atomic_ref{segments[segment]};
+            if (segment_ref.load(std::memory_order_acquire)) {
+                return true;
+            }
+
+            uint64 segment_size = intpow2(specs->segment_size_log2);
+            void* segment_memory = vmem_alloc_aligned(segment_size, segment_alloc_type, segment_size);
+            if (!segment_memory) {
+                return segment_ref.load(std::memory_order_acquire); // someone else could have succeeded
+            }
+
+            uint64 slot = divpow2((uintptr)segment_memory, specs->segment_size_log2);
+            if (slot >= specs->num_segment_slots) {
+                vmem_free(segment_memory, segment_size);
+                return false;
+            }
+            std::atomic_ref{segment_map[slot]}.store(segment + 1, std::memory_order_relaxed);
+
+            void* expected = nullptr;
+            if (!segment_ref.compare_exchange_strong(expected, segment_memory, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                std::atomic_ref{segment_map[slot]}.store(0, std::memory_order_relaxed);
+                vmem_free(segment_memory, segment_size);
+            }
+            return true;
+        }
+
 
         uint32 region_handle_to_chunk_(uint32 region, uint32 handle) {
             CUW3_ASSERT(region < specs->num_regions, "invalid region value");
@@ -513,21 +802,32 @@ namespace cuw3 {
             uint32 chunk = region_handle_to_chunk_(region, handle);
 
             auto& region_specs = specs->region_specs[region];
-            void* chunk_memory = region_specs.get_chunk(regions, chunk);
+            CUW3_CHECK(region_specs.check_chunk(chunk), "invalid chunk");
+            void* chunk_memory = offset_to_ptr(region_specs.get_relchunk(chunk));
             void* handle_memory = region_specs.get_handle(handles, handle);
             return {chunk_memory, region_specs.get_chunk_size(), handle_memory, specs->handle_size};
         }
 
-        [[nodiscard]] RegionChunkAllocation allocate_chunk_(uint32 region, RegionChunkAllocParams alloc_params) {
+        [[nodiscard]] RegionChunkAllocation allocate_chunk_(uint32 region, RegionChunkAllocParams alloc_params, uint32& cas_failures) {
             CUW3_ASSERT(region < specs->num_regions, "invalid region value");
 
             bool chunk_seen = false;
+            if (specs->unified) {
+                RegionChunkAllocation allocation{};
+                if (allocate_block_chunks_(region, 1, alloc_params, &allocation, chunk_seen, cas_failures)) {
+                    return allocation;
+                }
+                return chunk_seen
+                    ? RegionChunkAllocation{region_chunk_allocator_failed_value}
+                    : RegionChunkAllocation{region_chunk_allocator_null_value};
+            }
+
             for (
                 uint k = 0, split = pools->next_split(alloc_params.split_start);
                 k < pools->num_splits;
                 k++, split = pools->next_split(split, alloc_params.split_step)
             ) {
-                uint32 handle = pools->allocate_from_list(region, split, alloc_params.attempts, RegionAllocatorPoolHandleOps{this});
+                uint32 handle = pools->allocate_from_list(region, split, alloc_params.attempts, cas_failures, RegionAllocatorPoolHandleOps{this});
                 if (handle < specs->num_handles) {
                     return {region, region_handle_to_chunk_(region, handle), handle, split};
                 }
@@ -547,6 +847,268 @@ namespace cuw3 {
                 ? RegionChunkAllocation{region_chunk_allocator_failed_value}
                 : RegionChunkAllocation{region_chunk_allocator_null_value};
         }
+
+        // same walk as allocate_chunk_() but every split is asked for all the chunks still missing:
+        // chain from the free list (single cas), the rest from the stack (single bump)
+        [[nodiscard]] uint32 allocate_chunks_(uint32 region, uint32 count, RegionChunkAllocParams alloc_params, RegionChunkAllocation* allocations, bool& chunk_seen, uint32& cas_failures) {
+            CUW3_ASSERT(region < specs->num_regions, "invalid region value");
+
+            if (specs->unified) {
+                return allocate_block_chunks_(region, count, alloc_params, allocations, chunk_seen, cas_failures);
+            }
+
+            auto ops = RegionAllocatorPoolHandleOps{this};
+            uint32 allocated = 0;
+            for (
+                uint k = 0, split = pools->next_split(alloc_params.split_start);
+                k < pools->num_splits && allocated < count;
+                k++, split = pools->next_split(split, alloc_params.split_step)
+            ) {
+                uint32 popped = 0;
+                uint32 handle = pools->allocate_chain_from_list(region, split, count - allocated, popped, alloc_params.attempts, cas_failures, ops);
+                if (handle == region_chunk_allocator_failed_value) {
+                    chunk_seen = true;
+                    continue;
+                }
+                for (uint32 i = 0; i < popped; i++) {
+                    allocations[allocated++] = {region, region_handle_to_chunk_(region, handle), handle, split};
+                    if (i + 1 < popped) {
+                        handle = ops.get_next(handle);
+                    }
+                }
+                if (allocated == count) {
+                    break;
+                }
+
+                uint32 bumped = 0;
+                uint32 first_handle = pools->allocate_range_from_stack(region, split, count - allocated, bumped);
+                for (uint32 i = 0; i < bumped; i++) {
+                    allocations[allocated++] = {region, region_handle_to_chunk_(region, first_handle + i), first_handle + i, split};
+                }
+            }
+            return allocated;
+        }
+
+        // unified regions
+        uint64 block_chunks_log2_(uint32 region) const {
+            return specs->block_size_log2 - specs->region_specs[region].chunk_size_log2;
+        }
+
+        uint64 block_full_mask_(uint32 region) const {
+            return intpow2(intpow2(block_chunks_log2_(region))) - 1;
+        }
+
+        uint32 chunk_block_(uint32 region, uint32 chunk) const {
+            return divpow2(chunk, block_chunks_log2_(region));
+        }
+
+        RegionChunkAllocation block_chunk_to_allocation_(uint32 region, uint32 block, uint32 block_chunk, uint32 split) const {
+            uint32 chunk = mulpow2(block, block_chunks_log2_(region)) + block_chunk;
+            return {region, chunk, specs->region_specs[region].handle_offset + chunk, split};
+        }
+
+        uint32 search_pool_split_(uint32 region, uint32 handle) {
+            if (specs->unified) {
+                uint32 block = chunk_block_(region, region_handle_to_chunk_(region, handle));
+                return std::atomic_ref{blocks[block].split}.load(std::memory_order_relaxed);
+            }
+            return pools->search_pool_split(region, handle);
+        }
+
+        // block is held by the caller (popped from the pool or fresh one), up to max_count chunks are taken with a single cas
+        // block that still has free chunks stays marked as listed and goes back to the pool, otherwise next free lists it
+        uint32 take_block_chunks_(uint32 region, uint32 block, uint32 split, uint32 max_count, RegionChunkAllocation* allocations, uint32& cas_failures) {
+            auto free_chunks_ref = std::atomic_ref{blocks[block].free_chunks};
+            auto free_chunks_old = free_chunks_ref.load(std::memory_order_relaxed);
+            uint64 taken{};
+            uint64 left{};
+            RegionChunkAllocatorBackoff backoff{};
+            while (true) {
+                CUW3_ASSERT(free_chunks_old & region_chunk_block_listed, "block is not held");
+
+                taken = 0;
+                left = free_chunks_old & ~region_chunk_block_listed;
+                for (uint32 i = 0; i < max_count && left; i++) {
+                    taken |= left & (~left + 1);
+                    left &= left - 1;
+                }
+                auto free_chunks_new = left ? left | region_chunk_block_listed : 0;
+                if (free_chunks_ref.compare_exchange_weak(free_chunks_old, free_chunks_new, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+                backoff();
+            }
+            cas_failures += backoff.failures;
+
+            if (left) {
+                pools->deallocate(block, region, split, RegionAllocatorBlockOps{this});
+            }
+
+            uint32 count = 0;
+            for (; taken; taken &= taken - 1) {
+                allocations[count++] = block_chunk_to_allocation_(region, block, std::countr_zero(taken), split);
+            }
+            return count;
+        }
+
+        // free block is split into the chunks of the region, it is held by the caller so it is marked as listed
+        // block pool is swept for fully free blocks first if it is exhausted
+        [[nodiscard]] uint32 acquire_block_(uint32 region, uint32 split, int alloc_attempts, bool& chunk_seen, uint32& cas_failures) {
+            auto ops = RegionAllocatorBlockOps{this};
+            uint32 block = pools->allocate_block(alloc_attempts, cas_failures, ops);
+            if (block == region_chunk_pool_null_link && merge_free_blocks_()) {
+                block = pools->allocate_block(alloc_attempts, cas_failures, ops);
+            }
+            if (block == region_chunk_pool_failed_alloc) {
+                chunk_seen = true;
+                return region_chunk_pool_null_link;
+            }
+            if (block == region_chunk_pool_null_link) {
+                return region_chunk_pool_null_link;
+            }
+
+            auto& block_data = blocks[block];
+            std::atomic_ref{block_data.region}.store(region, std::memory_order_relaxed);
+            std::atomic_ref{block_data.split}.store(split, std::memory_order_relaxed);
+            std::atomic_ref{block_data.free_chunks}.store(block_full_mask_(region) | region_chunk_block_listed, std::memory_order_relaxed);
+            return block;
+        }
+
+        // blocks of the pool splits are taken first, fresh blocks are split only if no split had any
+        [[nodiscard]] uint32 allocate_block_chunks_(uint32 region, uint32 count, RegionChunkAllocParams alloc_params, RegionChunkAllocation* allocations, bool& chunk_seen, uint32& cas_failures) {
+            auto ops = RegionAllocatorBlockOps{this};
+            uint32 allocated = 0;
+            for (
+                uint k = 0, split = pools->next_split(alloc_params.split_start);
+                k < pools->num_splits && allocated < count;
+                k++, split = pools->next_split(split, alloc_params.split_step)
+            ) {
+                uint32 block = pools->allocate_from_list(region, split, alloc_params.attempts, cas_failures, ops);
+                if (block == region_chunk_pool_failed_alloc) {
+                    chunk_seen = true;
+                    continue;
+                }
+                if (block == region_chunk_pool_null_link) {
+                    continue;
+                }
+                allocated += take_block_chunks_(region, block, split, count - allocated, allocations + allocated, cas_failures);
+            }
+
+            uint32 split = pools->next_split(alloc_params.split_start);
+            while (allocated < count && !chunk_seen) {
+                uint32 block = acquire_block_(region, split, alloc_params.attempts, chunk_seen, cas_failures);
+                if (block == region_chunk_pool_null_link) {
+                    break;
+                }
+                allocated += take_block_chunks_(region, block, split, count - allocated, allocations + allocated, cas_failures);
+            }
+            return allocated;
+        }
+
+        // chunks must be of the same block, block is merged right away if it was not listed and got fully free
+        void release_block_chunks_(uint32 region, uint32 block, uint64 chunks) {
+            uint64 full_mask = block_full_mask_(region);
+            auto free_chunks_ref = std::atomic_ref{blocks[block].free_chunks};
+            auto free_chunks_old = free_chunks_ref.load(std::memory_order_relaxed);
+            uint64 free_chunks_new{};
+            RegionChunkAllocatorBackoff backoff{};
+            while (true) {
+                CUW3_CHECK(!(free_chunks_old & chunks), "chunk is already free");
+
+                uint64 free_chunks = (free_chunks_old & ~region_chunk_block_listed) | chunks;
+                bool listed = free_chunks_old & region_chunk_block_listed;
+                free_chunks_new = listed || free_chunks != full_mask ? free_chunks | region_chunk_block_listed : 0;
+                if (free_chunks_ref.compare_exchange_weak(free_chunks_old, free_chunks_new, std::memory_order_release, std::memory_order_relaxed)) {
+                    break;
+                }
+                backoff();
+            }
+
+            if (free_chunks_old & region_chunk_block_listed) {
+                return;
+            }
+            auto ops = RegionAllocatorBlockOps{this};
+            if (!free_chunks_new) {
+                pools->deallocate_block(block, ops);
+                return;
+            }
+            pools->deallocate(block, region, std::atomic_ref{blocks[block].split}.load(std::memory_order_relaxed), ops);
+        }
+
+        // pools are taken whole (single cas each), fully free blocks go to the block pool, the rest go back as a single chain
+        // contended pools are skipped, returns true if any block was merged
+        bool merge_free_blocks_() {
+            auto ops = RegionAllocatorBlockOps{this};
+            bool merged = false;
+            for (uint32 region = 0; region < specs->num_regions; region++) {
+                if (specs->region_specs[region].is_empty() || block_chunks_log2_(region) == 0) {
+                    continue; // single chunk blocks are merged right away
+                }
+
+                uint64 full_mask = block_full_mask_(region) | region_chunk_block_listed;
+                for (uint32 split = 0; split < pools->num_splits; split++) {
+                    uint32 count = 0;
+                    uint32 cas_failures = 0;
+                    uint32 block = pools->allocate_chain_from_list(region, split, specs->num_blocks, count, 1, cas_failures, ops);
+                    if (block >= specs->num_blocks) {
+                        continue;
+                    }
+
+                    uint32 first = region_chunk_pool_null_link;
+                    uint32 last = region_chunk_pool_null_link;
+                    for (uint32 i = 0; i < count; i++) {
+                        uint32 next = i + 1 < count ? ops.get_next(block) : region_chunk_pool_null_link;
+                        uint64 expected = full_mask;
+                        if (std::atomic_ref{blocks[block].free_chunks}.compare_exchange_strong(expected, 0, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                            pools->deallocate_block(block, ops);
+                            merged = true;
+                        } else {
+                            if (first == region_chunk_pool_null_link) {
+                                first = block;
+                            } else {
+                                ops.set_next(last, block);
+                            }
+                            last = block;
+                        }
+                        block = next;
+                    }
+                    if (first != region_chunk_pool_null_link) {
+                        pools->deallocate_chain(first, last, region, split, ops);
+                    }
+                }
+            }
+            return merged;
+        }
+
+        void release_chunk_(RegionChunkAllocation allocation) {
+            if (specs->unified) {
+                uint64 block_chunks_log2 = block_chunks_log2_(allocation.region);
+                release_block_chunks_(allocation.region, divpow2(allocation.chunk, block_chunks_log2), intpow2(modpow2(allocation.chunk, block_chunks_log2)));
+                return;
+            }
+            pools->deallocate(allocation.handle, allocation.region, allocation.split, RegionAllocatorPoolHandleOps{this});
+        }
+
+        void report_cas_failures_(const RegionChunkAllocParams& alloc_params, uint32 cas_failures) {
+            if (alloc_params.cas_failures) {
+                *alloc_params.cas_failures += cas_failures;
+            }
+        }
+
+        // chunks whose segment could not be reserved go back to the pool, the rest are compacted
+        [[nodiscard]] uint32 reserve_chunk_segments_(RegionChunkAllocation* allocations, uint32 count) {
+            uint32 reserved = 0;
+            for (uint32 i = 0; i < count; i++) {
+                auto allocation = allocations[i];
+                if (!reserve_segment_(allocation.region, allocation.chunk)) {
+                    release_chunk_(allocation);
+                    continue;
+                }
+                CUW3_UNPOISON_MEMORY_REGION(handle_from_index(allocation.handle), specs->handle_size);
+                allocations[reserved++] = allocation;
+            }
+            return reserved;
+        }
         
         
         // API
@@ -558,10 +1120,45 @@ namespace cuw3 {
         }
 
         bool belongs_any_region(void* ptr) const {
-            auto ptr_int = (uintptr)ptr;
-            auto regions_int = (uintptr)regions;
-            auto regions_end_int = (uintptr)advance_ptr(regions, specs->total_regions_size);
-            return regions_int <= ptr_int && ptr_int < regions_end_int;
+            return ptr_to_offset(ptr) != region_chunk_allocator_null_offset;
+        }
+
+        // logical offset of the ptr within the regions layout, null offset if ptr belongs to no region
+        [[nodiscard]] uint64 ptr_to_offset(void* ptr) const {
+            if (!specs->segment_size_log2) {
+                auto ptr_int = (uintptr)ptr;
+                auto regions_int = (uintptr)regions;
+                auto regions_end_int = (uintptr)advance_ptr(regions, specs->total_regions_size);
+                if (regions_int <= ptr_int && ptr_int < regions_end_int) {
+                    return ptr_int - regions_int;
+                }
+                return region_chunk_allocator_null_offset;
+            }
+
+            uint64 slot = divpow2((uintptr)ptr, specs->segment_size_log2);
+            if (slot >= specs->num_segment_slots) {
+                return region_chunk_allocator_null_offset;
+            }
+            uint32 segment = std::atomic_ref{segment_map[slot]}.load(std::memory_order_relaxed);
+            if (!segment) {
+                return region_chunk_allocator_null_offset;
+            }
+            return mulpow2((uint64)segment - 1, specs->segment_size_log2) | modpow2((uintptr)ptr, specs->segment_size_log2);
+        }
+
+        // offset must point into a reserved segment
+        [[nodiscard]] void* offset_to_ptr(uint64 offset) const {
+            if (!specs->segment_size_log2) {
+                return advance_ptr(regions, offset);
+            }
+
+            void* segment_memory = std::atomic_ref{segments[divpow2(offset, specs->segment_size_log2)]}.load(std::memory_order_acquire);
+            CUW3_CHECK(segment_memory, "segment is not reserved");
+            return advance_ptr(segment_memory, modpow2(offset, specs->segment_size_log2));
+        }
+
+        uint64 get_min_chunk_size() const {
+            return specs->region_specs[0].get_chunk_size();
         }
 
         uint64 get_max_chunk_size() const {
@@ -600,7 +1197,7 @@ namespace cuw3 {
 
         [[nodiscard]] RegionChunkMemory region_data_to_memory_no_check(uint32 region, uint32 chunk, uint32 handle) {
             auto& region_specs = specs->region_specs[region];
-            void* chunk_mem = region_specs.get_chunk(regions, chunk);
+            void* chunk_mem = offset_to_ptr(region_specs.get_relchunk(chunk));
             void* handle_mem = specs->get_handle(handles, handle);
             return {chunk_mem, region_specs.get_chunk_size(), handle_mem, specs->handle_size};
         }
@@ -622,10 +1219,15 @@ namespace cuw3 {
         }
 
         [[nodiscard]] RegionChunkLocation ptr_to_location(void* ptr) {
-            if (!belongs_any_region(ptr)) {
+            uint64 offset = ptr_to_offset(ptr);
+            if (offset == region_chunk_allocator_null_offset) {
                 return {region_chunk_allocator_null_value};
             }
-            return specs->locate_chunk(subptr(ptr, regions));
+            if (specs->unified) {
+                uint32 block = divpow2(offset, specs->block_size_log2);
+                return specs->locate_region_chunk(offset, std::atomic_ref{blocks[block].region}.load(std::memory_order_relaxed));
+            }
+            return specs->locate_chunk(offset);
         }
 
         [[nodiscard]] RegionChunkAllocation ptr_to_allocation(void* ptr) {
@@ -634,12 +1236,21 @@ namespace cuw3 {
                 return {region_chunk_allocator_null_value};
             }
 
-            uint32 split = pools->search_pool_split(location.region, location.handle);
+            uint32 split = search_pool_split_(location.region, location.handle);
             CUW3_CHECK(split != region_chunk_allocator_null_value, "invalid split value");
 
             return {location.region, location.chunk, location.handle, split};
         }
 
+        [[nodiscard]] RegionChunkAllocation handle_to_allocation(uint32 region, uint32 handle) {
+            CUW3_CHECK(region < specs->num_regions, "invalid region value");
+
+            uint32 split = search_pool_split_(region, handle);
+            CUW3_CHECK(split != region_chunk_allocator_null_value, "invalid split value");
+
+            return {region, region_handle_to_chunk_(region, handle), handle, split};
+        }
+
         [[nodiscard]] RegionChunkAllocation allocate_chunk(uint32 region, RegionChunkAllocParams alloc_params) {
             if (region >= specs->num_regions) {
                 return {region_chunk_allocator_null_value};
@@ -649,10 +1260,16 @@ namespace cuw3 {
             // result retries without consuming a round, since a chunk may reappear once
             // contention clears. Termination relies on op_failed being transient; backoff()
             // throttles. Don't decrement on failed - it would fake an OOM under contention.
+            uint32 cas_failures = 0;
             RegionChunkAllocatorBackoff backoff{};
             for (int rounds = alloc_params.rounds; rounds != 0; ) {
-                auto allocation = allocate_chunk_(region, alloc_params);
+                auto allocation = allocate_chunk_(region, alloc_params, cas_failures);
                 if (allocation) {
+                    report_cas_failures_(alloc_params, cas_failures);
+                    if (!reserve_segment_(allocation.region, allocation.chunk)) {
+                        release_chunk_(allocation);
+                        return {region_chunk_allocator_null_value};
+                    }
                     CUW3_UNPOISON_MEMORY_REGION(handle_from_index(allocation.handle), specs->handle_size);
                     return allocation;
                 }
@@ -661,6 +1278,7 @@ namespace cuw3 {
                 }
                 backoff();
             }
+            report_cas_failures_(alloc_params, cas_failures);
             return {region_chunk_allocator_null_value};
         }
 
@@ -673,7 +1291,7 @@ namespace cuw3 {
             CUW3_CHECK(region_specs.check_handle(location.handle), "invalid handle value");
 
             CUW3_POISON_MEMORY_REGION(handle_from_index(location.handle), specs->handle_size);
-            pools->deallocate(location.handle, location.region, location.split, RegionAllocatorPoolHandleOps{this});
+            release_chunk_(location);
         }
 
         void deallocate_chunk(void* chunk) {
@@ -682,15 +1300,96 @@ namespace cuw3 {
             deallocate_chunk(allocation);
         }
 
-        // NOTE : if I wanted to implement deallocate_chunk_chain function I can remember that
-        // next pointer is a function from handle memory location:
-        // next = some_fancy_functor(handle)
-        // void deallocate_chunk_chain(...) {}
+        // allocates up to count chunks of the region at once, returns number of chunks written to allocations
+        // zero means that region is exhausted, rounds and attempts have the same meaning as in allocate_chunk()
+        [[nodiscard]] uint32 allocate_chunks(uint32 region, uint32 count, RegionChunkAllocParams alloc_params, RegionChunkAllocation* allocations) {
+            if (region >= specs->num_regions || count == 0) {
+                return 0;
+            }
+
+            uint32 cas_failures = 0;
+            RegionChunkAllocatorBackoff backoff{};
+            for (int rounds = alloc_params.rounds; rounds != 0; ) {
+                bool chunk_seen = false;
+                if (uint32 allocated = allocate_chunks_(region, count, alloc_params, allocations, chunk_seen, cas_failures)) {
+                    report_cas_failures_(alloc_params, cas_failures);
+                    return reserve_chunk_segments_(allocations, allocated);
+                }
+                if (!chunk_seen) {
+                    rounds -= rounds > 0;
+                }
+                backoff();
+            }
+            report_cas_failures_(alloc_params, cas_failures);
+            return 0;
+        }
+
+        // consecutive chunks of the same pool are linked through the pool handles and go back with a single cas
+        // unified regions: consecutive chunks of the same block go back with a single cas
+        void deallocate_chunk_chain(const RegionChunkAllocation* allocations, uint32 count) {
+            if (specs->unified) {
+                deallocate_block_chunk_chain_(allocations, count);
+                return;
+            }
+
+            auto ops = RegionAllocatorPoolHandleOps{this};
+            uint32 first = 0;
+            for (uint32 i = 0; i < count; i++) {
+                auto allocation = allocations[i];
+                CUW3_CHECK(allocation.region < specs->num_regions, "invalid region value");
+                CUW3_CHECK(allocation.split < pools->num_splits, "invalid split value");
+                CUW3_CHECK(specs->region_specs[allocation.region].check_handle(allocation.handle), "invalid handle value");
+
+                CUW3_POISON_MEMORY_REGION(handle_from_index(allocation.handle), specs->handle_size);
+                if (i + 1 < count && allocations[i + 1].region == allocation.region && allocations[i + 1].split == allocation.split) {
+                    ops.set_next(allocation.handle, allocations[i + 1].handle);
+                    continue;
+                }
+                pools->deallocate_chain(allocations[first].handle, allocation.handle, allocation.region, allocation.split, ops);
+                first = i + 1;
+            }
+        }
+
+        void deallocate_block_chunk_chain_(const RegionChunkAllocation* allocations, uint32 count) {
+            uint64 chunks = 0;
+            for (uint32 i = 0; i < count; i++) {
+                auto allocation = allocations[i];
+                CUW3_CHECK(allocation.region < specs->num_regions, "invalid region value");
+                CUW3_CHECK(specs->region_specs[allocation.region].check_handle(allocation.handle), "invalid handle value");
+
+                CUW3_POISON_MEMORY_REGION(handle_from_index(allocation.handle), specs->handle_size);
+                uint64 block_chunks_log2 = block_chunks_log2_(allocation.region);
+                uint32 block = divpow2(allocation.chunk, block_chunks_log2);
+                chunks |= intpow2(modpow2(allocation.chunk, block_chunks_log2));
+                if (i + 1 < count && allocations[i + 1].region == allocation.region && chunk_block_(allocation.region, allocations[i + 1].chunk) == block) {
+                    continue;
+                }
+                release_block_chunks_(allocation.region, block, chunks);
+                chunks = 0;
+            }
+        }
+
+        uint32 num_pool_splits() const {
+            return pools->num_splits;
+        }
+
+        // step must be odd so every split is visited
+        uint32 next_pool_split(uint32 split, uint32 step) {
+            return pools->next_split(split, step);
+        }
+
+        uint64 pool_cas_failures(uint32 region, uint32 split) {
+            return pools->cas_failures(region, split);
+        }
 
         const RegionChunkAllocatorSpecs* specs{};
         RegionChunkAllocatorPools* pools{};
         void* regions{};
         void* handles{};
         void* pool_handles{};
+        RegionChunkBlock* blocks{}; // unified regions only
+        void** segments{}; // atomic
+        uint32* segment_map{}; // atomic, logical segment + 1, zero if slot is not used by any segment
+        VMemAllocType segment_alloc_type{}; // readonly
     };
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "conf.hpp"
+#include "funcs.hpp"
+#include "utils.hpp"
+#include "atomic.hpp"
+#include "assert.hpp"
+#include "region_chunk_allocator.hpp"
+
+namespace cuw3 {
+    inline constexpr uint64 region_chunk_cache_no_decay = ~(uint64)0;
+
+    // global cache of committed region chunks, sits between thread-local allocators and region chunk allocator
+    // * chunk released by some thread can be picked up by any other thread without decommit/commit round trip
+    // * each region has several shards (atomic versioned lists) to split contention
+    // * cached chunk is still allocated from the region chunk allocator point of view
+    //   so we reuse its pool handle slot to store the cache link
+    // * total size of cached chunks is bounded by budget, amount of chunks per region is bounded by high watermark
+    // * trim() pops chunks above the low watermark, caller decommits and returns them to the region chunk allocator
+    // * idle regions decay: the longer region sees no put/get the less chunks it may keep (see update_decay_watermark())
+    //
+    // decay is driven by the purger: put/get only raise activity flag, purger samples it along with its own timestamp
+    // so hot path never reads the clock, decay resolution is the purge period then
+    //
+    // counters are only hints to keep cache bounded: they are reserved before push and released after pop
+    // so cache can briefly appear a little bit fuller than it is
+    struct RegionChunkCacheConfig {
+        uint64 budget{}; // in bytes, zero disables cache
+        uint64 num_shards{}; // pow of 2, zero is treated as one
+        uint64 high_watermarks[conf_max_region_sizes] = {}; // max chunks of the region in the cache
+        uint64 low_watermarks[conf_max_region_sizes] = {}; // chunks of the region we keep on trim
+        uint64 decay_ms = region_chunk_cache_no_decay; // idle region is purged completely after this time, zero purges immediately
+    };
+
+    struct alignas(conf_cacheline) RegionChunkCacheShard {
+        RegionChunkPoolListHead free_list{}; // atomic
+    };
+
+    struct alignas(conf_cacheline) RegionChunkCacheCounter {
+        uint64 count{}; // atomic
+        uint64 active{}; // atomic, raised on put/get, dropped by the purger
+    };
+
+    struct RegionChunkCache {
+        using HandleOps = RegionChunkAllocator::RegionAllocatorPoolHandleOps;
+
+        [[nodiscard]] static RegionChunkCache* create(Memory memory, const RegionChunkCacheConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<RegionChunkCache>(), nullptr, "invalid memory");
+            CUW3_CHECK_RETURN_VAL(config.num_shards <= conf_max_contention_split, nullptr, "too many shards");
+            CUW3_CHECK_RETURN_VAL(!config.num_shards || is_pow2(config.num_shards), nullptr, "num of shards must be power of two");
+            for (uint32 region = 0; region < conf_max_region_sizes; region++) {
+                CUW3_CHECK_RETURN_VAL(config.low_watermarks[region] <= config.high_watermarks[region], nullptr, "low watermark is greater than high one");
+            }
+
+            auto* cache = new (memory.get()) RegionChunkCache{};
+            cache->budget = config.budget;
+            cache->num_shards = config.num_shards ? config.num_shards : 1;
+            cache->decay_ms = config.decay_ms;
+            for (uint32 region = 0; region < conf_max_region_sizes; region++) {
+                cache->high_watermarks[region] = config.high_watermarks[region];
+                cache->low_watermarks[region] = config.low_watermarks[region];
+                for (auto& shard : cache->shards[region]) {
+                    shard.free_list = {0, region_chunk_pool_null_link};
+                }
+            }
+            return cache;
+        }
+
+
+        // chunk must be committed
+        // returns false if cache is full, chunk stays with the caller then
+        [[nodiscard]] bool put(RegionChunkAllocator& rca, RegionChunkAllocation chunk_allocation, uint32 shard_hint) {
+            CUW3_CHECK(chunk_allocation, "invalid chunk allocation");
+
+            uint32 region = chunk_allocation.region;
+            if (region >= conf_max_region_sizes || !high_watermarks[region]) {
+                return false;
+            }
+
+            uint64 chunk_size = rca.get_region_spec(region).get_chunk_size();
+            if (!reserve_(region, chunk_size)) {
+                return false;
+            }
+
+            auto list_view = RegionChunkPoolListView{&shards[region][shard_hint & (num_shards - 1)].free_list};
+            list_view.push(chunk_allocation.handle, RegionChunkAllocatorBackoff{}, HandleOps{&rca});
+            mark_active_(region);
+            return true;
+        }
+
+        // returned chunk is committed
+        [[nodiscard]] RegionChunkAllocation get(RegionChunkAllocator& rca, uint32 region, uint32 shard_hint) {
+            if (region >= conf_max_region_sizes || !high_watermarks[region]) {
+                return null_region_chunk_allocation;
+            }
+            mark_active_(region);
+            return pop_(rca, region, shard_hint);
+        }
+
+        // pops one chunk if region holds more than watermark chunks, does not count as region activity
+        [[nodiscard]] RegionChunkAllocation trim(RegionChunkAllocator& rca, uint32 region, uint64 watermark, uint32 shard_hint = 0) {
+            if (region >= conf_max_region_sizes) {
+                return null_region_chunk_allocation;
+            }
+            if (std::atomic_ref{region_counts[region].count}.load(std::memory_order_relaxed) <= watermark) {
+                return null_region_chunk_allocation;
+            }
+            return pop_(rca, region, shard_hint);
+        }
+
+        // samples region activity at the moment now (in ms, any monotonic clock) and returns amount of chunks region may keep
+        // * active region keeps up to high watermark and restarts its idle period
+        // * idle region limit decays linearly from high watermark down to zero over decay_ms
+        // meant to be called by the purger only, concurrent purgers are fine but will shorten idle periods a bit
+        [[nodiscard]] uint64 update_decay_watermark(uint32 region, uint64 now) {
+            CUW3_CHECK(region < conf_max_region_sizes, "invalid region");
+
+            uint64 high_watermark = high_watermarks[region];
+            if (decay_ms == region_chunk_cache_no_decay) {
+                return high_watermark;
+            }
+            if (decay_ms == 0) {
+                return 0;
+            }
+
+            auto idle_since_ref = std::atomic_ref{idle_since[region]};
+            if (std::atomic_ref{region_counts[region].active}.exchange(0, std::memory_order_relaxed)) {
+                idle_since_ref.store(now, std::memory_order_relaxed);
+                return high_watermark;
+            }
+
+            uint64 idle_start = idle_since_ref.load(std::memory_order_relaxed);
+            uint64 elapsed = now > idle_start ? now - idle_start : 0;
+            if (elapsed >= decay_ms) {
+                return 0;
+            }
+            return (high_watermark * (decay_ms - elapsed) + decay_ms - 1) / decay_ms; // rounded up: last chunk lives for the whole period
+        }
+
+        uint64 get_low_watermark(uint32 region) const {
+            CUW3_CHECK(region < conf_max_region_sizes, "invalid region");
+            return low_watermarks[region];
+        }
+
+        uint64 get_cached_count(uint32 region) {
+            CUW3_CHECK(region < conf_max_region_sizes, "invalid region");
+            return std::atomic_ref{region_counts[region].count}.load(std::memory_order_relaxed);
+        }
+
+        uint64 get_cached_size() {
+            return std::atomic_ref{cached_size}.load(std::memory_order_relaxed);
+        }
+
+
+        [[nodiscard]] RegionChunkAllocation pop_(RegionChunkAllocator& rca, uint32 region, uint32 shard_hint) {
+            if (!std::atomic_ref{region_counts[region].count}.load(std::memory_order_relaxed)) {
+                return null_region_chunk_allocation;
+            }
+
+            for (uint32 i = 0; i < num_shards; i++) {
+                uint32 shard = (shard_hint + i) & (num_shards - 1);
+                auto list_view = RegionChunkPoolListView{&shards[region][shard].free_list};
+                auto handle = list_view.pop(RegionChunkAllocatorBackoff{}, HandleOps{&rca});
+                if (handle == region_chunk_pool_null_link) {
+                    continue;
+                }
+                release_(region, rca.get_region_spec(region).get_chunk_size());
+                return rca.handle_to_allocation(region, handle);
+            }
+            return null_region_chunk_allocation;
+        }
+
+        void mark_active_(uint32 region) {
+            auto active_ref = std::atomic_ref{region_counts[region].active};
+            if (!active_ref.load(std::memory_order_relaxed)) {
+                active_ref.store(1, std::memory_order_relaxed);
+            }
+        }
+
+        bool reserve_(uint32 region, uint64 chunk_size) {
+            auto cached_size_ref = std::atomic_ref{cached_size};
+            if (cached_size_ref.fetch_add(chunk_size, std::memory_order_relaxed) + chunk_size > budget) {
+                cached_size_ref.fetch_sub(chunk_size, std::memory_order_relaxed);
+                return false;
+            }
+
+            auto count_ref = std::atomic_ref{region_counts[region].count};
+            if (count_ref.fetch_add(1, std::memory_order_relaxed) >= high_watermarks[region]) {
+                count_ref.fetch_sub(1, std::memory_order_relaxed);
+                cached_size_ref.fetch_sub(chunk_size, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        void release_(uint32 region, uint64 chunk_size) {
+            std::atomic_ref{region_counts[region].count}.fetch_sub(1, std::memory_order_relaxed);
+            std::atomic_ref{cached_size}.fetch_sub(chunk_size, std::memory_order_relaxed);
+        }
+
+
+        RegionChunkCacheShard shards[conf_max_region_sizes][conf_max_contention_split] = {};
+        RegionChunkCacheCounter region_counts[conf_max_region_sizes] = {};
+
+        alignas(conf_cacheline) uint64 cached_size{}; // atomic
+        alignas(conf_cacheline) uint64 idle_since[conf_max_region_sizes] = {}; // atomic, purger timestamps
+
+        alignas(conf_cacheline) uint64 budget{}; // readonly
+        uint64 num_shards{}; // readonly
+        uint64 decay_ms{}; // readonly
+        uint64 high_watermarks[conf_max_region_sizes] = {}; // readonly
+        uint64 low_watermarks[conf_max_region_sizes] = {}; // readonly
+    };
+}
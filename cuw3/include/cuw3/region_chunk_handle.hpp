@@ -100,5 +100,8 @@ namespace cuw3 {
     enum class RegionChunkType : uint32 {
         FastArenaStepSplitAllocator = 1,
         FastArenaSmallAllocator = 2,
+        SlabAllocator = 3,
+        SubChunkArenas = 4, // shared chunk, arenas carved from it carry their own headers
+        ScopedArena = 5, // chunk of a scoped arena, its memory is never freed one by one
     };
 }
\ No newline at end of file
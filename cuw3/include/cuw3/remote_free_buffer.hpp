@@ -0,0 +1,126 @@
+#pragma once
+
+#include "conf.hpp"
+#include "utils.hpp"
+#include "assert.hpp"
+
+namespace cuw3 {
+    // remote free buffer: frees of memory owned by other threads are batched here per target chunk
+    // * arena batch accumulates aligned size only, it is published with a single retire of the total size
+    // * slab batch chains freed blocks (next pointer is stored within the block), chain is published with a single push
+    // * batch is published when it is full, when its slot is required for another chunk or on flush
+    // publishing is done by the allocator, buffer knows nothing about chunk types
+    //
+    // pending frees keep target chunk alive: owner cannot release chunk with unreclaimed memory
+    // so buffer must be flushed before thread dies
+    struct RemoteFreeBatch {
+        explicit operator bool() const {
+            return handle;
+        }
+
+        void* handle{}; // target chunk handle, null if slot is free
+        void* head{};
+        void* tail{};
+        uint64 size{};
+        uint64 count{};
+    };
+
+    struct RemoteFreeBufferConfig {
+        uint64 num_batches{}; // zero disables buffering
+        uint64 batch_capacity{}; // frees per batch
+    };
+
+    struct RemoteFreeBuffer {
+        [[nodiscard]] static RemoteFreeBuffer* create(Memory memory, const RemoteFreeBufferConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<RemoteFreeBuffer>(), nullptr, "invalid memory");
+            CUW3_CHECK_RETURN_VAL(config.num_batches <= conf_remote_free_max_batches, nullptr, "too many batches");
+            CUW3_CHECK_RETURN_VAL(!config.num_batches || config.batch_capacity, nullptr, "batch capacity must be positive");
+
+            auto* buffer = new (memory.get()) RemoteFreeBuffer{};
+            buffer->num_batches = config.num_batches;
+            buffer->batch_capacity = config.batch_capacity;
+            return buffer;
+        }
+
+
+        bool enabled() const {
+            return num_batches != 0;
+        }
+
+        // returns batch of the handle, assigns a free slot if handle has none yet
+        // returns nullptr if every slot is taken by other handles
+        [[nodiscard]] RemoteFreeBatch* find(void* handle) {
+            CUW3_CHECK(handle, "handle was null");
+
+            if (batches[last_found].handle == handle) {
+                return &batches[last_found];
+            }
+
+            RemoteFreeBatch* free_batch{};
+            for (uint64 i = 0; i < num_batches; i++) {
+                if (batches[i].handle == handle) {
+                    last_found = i;
+                    return &batches[i];
+                }
+                if (!batches[i].handle && !free_batch) {
+                    free_batch = &batches[i];
+                }
+            }
+            if (free_batch) {
+                free_batch->handle = handle;
+                last_found = free_batch - batches;
+                used++;
+            }
+            return free_batch;
+        }
+
+        // round-robin, buffer must be full
+        [[nodiscard]] RemoteFreeBatch* victim() {
+            CUW3_CHECK(used == num_batches, "buffer is not full");
+
+            auto* batch = &batches[next_victim];
+            next_victim = (next_victim + 1) % num_batches;
+            return batch;
+        }
+
+        // block is chained only if it is not null
+        void push(RemoteFreeBatch* batch, void* block, uint64 size) {
+            CUW3_CHECK(batch && batch->handle, "invalid batch");
+            CUW3_CHECK(batch->count < batch_capacity, "batch is full");
+
+            if (block) {
+                *(void**)block = batch->head;
+                batch->head = block;
+                if (!batch->tail) {
+                    batch->tail = block;
+                }
+            }
+            batch->size += size;
+            batch->count++;
+        }
+
+        bool full(const RemoteFreeBatch* batch) const {
+            return batch->count >= batch_capacity;
+        }
+
+        // frees the slot, returns its contents
+        [[nodiscard]] RemoteFreeBatch detach(RemoteFreeBatch* batch) {
+            CUW3_CHECK(batch && batch->handle, "invalid batch");
+
+            used--;
+            return std::exchange(*batch, RemoteFreeBatch{});
+        }
+
+        bool empty() const {
+            return used == 0;
+        }
+
+
+        RemoteFreeBatch batches[conf_remote_free_max_batches] = {};
+        uint64 num_batches{};
+        uint64 batch_capacity{};
+        uint64 used{};
+        uint64 last_found{};
+        uint64 next_victim{};
+    };
+}
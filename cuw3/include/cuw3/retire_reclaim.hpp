@@ -210,6 +210,23 @@ namespace cuw3 {
             }
         }
 
+        // same as retire_ptr but retires the whole chain [first, last] at once, chain must be already linked
+        // resource_ops must contain only one op: void set_next(void* resource, void* head) {...}
+        template<class Backoff, class ResourceOps>
+        [[nodiscard]] RetireReclaimPtr retire_chain(void* first, void* last, Backoff&& backoff, ResourceOps&& resource_ops) {
+            auto resource_ref = std::atomic_ref{*resource};
+            auto resource_old = resource_ref.load(std::memory_order_relaxed);
+            while (true) {
+                auto resource_new = ptr_with_flags(first, resource_old.data(), RetireReclaimFlags::RetiredFlag);
+
+                resource_ops.set_next(last, resource_old.ptr());
+                if (resource_ref.compare_exchange_strong(resource_old, resource_new, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    return resource_old;
+                }
+                backoff();
+            }
+        }
+
         // special case when retired resource can be represented as just a number
         template<class Backoff>
         [[nodiscard]] RetireReclaimPtr retire_data(RetireReclaimRawPtr data, Backoff&& backoff) {
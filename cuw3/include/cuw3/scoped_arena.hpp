@@ -0,0 +1,151 @@
+#pragma once
+
+#include "conf.hpp"
+#include "funcs.hpp"
+#include "utils.hpp"
+#include "assert.hpp"
+#include "region_chunk_handle.hpp"
+#include "region_chunk_allocator.hpp"
+
+namespace cuw3 {
+    // scoped arena: monotonic memory for things that die all at once (request lifetime memory)
+    // * allocation is a pointer bump, nothing is freed one by one: arena is rewound to a mark or released as a whole
+    // * memory is a chain of whole committed region chunks, control block of the chunk handle links the chain
+    //   so the chunk memory is all usable, arena itself is placed at the beginning of the first chunk
+    // * mark is just the top, it is found by the chunk range it points into: rewind pops the newer chunks
+    // * marks are rewound in stack order: rewinding to a mark invalidates all marks taken after it
+    // * arena belongs to the thread that created it, its chunks are accounted to the thread local allocator
+    struct alignas(conf_cacheline) ScopedArenaChunk {
+        RegionChunkHandleHeader region_chunk_header{}; // owner + type, arena memory must never reach deallocate()
+        ScopedArenaChunk* prev{};
+        void* chunk_memory{};
+        uint64 chunk_memory_size{};
+        RegionChunkAllocation chunk_allocation{};
+    };
+
+    static_assert(sizeof(ScopedArenaChunk) <= conf_control_block_size, "pack struct field better or increase size of the control block");
+
+
+    struct ScopedArenaChunkConfig {
+        void* owner{};
+        RegionChunkMemory chunk_memory{};
+        RegionChunkAllocation chunk_allocation{};
+    };
+
+    struct ScopedArenaChunkView {
+        [[nodiscard]] static ScopedArenaChunk* create(Memory memory, const ScopedArenaChunkConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<ScopedArenaChunk>(conf_control_block_size, conf_cacheline), nullptr, "inappropriate memory");
+
+            CUW3_CHECK_RETURN_VAL(config.owner, nullptr, "owner was null");
+            CUW3_CHECK_RETURN_VAL(config.chunk_memory, nullptr, "chunk memory was null");
+            CUW3_CHECK_RETURN_VAL(config.chunk_allocation, nullptr, "chunk allocation was invalid");
+
+            auto* chunk = new (memory.get()) ScopedArenaChunk{};
+            chunk->region_chunk_header = RegionChunkHandleHeader::from(config.owner, (uint64)RegionChunkType::ScopedArena);
+            chunk->chunk_memory = config.chunk_memory.chunk;
+            chunk->chunk_memory_size = config.chunk_memory.chunk_size;
+            chunk->chunk_allocation = config.chunk_allocation;
+            return chunk;
+        }
+
+
+        void* begin() const {
+            return chunk->chunk_memory;
+        }
+
+        void* end() const {
+            return advance_ptr(chunk->chunk_memory, chunk->chunk_memory_size);
+        }
+
+        // end belongs to the chunk as well: it is the top of the full chunk
+        bool has_top(void* top) const {
+            return begin() <= top && top <= end();
+        }
+
+
+        ScopedArenaChunk* chunk{};
+    };
+
+
+    struct ScopedArena {
+        ScopedArenaChunk* chunk{}; // the newest one, chain goes back to the one holding the arena
+        void* top{};
+        void* end{};
+        void* owner{};
+    };
+
+    struct ScopedArenaView {
+        // arena takes the beginning of its first chunk
+        [[nodiscard]] static ScopedArena* create(ScopedArenaChunk* chunk) {
+            CUW3_CHECK_RETURN_VAL(chunk, nullptr, "chunk was null");
+            CUW3_CHECK_RETURN_VAL(chunk->chunk_memory_size >= sizeof(ScopedArena), nullptr, "chunk is too small");
+
+            CUW3_UNPOISON_MEMORY_REGION(chunk->chunk_memory, sizeof(ScopedArena));
+            auto* arena = new (chunk->chunk_memory) ScopedArena{};
+            arena->chunk = chunk;
+            arena->top = advance_ptr(chunk->chunk_memory, sizeof(ScopedArena));
+            arena->end = ScopedArenaChunkView{chunk}.end();
+            arena->owner = chunk->region_chunk_header.owner();
+            return arena;
+        }
+
+
+        // returns nullptr if the allocation does not fit into the current chunk, next one must be pushed then
+        [[nodiscard]] void* acquire(uint64 size, uint64 alignment) {
+            CUW3_CHECK(is_alignment(alignment), "invalid alignment");
+
+            void* mem = align(arena->top, alignment);
+            if (mem > arena->end || (uint64)subptr(arena->end, mem) < size) {
+                return nullptr;
+            }
+            arena->top = advance_ptr(mem, size);
+            CUW3_UNPOISON_MEMORY_REGION(mem, size);
+            return mem;
+        }
+
+        // rest of the current chunk is abandoned until the arena is rewound below the new one
+        void push_chunk(ScopedArenaChunk* chunk) {
+            CUW3_CHECK(chunk, "chunk was null");
+            CUW3_CHECK(chunk->region_chunk_header.owner() == arena->owner, "chunk has another owner");
+
+            chunk->prev = arena->chunk;
+            arena->chunk = chunk;
+            arena->top = ScopedArenaChunkView{chunk}.begin();
+            arena->end = ScopedArenaChunkView{chunk}.end();
+        }
+
+        void* mark() const {
+            return arena->top;
+        }
+
+        // pops the newest chunk if the mark is not inside of it, returns nullptr once the chunk of the mark is reached
+        // popped chunk must be released by the caller, call until nullptr is returned then set_top(mark)
+        [[nodiscard]] ScopedArenaChunk* pop_chunk_above(void* mark) {
+            auto* chunk = arena->chunk;
+            if (ScopedArenaChunkView{chunk}.has_top(mark)) {
+                return nullptr;
+            }
+            CUW3_CHECK(chunk->prev, "mark does not belong to the arena");
+
+            arena->chunk = chunk->prev;
+            arena->top = arena->end = ScopedArenaChunkView{arena->chunk}.end();
+            return chunk;
+        }
+
+        void set_top(void* mark) {
+            CUW3_CHECK(ScopedArenaChunkView{arena->chunk}.has_top(mark) && mark <= arena->top, "mark is above the top");
+            CUW3_CHECK(mark >= first_top_(), "mark is below the arena");
+
+            CUW3_POISON_MEMORY_REGION(mark, subptr(arena->top, mark));
+            arena->top = mark;
+        }
+
+        // memory of the first chunk still holds the arena
+        void* first_top_() const {
+            return arena->chunk->prev ? nullptr : advance_ptr((void*)arena, sizeof(ScopedArena));
+        }
+
+
+        ScopedArena* arena{};
+    };
+}
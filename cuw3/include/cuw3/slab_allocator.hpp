@@ -0,0 +1,555 @@
+#pragma once
+
+#include "conf.hpp"
+#include "list.hpp"
+#include "funcs.hpp"
+#include "utils.hpp"
+#include "bitmap.hpp"
+#include "assert.hpp"
+#include "backoff.hpp"
+#include "retire_reclaim.hpp"
+#include "region_chunk_handle.hpp"
+
+namespace cuw3 {
+    // slab allocator: segregated size classes for the smallest allocations
+    // * chunk is split into conf_slab_pages_per_chunk pages, each page serves exactly one size class
+    // * the first page of the chunk holds page descriptors so pointer -> page lookup is just a shift
+    // * freed blocks go into intrusive page free list: no bump fragmentation, blocks are reused immediately
+    // * page is carved lazily: fresh page memory is not touched until a block is handed out
+    // * cross-thread frees: block is pushed into the chunk retire list (next pointer is stored inside the block),
+    //   chunk itself is retired into the allocator root, same scheme as fast arenas use
+    using SlabListEntry = DefaultListEntry;
+    using SlabListOps = DefaultListOps<SlabListEntry>;
+
+    using SlabBackoff = SimpleBackoff;
+
+    inline constexpr uint64 slab_linear_size_classes = conf_slab_linear_size / conf_min_alloc_size;
+    inline constexpr uint64 slab_null_size_class = conf_slab_num_size_classes;
+
+    constexpr uint64 slab_size_class_to_size(uint64 size_class) {
+        if (size_class < slab_linear_size_classes) {
+            return (size_class + 1) * conf_min_alloc_size;
+        }
+        uint64 rel_class = size_class - slab_linear_size_classes;
+        uint64 group = rel_class >> conf_slab_classes_per_pow2_log2;
+        uint64 step_id = rel_class & (conf_slab_classes_per_pow2 - 1);
+        uint64 group_base = conf_slab_linear_size << group;
+        uint64 group_step = group_base >> conf_slab_classes_per_pow2_log2;
+        return group_base + (step_id + 1) * group_step;
+    }
+
+    // size must be in range [1, conf_slab_max_size]
+    constexpr uint64 slab_size_to_size_class(uint64 size) {
+        if (size <= conf_slab_linear_size) {
+            return (size - 1) >> conf_min_alloc_alignment_log2;
+        }
+        uint64 size_log2 = intlog2(size - 1);
+        uint64 group = size_log2 - intlog2(conf_slab_linear_size);
+        uint64 step_id = (size - 1 - intpow2(size_log2)) >> (size_log2 - conf_slab_classes_per_pow2_log2);
+        return slab_linear_size_classes + (group << conf_slab_classes_per_pow2_log2) + step_id;
+    }
+
+    constexpr bool slab_size_classes_valid() {
+        for (uint64 size = 1; size <= conf_slab_max_size; size++) {
+            uint64 size_class = slab_size_to_size_class(size);
+            if (size_class >= conf_slab_num_size_classes) {
+                return false;
+            }
+            if (slab_size_class_to_size(size_class) < size) {
+                return false;
+            }
+            if (size_class > 0 && slab_size_class_to_size(size_class - 1) >= size) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(slab_size_class_to_size(conf_slab_num_size_classes - 1) == conf_slab_max_size);
+    static_assert(slab_size_classes_valid());
+
+
+    struct SlabPage {
+        static SlabPage* list_entry_to_page(SlabListEntry* list_entry) {
+            return cuw3_field_to_obj(list_entry, SlabPage, list_entry);
+        }
+
+        SlabListEntry list_entry{};
+        void* free_list{}; // intrusive list of freed blocks
+        void* page_memory{};
+        uint32 block_size{};
+        uint32 size_class{};
+        uint32 capacity{};
+        uint32 used{};
+        uint32 carved{}; // blocks [0, carved) were handed out at least once
+    };
+
+    struct SlabPageView {
+        void init(uint64 size_class, uint64 page_size) {
+            page->block_size = slab_size_class_to_size(size_class);
+            page->size_class = size_class;
+            page->capacity = page_size / page->block_size;
+            page->used = 0;
+            page->carved = 0;
+            page->free_list = nullptr;
+        }
+
+        [[nodiscard]] void* acquire() {
+            CUW3_CHECK(!full(), "page is full");
+
+            void* block{};
+            if (page->free_list) {
+                block = page->free_list;
+                page->free_list = *(void**)block;
+            } else {
+                block = advance_ptr(page->page_memory, (uint64)page->carved * page->block_size);
+                page->carved++;
+            }
+            page->used++;
+
+            CUW3_UNPOISON_MEMORY_REGION(block, page->block_size);
+            return block;
+        }
+
+        void release(void* block) {
+            CUW3_CHECK(page->used > 0, "page is empty");
+            CUW3_CHECK(has_block(block), "block does not belong to the page");
+
+            *(void**)block = page->free_list;
+            page->free_list = block;
+            page->used--;
+        }
+
+        bool has_block(void* block) const {
+            auto offset = subptr(block, page->page_memory);
+            return 0 <= offset && offset < (ptrdiff)page->carved * page->block_size && offset % page->block_size == 0;
+        }
+
+        bool full() const {
+            return !page->free_list && page->carved == page->capacity;
+        }
+
+        bool empty() const {
+            return page->used == 0;
+        }
+
+        SlabPage* page{};
+    };
+
+
+    using SlabPageBitmap = Bitmap<uint64, conf_slab_pages_per_chunk>;
+
+    struct alignas(conf_cacheline) SlabChunk {
+        static SlabChunk* list_entry_to_chunk(SlabListEntry* list_entry) {
+            return cuw3_field_to_obj(list_entry, SlabChunk, list_entry);
+        }
+
+        CUW3_NEW_CACHELINE // least volatile data
+        RegionChunkHandleHeader region_chunk_header{}; // does not change until chunk dies
+        RetireReclaimEntry retire_reclaim_entry{}; // blocks retired by non-owning threads
+        uint64 page_size_log2{};
+
+        CUW3_NEW_CACHELINE // most volatile data
+        SlabListEntry list_entry{}; // chunk is in the list as long as it has unused pages
+        SlabPageBitmap used_pages{}; // page 0 is always used: it stores page descriptors
+        SlabPage* pages{};
+        void* chunk_memory{};
+        uint64 chunk_memory_size{};
+    };
+
+    static_assert(sizeof(SlabChunk) <= conf_control_block_size, "pack struct field better or increase size of the control block");
+    static_assert(conf_slab_pages_per_chunk * sizeof(SlabPage) <= conf_slab_min_page_size, "page descriptors do not fit into the first page");
+
+
+    struct SlabChunkConfig {
+        void* owner{};
+
+        void* chunk_memory{};
+        uint64 chunk_memory_size{};
+
+        RetireReclaimRawPtr retire_reclaim_flags{};
+    };
+
+    struct SlabBlockRetireReclaimResourceOps {
+        void set_next(void* block, void* retired_block_list) {
+            *(void**)block = retired_block_list;
+        }
+    };
+
+    struct SlabChunkView {
+        [[nodiscard]] static SlabChunk* create(Memory memory, const SlabChunkConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<SlabChunk>(conf_control_block_size, conf_cacheline), nullptr, "inappropriate memory");
+
+            CUW3_CHECK_RETURN_VAL(config.owner, nullptr, "owner was null");
+            CUW3_CHECK_RETURN_VAL(config.chunk_memory, nullptr, "chunk memory was null");
+            CUW3_CHECK_RETURN_VAL(is_pow2(config.chunk_memory_size), nullptr, "chunk size must be power of two");
+
+            uint64 page_size_log2 = intlog2(config.chunk_memory_size) - conf_slab_pages_per_chunk_log2;
+            CUW3_CHECK_RETURN_VAL(intpow2(page_size_log2) >= conf_slab_min_page_size, nullptr, "chunk is too small");
+            CUW3_CHECK_RETURN_VAL(is_aligned(config.chunk_memory, intpow2(page_size_log2)), nullptr, "chunk memory is not properly aligned");
+
+            auto* chunk = new (memory.get()) SlabChunk{};
+            chunk->region_chunk_header = RegionChunkHandleHeader::from(config.owner, (uint64)RegionChunkType::SlabAllocator);
+            chunk->page_size_log2 = page_size_log2;
+            chunk->chunk_memory = config.chunk_memory;
+            chunk->chunk_memory_size = config.chunk_memory_size;
+
+            auto* retire_reclaim_entry = RetireReclaimEntryView::create(
+                Memory::from(&chunk->retire_reclaim_entry),
+                config.retire_reclaim_flags,
+                (uint64)RegionChunkType::SlabAllocator,
+                offsetof(SlabChunk, retire_reclaim_entry)
+            );
+            CUW3_CHECK_RETURN_VAL(retire_reclaim_entry, nullptr, "slab_chunk: failed to create retire_reclaim_entry");
+
+            CUW3_UNPOISON_MEMORY_REGION(config.chunk_memory, conf_slab_pages_per_chunk * sizeof(SlabPage));
+
+            chunk->pages = (SlabPage*)config.chunk_memory;
+            for (uint64 i = 0; i < conf_slab_pages_per_chunk; i++) {
+                auto* page = new (&chunk->pages[i]) SlabPage{};
+                page->page_memory = advance_ptr(config.chunk_memory, i << page_size_log2);
+            }
+            chunk->used_pages.set(0);
+            return chunk;
+        }
+
+
+        // returns nullptr if all pages are used
+        [[nodiscard]] SlabPage* acquire_page(uint64 size_class) {
+            CUW3_CHECK(size_class < conf_slab_num_size_classes, "invalid size class");
+
+            auto page_id = chunk->used_pages.set_first_unset();
+            if (page_id == SlabPageBitmap::null_bit) {
+                return nullptr;
+            }
+            auto* page = &chunk->pages[page_id];
+            SlabPageView{page}.init(size_class, page_size());
+            return page;
+        }
+
+        void release_page(SlabPage* page) {
+            CUW3_CHECK(SlabPageView{page}.empty(), "page is still in use");
+
+            auto page_id = page - chunk->pages;
+            CUW3_CHECK(page_id > 0 && page_id < (ptrdiff)conf_slab_pages_per_chunk, "invalid page");
+            CUW3_CHECK(chunk->used_pages.get(page_id), "page was not used");
+
+            chunk->used_pages.unset(page_id);
+            CUW3_POISON_MEMORY_REGION(page->page_memory, page_size());
+        }
+
+        // can be called from any thread that legitimately holds the block: page stays alive as long as the block does
+        uint64 block_size(void* ptr) const {
+            auto offset = subptr(ptr, chunk->chunk_memory);
+            CUW3_CHECK(offset >= 0 && (uint64)offset < chunk->chunk_memory_size, "ptr does not belong to the chunk");
+
+            auto page_id = divpow2((uint64)offset, chunk->page_size_log2);
+            CUW3_CHECK(page_id > 0, "ptr points to page descriptors");
+            return chunk->pages[page_id].block_size;
+        }
+
+        [[nodiscard]] SlabPage* page_from_ptr(void* ptr) const {
+            auto offset = subptr(ptr, chunk->chunk_memory);
+            CUW3_CHECK(offset >= 0 && (uint64)offset < chunk->chunk_memory_size, "ptr does not belong to the chunk");
+
+            auto page_id = divpow2((uint64)offset, chunk->page_size_log2);
+            CUW3_CHECK(page_id > 0, "ptr points to page descriptors");
+            CUW3_CHECK(chunk->used_pages.get(page_id), "ptr points to unused page");
+            return &chunk->pages[page_id];
+        }
+
+        // called from the non-owning thread
+        [[nodiscard]] RetireReclaimPtr retire_block(void* block) {
+            auto retire_reclaim_entry_view = RetireReclaimPtrView{&chunk->retire_reclaim_entry.head};
+            return retire_reclaim_entry_view.retire_ptr(block, SlabBackoff{}, SlabBlockRetireReclaimResourceOps{});
+        }
+
+        [[nodiscard]] RetireReclaimPtr retire_blocks(void* first, void* last) {
+            auto retire_reclaim_entry_view = RetireReclaimPtrView{&chunk->retire_reclaim_entry.head};
+            return retire_reclaim_entry_view.retire_chain(first, last, SlabBackoff{}, SlabBlockRetireReclaimResourceOps{});
+        }
+
+        // slab chunk is a leaf resource so we always reclaim and reset
+        // returns list of retired blocks
+        [[nodiscard]] void* reclaim_blocks() {
+            auto retire_reclaim_entry_view = RetireReclaimPtrView{&chunk->retire_reclaim_entry.head};
+            return retire_reclaim_entry_view.reclaim_reset().ptr();
+        }
+
+        bool has_unused_pages() const {
+            return chunk->used_pages.count() < conf_slab_pages_per_chunk;
+        }
+
+        // only page descriptors are left
+        bool empty() const {
+            return chunk->used_pages.count() == 1;
+        }
+
+        uint64 page_size() const {
+            return intpow2(chunk->page_size_log2);
+        }
+
+        uint64 type() const {
+            return chunk->region_chunk_header.data();
+        }
+
+        void* owner() const {
+            return chunk->region_chunk_header.owner();
+        }
+
+
+        SlabChunk* chunk{};
+    };
+
+    struct SlabReclaimList {
+        [[nodiscard]] SlabChunk* pop() {
+            CUW3_ASSERT(head, "attempt to pop from empty list");
+
+            auto* chunk = head;
+            head = (SlabChunk*)std::exchange(head->retire_reclaim_entry.next, nullptr);
+            return chunk;
+        }
+
+        bool empty() const {
+            return !head;
+        }
+
+        explicit operator bool() const {
+            return !empty();
+        }
+
+        SlabChunk* head{};
+    };
+
+    struct alignas(conf_cacheline) SlabRetiredChunksRoot {
+        RetireReclaimEntry entry{};
+    };
+
+    struct SlabChunkRetireReclaimResourceOps {
+        void set_next(void* chunk, void* retired_chunk_list) {
+            ((SlabChunk*)chunk)->retire_reclaim_entry.next = retired_chunk_list;
+        }
+    };
+
+
+    struct SlabAllocatorConfig {
+        uint64 max_size{}; // zero disables slab allocator
+    };
+
+    // bins contain pages that have at least one free block
+    // free_chunks contains chunks that have at least one unused page
+    // full pages are not tracked: they return back into the bin once some block is freed
+    struct SlabAllocator {
+        [[nodiscard]] static SlabAllocator* create(Memory memory, const SlabAllocatorConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<SlabAllocator>(), nullptr, "invalid memory");
+            CUW3_CHECK_RETURN_VAL(config.max_size <= conf_slab_max_size, nullptr, "max size is too big");
+
+            auto* allocator = new (memory.get()) SlabAllocator{};
+            for (auto& bin : allocator->bins) {
+                list_init(&bin, SlabListOps{});
+            }
+            list_init(&allocator->free_chunks, SlabListOps{});
+            allocator->max_size = config.max_size;
+
+            // allocator is retired by default (locked)
+            auto* retire_reclaim_entry = RetireReclaimEntryView::create(
+                Memory::from(&allocator->retired_chunks.entry),
+                (uint64)RetireReclaimFlags::RetiredFlag
+            );
+            CUW3_CHECK_RETURN_VAL(retire_reclaim_entry, nullptr, "failed to initialize retire-reclaim entry");
+
+            return allocator;
+        }
+
+
+        uint64 get_max_size() const {
+            return max_size;
+        }
+
+        // picks the first size class that can hold size and keeps blocks aligned
+        // page memory is aligned to the page size so aligned block size is enough
+        uint64 locate_size_class(uint64 size, uint64 alignment) const {
+            if (size > max_size || alignment > max_size) {
+                return slab_null_size_class;
+            }
+            for (uint64 size_class = slab_size_to_size_class(std::max<uint64>(size, 1)); size_class < conf_slab_num_size_classes; size_class++) {
+                uint64 block_size = slab_size_class_to_size(size_class);
+                if (block_size > max_size) {
+                    break;
+                }
+                if (is_aligned(block_size, alignment)) {
+                    return size_class;
+                }
+            }
+            return slab_null_size_class;
+        }
+
+        bool can_allocate(uint64 size, uint64 alignment) const {
+            return locate_size_class(size, alignment) != slab_null_size_class;
+        }
+
+        // no_resource: new chunk must be added
+        [[nodiscard]] AcquiredResource allocate(uint64 size, uint64 alignment) {
+            auto size_class = locate_size_class(size, alignment);
+            if (size_class == slab_null_size_class) {
+                return AcquiredResource::failed();
+            }
+
+            auto* bin = &bins[size_class];
+            if (list_empty(bin, SlabListOps{})) {
+                auto* page = acquire_page_(size_class);
+                if (!page) {
+                    return AcquiredResource::no_resource();
+                }
+                list_push_head(bin, &page->list_entry, SlabListOps{});
+            }
+
+            auto* page = SlabPage::list_entry_to_page(list_next(bin, SlabListOps{}));
+            auto page_view = SlabPageView{page};
+            void* block = page_view.acquire();
+            if (page_view.full()) {
+                list_erase(&page->list_entry, SlabListOps{});
+            }
+            return AcquiredResource::acquired(block);
+        }
+
+        void add_chunk(SlabChunk* chunk) {
+            CUW3_CHECK(chunk, "chunk was null");
+            CUW3_CHECK(SlabChunkView{chunk}.type() == (uint64)RegionChunkType::SlabAllocator, "chunk has invalid type");
+
+            list_push_head(&free_chunks, &chunk->list_entry, SlabListOps{});
+            total_chunks++;
+        }
+
+        // returns chunk if it became empty, chunk is extracted from the data structure then
+        [[nodiscard]] SlabChunk* deallocate(SlabChunk* chunk, void* ptr, uint64 size) {
+            CUW3_CHECK(chunk, "chunk was null");
+            CUW3_CHECK(ptr, "ptr was null");
+
+            auto chunk_view = SlabChunkView{chunk};
+            CUW3_CHECK(chunk_view.type() == (uint64)RegionChunkType::SlabAllocator, "chunk has invalid type");
+
+            auto* page = chunk_view.page_from_ptr(ptr);
+            auto page_view = SlabPageView{page};
+            CUW3_CHECK(size <= page->block_size, "size does not match the size class");
+
+            bool was_full = page_view.full();
+            page_view.release(ptr);
+            if (!page_view.empty()) {
+                if (was_full) {
+                    list_push_head(&bins[page->size_class], &page->list_entry, SlabListOps{});
+                }
+                return nullptr;
+            }
+
+            if (!was_full) {
+                list_erase(&page->list_entry, SlabListOps{});
+            }
+            return release_page_(chunk, page);
+        }
+
+        // called from the non-owning thread
+        // retires block into the chunk and then chunk into the allocator if it was not retired yet
+        [[nodiscard]] RetireReclaimPtr retire(SlabChunk* chunk, void* ptr, uint64 size) {
+            CUW3_CHECK(chunk, "chunk was null");
+            CUW3_CHECK(ptr, "memory was null");
+
+            auto chunk_view = SlabChunkView{chunk};
+            CUW3_CHECK(chunk_view.type() == (uint64)RegionChunkType::SlabAllocator, "chunk does not belong to this allocator");
+            CUW3_CHECK(size <= chunk_view.page_from_ptr(ptr)->block_size, "size does not match the size class");
+
+            return retire_chunk_(chunk, chunk_view.retire_block(ptr));
+        }
+
+        // called from the non-owning thread
+        // retires chain of blocks [first, last] linked through the next pointer stored within the block
+        [[nodiscard]] RetireReclaimPtr retire_chain(SlabChunk* chunk, void* first, void* last) {
+            CUW3_CHECK(chunk, "chunk was null");
+            CUW3_CHECK(first && last, "chain was empty");
+
+            auto chunk_view = SlabChunkView{chunk};
+            CUW3_CHECK(chunk_view.type() == (uint64)RegionChunkType::SlabAllocator, "chunk does not belong to this allocator");
+
+            return retire_chunk_(chunk, chunk_view.retire_blocks(first, last));
+        }
+
+        [[nodiscard]] RetireReclaimPtr retire_chunk_(SlabChunk* chunk, RetireReclaimPtr retired) {
+            if (RetireReclaimFlagsHelper{retired}.retired()) {
+                return retired;
+            }
+
+            auto retire_reclaim_entry_view = RetireReclaimPtrView{&retired_chunks.entry.head};
+            return retire_reclaim_entry_view.retire_ptr(chunk, SlabBackoff{}, SlabChunkRetireReclaimResourceOps{});
+        }
+
+        // called by the owning thread
+        [[nodiscard]] SlabReclaimList reclaim_chunks() {
+            auto retired_chunks_view = RetireReclaimPtrView{&retired_chunks.entry.head};
+            return {retired_chunks_view.reclaim().ptr<SlabChunk>()};
+        }
+
+        // called by the owning thread
+        // returns chunk if it became empty
+        [[nodiscard]] SlabChunk* reclaim_chunk(SlabChunk* chunk) {
+            auto chunk_view = SlabChunkView{chunk};
+            CUW3_CHECK(chunk_view.type() == (uint64)RegionChunkType::SlabAllocator, "chunk does not belong to this allocator");
+
+            SlabChunk* released_chunk{};
+            void* block = chunk_view.reclaim_blocks();
+            while (block) {
+                CUW3_CHECK(!released_chunk, "chunk was released but some blocks are still left");
+
+                void* next = *(void**)block;
+                released_chunk = deallocate(chunk, block, 0);
+                block = next;
+            }
+            return released_chunk;
+        }
+
+        bool empty() const {
+            return total_chunks == 0;
+        }
+
+
+        [[nodiscard]] SlabPage* acquire_page_(uint64 size_class) {
+            while (!list_empty(&free_chunks, SlabListOps{})) {
+                auto* chunk = SlabChunk::list_entry_to_chunk(list_next(&free_chunks, SlabListOps{}));
+                auto chunk_view = SlabChunkView{chunk};
+                auto* page = chunk_view.acquire_page(size_class);
+                if (!chunk_view.has_unused_pages()) {
+                    list_erase(&chunk->list_entry, SlabListOps{});
+                }
+                if (page) {
+                    return page;
+                }
+            }
+            return nullptr;
+        }
+
+        [[nodiscard]] SlabChunk* release_page_(SlabChunk* chunk, SlabPage* page) {
+            auto chunk_view = SlabChunkView{chunk};
+            bool had_unused_pages = chunk_view.has_unused_pages();
+            chunk_view.release_page(page);
+            if (!chunk_view.empty()) {
+                if (!had_unused_pages) {
+                    list_push_head(&free_chunks, &chunk->list_entry, SlabListOps{});
+                }
+                return nullptr;
+            }
+
+            if (had_unused_pages) {
+                list_erase(&chunk->list_entry, SlabListOps{});
+            }
+            CUW3_CHECK(total_chunks > 0, "invariant violation: positive amount of chunks expected.");
+            total_chunks--;
+            return chunk;
+        }
+
+
+        SlabRetiredChunksRoot retired_chunks{};
+        SlabListEntry bins[conf_slab_num_size_classes] = {};
+        SlabListEntry free_chunks{};
+        uint64 max_size{};
+        uint64 total_chunks{};
+    };
+}
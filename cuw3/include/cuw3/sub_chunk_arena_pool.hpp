@@ -0,0 +1,245 @@
+#pragma once
+
+#include "conf.hpp"
+#include "funcs.hpp"
+#include "utils.hpp"
+#include "atomic.hpp"
+#include "assert.hpp"
+#include "backoff.hpp"
+#include "fast_arena.hpp"
+#include "region_chunk_handle.hpp"
+#include "region_chunk_allocator.hpp"
+
+namespace cuw3 {
+    using SubChunkArenaPoolBackoff = SimpleBackoff;
+
+    // sub-chunk arenas: one region chunk is carved into many small arenas so threads that allocate little
+    // do not pin a whole chunk each
+    // * chunk is split into slots of arena size, the first slot holds control blocks and free list links of all slots
+    //   so pointer -> arena lookup is just a shift (same trick slab chunk does with its pages)
+    // * every arena has its own owner, chunk itself has none: it is shared by all threads
+    // * free slots of all chunks are kept in one global atomic list, link = handle index * slots per chunk + slot
+    // * chunk is never given back to the region chunk allocator: its slots may still be referenced by the list
+    //   so the pool only grows up to the peak amount of sub-chunk arenas in use
+    struct alignas(conf_cacheline) SubChunkArenaChunk {
+        RegionChunkHandleHeader region_chunk_header{}; // no owner, only type
+        FastArena* arenas{}; // slot 0 has no arena, its control block is not used
+        RegionChunkPoolLinkType* links{}; // atomic
+        void* chunk_memory{};
+        uint64 chunk_memory_size{};
+        uint64 arena_size_log2{};
+    };
+
+    static_assert(sizeof(SubChunkArenaChunk) <= conf_control_block_size, "pack struct field better or increase size of the control block");
+
+
+    struct SubChunkArenaChunkConfig {
+        void* chunk_memory{};
+        uint64 chunk_memory_size{};
+        uint64 arena_size_log2{};
+    };
+
+    struct SubChunkArenaChunkView {
+        [[nodiscard]] static SubChunkArenaChunk* create(Memory memory, const SubChunkArenaChunkConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<SubChunkArenaChunk>(conf_control_block_size, conf_cacheline), nullptr, "inappropriate memory");
+
+            CUW3_CHECK_RETURN_VAL(config.chunk_memory, nullptr, "chunk memory was null");
+            CUW3_CHECK_RETURN_VAL(is_pow2(config.chunk_memory_size), nullptr, "chunk size must be power of two");
+            CUW3_CHECK_RETURN_VAL(is_aligned(config.chunk_memory, intpow2(config.arena_size_log2)), nullptr, "chunk memory is not properly aligned");
+
+            uint64 num_slots = config.chunk_memory_size >> config.arena_size_log2;
+            CUW3_CHECK_RETURN_VAL(num_slots >= 2, nullptr, "chunk is too small");
+            CUW3_CHECK_RETURN_VAL(num_slots * (conf_control_block_size + sizeof(RegionChunkPoolLinkType)) <= intpow2(config.arena_size_log2), nullptr, "control blocks do not fit into the first slot");
+
+            auto* chunk = new (memory.get()) SubChunkArenaChunk{};
+            chunk->region_chunk_header = RegionChunkHandleHeader::from(nullptr, (uint64)RegionChunkType::SubChunkArenas);
+            chunk->chunk_memory = config.chunk_memory;
+            chunk->chunk_memory_size = config.chunk_memory_size;
+            chunk->arena_size_log2 = config.arena_size_log2;
+
+            CUW3_UNPOISON_MEMORY_REGION(config.chunk_memory, num_slots * (conf_control_block_size + sizeof(RegionChunkPoolLinkType)));
+
+            chunk->arenas = (FastArena*)config.chunk_memory;
+            chunk->links = (RegionChunkPoolLinkType*)advance_ptr(config.chunk_memory, num_slots * conf_control_block_size);
+            return chunk;
+        }
+
+
+        // control block + memory of the slot, slot 0 is reserved
+        RegionChunkMemory slot_memory(uint64 slot) const {
+            CUW3_CHECK(slot > 0 && slot < num_slots(), "invalid slot");
+
+            return {advance_ptr(chunk->chunk_memory, slot << chunk->arena_size_log2), arena_size(), &chunk->arenas[slot], conf_control_block_size};
+        }
+
+        uint64 slot_from_ptr(void* ptr) const {
+            auto offset = subptr(ptr, chunk->chunk_memory);
+            CUW3_CHECK(offset >= 0 && (uint64)offset < chunk->chunk_memory_size, "ptr does not belong to the chunk");
+
+            auto slot = divpow2((uint64)offset, chunk->arena_size_log2);
+            CUW3_CHECK(slot > 0, "ptr points to control blocks");
+            return slot;
+        }
+
+        // can be called from any thread that legitimately holds the allocation: arena stays alive as long as the allocation does
+        FastArena* arena_from_ptr(void* ptr) const {
+            return &chunk->arenas[slot_from_ptr(ptr)];
+        }
+
+        RegionChunkPoolLinkType* link(uint64 slot) const {
+            return &chunk->links[slot];
+        }
+
+        uint64 num_slots() const {
+            return chunk->chunk_memory_size >> chunk->arena_size_log2;
+        }
+
+        uint64 arena_size() const {
+            return intpow2(chunk->arena_size_log2);
+        }
+
+        uint64 type() const {
+            return chunk->region_chunk_header.data();
+        }
+
+
+        SubChunkArenaChunk* chunk{};
+    };
+
+
+    struct SubChunkArenaPoolConfig {
+        uint64 arena_size_log2{};
+        uint64 thread_limit{}; // thread takes sub-chunk arenas while its chunk storage is below the limit, zero disables the pool
+
+        // filled by the allocator
+        uint64 chunk_size_log2{}; // only chunks of this size are carved
+        uint64 num_handles{};
+    };
+
+    // global pool of free sub-chunk arena slots, shared by all threads
+    struct SubChunkArenaPool {
+        struct SlotOps {
+            RegionChunkPoolLinkType* get_link(RegionChunkPoolLinkType node) {
+                auto* chunk = (SubChunkArenaChunk*)rca->handle_from_index(node >> pool->num_slots_log2);
+                CUW3_CHECK(chunk, "invalid link value 'node' passed");
+
+                return SubChunkArenaChunkView{chunk}.link(node & (intpow2(pool->num_slots_log2) - 1));
+            }
+
+            // exclusive modification here while we attempt to push it back into the list
+            void set_next(RegionChunkPoolLinkType node, RegionChunkPoolLinkType next) {
+                std::atomic_ref{*get_link(node)}.store(next, std::memory_order_relaxed);
+            }
+
+            RegionChunkPoolLinkType get_next(RegionChunkPoolLinkType node) {
+                return std::atomic_ref{*get_link(node)}.load(std::memory_order_relaxed);
+            }
+
+            SubChunkArenaPool* pool{};
+            RegionChunkAllocator* rca{};
+        };
+
+        [[nodiscard]] static SubChunkArenaPool* create(Memory memory, const SubChunkArenaPoolConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<SubChunkArenaPool>(), nullptr, "invalid memory");
+
+            auto* pool = new (memory.get()) SubChunkArenaPool{};
+            pool->free_list = {0, region_chunk_pool_null_link};
+            if (!config.thread_limit) {
+                return pool;
+            }
+
+            CUW3_CHECK_RETURN_VAL(config.arena_size_log2 < config.chunk_size_log2, nullptr, "arena must be smaller than the chunk");
+            CUW3_CHECK_RETURN_VAL(intpow2(config.arena_size_log2) % fast_arena_end_map_summary_word_span == 0, nullptr, "arena size is not aligned to end map summary word");
+
+            uint64 num_slots_log2 = config.chunk_size_log2 - config.arena_size_log2;
+            CUW3_CHECK_RETURN_VAL(config.num_handles << num_slots_log2 < region_chunk_pool_failed_alloc, nullptr, "slot links do not fit into the link type");
+
+            pool->arena_size_log2 = config.arena_size_log2;
+            pool->num_slots_log2 = num_slots_log2;
+            pool->chunk_size_log2 = config.chunk_size_log2;
+            pool->thread_limit = config.thread_limit;
+            return pool;
+        }
+
+
+        // size is the size arena is acquired for
+        bool can_allocate(uint64 thread_storage_size, uint64 size, uint64 alignment) const {
+            return thread_storage_size < thread_limit && align(size, alignment) <= get_arena_size() && alignment <= get_arena_size();
+        }
+
+        // thread is small as long as it can take sub-chunk arenas
+        bool serves_thread(uint64 thread_storage_size) const {
+            return thread_storage_size < thread_limit;
+        }
+
+        uint64 get_arena_size() const {
+            return intpow2(arena_size_log2);
+        }
+
+        uint64 get_chunk_size() const {
+            return intpow2(chunk_size_log2);
+        }
+
+        // returns null memory if pool is empty, new chunk must be added then
+        [[nodiscard]] RegionChunkMemory acquire(RegionChunkAllocator& rca) {
+            auto list_view = RegionChunkPoolListView{&free_list};
+            auto node = list_view.pop(SubChunkArenaPoolBackoff{}, SlotOps{this, &rca});
+            if (node == region_chunk_pool_null_link) {
+                return {};
+            }
+            return slot_view_(rca, node).slot_memory(node & slot_mask_());
+        }
+
+        // chunk must be committed and must be of the pool chunk size
+        // the first arena slot is handed to the caller, the rest go into the free list
+        [[nodiscard]] RegionChunkMemory add_chunk(RegionChunkAllocator& rca, RegionChunkMemory chunk_memory, uint32 handle) {
+            CUW3_CHECK(chunk_memory.chunk_size == get_chunk_size(), "chunk has invalid size");
+
+            SubChunkArenaChunkConfig config{};
+            config.chunk_memory = chunk_memory.chunk;
+            config.chunk_memory_size = chunk_memory.chunk_size;
+            config.arena_size_log2 = arena_size_log2;
+            auto* chunk = SubChunkArenaChunkView::create(Memory::from(chunk_memory.handle, chunk_memory.handle_size), config);
+            CUW3_CHECK(chunk, "failed to create sub-chunk");
+
+            auto chunk_view = SubChunkArenaChunkView{chunk};
+            auto list_view = RegionChunkPoolListView{&free_list};
+            for (uint64 slot = chunk_view.num_slots() - 1; slot > 1; slot--) {
+                list_view.push(((RegionChunkPoolLinkType)handle << num_slots_log2) | slot, SubChunkArenaPoolBackoff{}, SlotOps{this, &rca});
+            }
+            return chunk_view.slot_memory(1);
+        }
+
+        // arena must be reset, handle is the handle of the chunk arena belongs to
+        void release(RegionChunkAllocator& rca, FastArena* arena, uint32 handle) {
+            auto arena_view = FastArenaView{arena};
+            CUW3_CHECK(arena_view.empty(), "arena was not reset");
+
+            auto* chunk = (SubChunkArenaChunk*)rca.handle_from_index(handle);
+            auto slot = SubChunkArenaChunkView{chunk}.slot_from_ptr(arena->arena_memory);
+            CUW3_CHECK(&chunk->arenas[slot] == arena, "arena does not belong to the chunk");
+
+            auto list_view = RegionChunkPoolListView{&free_list};
+            list_view.push(((RegionChunkPoolLinkType)handle << num_slots_log2) | slot, SubChunkArenaPoolBackoff{}, SlotOps{this, &rca});
+        }
+
+
+        SubChunkArenaChunkView slot_view_(RegionChunkAllocator& rca, RegionChunkPoolLinkType node) {
+            auto* chunk = (SubChunkArenaChunk*)rca.handle_from_index(node >> num_slots_log2);
+            CUW3_CHECK(chunk, "invalid slot link");
+            return {chunk};
+        }
+
+        uint64 slot_mask_() const {
+            return intpow2(num_slots_log2) - 1;
+        }
+
+
+        alignas(conf_cacheline) RegionChunkPoolListHead free_list{}; // atomic
+
+        alignas(conf_cacheline) uint64 arena_size_log2{}; // readonly
+        uint64 num_slots_log2{}; // readonly
+        uint64 chunk_size_log2{}; // readonly
+        uint64 thread_limit{}; // readonly
+    };
+}
@@ -5,8 +5,11 @@
 #include "backoff.hpp"
 #include "fast_arena.hpp"
 #include "cuw3/atomic.hpp"
+#include "slab_allocator.hpp"
 #include "retire_reclaim.hpp"
 #include "thread_graveyard.hpp"
+#include "thread_local_cache.hpp"
+#include "remote_free_buffer.hpp"
 #include "region_chunk_handle.hpp"
 #include "region_chunk_allocator.hpp"
 #include "fast_arena_small_allocator.hpp"
@@ -16,6 +19,9 @@ namespace cuw3 {
     struct ThreadLocalAllocatorConfig {
         FastArenaStepSplitAllocatorConfig step_split_alloc_config{};
         FastArenaSmallAllocatorConfig small_alloc_config{};
+        SlabAllocatorConfig slab_alloc_config{};
+        ThreadLocalCacheConfig tcache_config{};
+        RemoteFreeBufferConfig remote_free_config{};
         uint64 thread_id{};
     };
 
@@ -39,12 +45,23 @@ namespace cuw3 {
             auto* small_allocator = FastArenaSmallAllocator::create(Memory::from(&tla->small_allocator), config.small_alloc_config);
             CUW3_CHECK_RETURN_VAL(small_allocator, nullptr, "failed to create small_allocator");
 
-            for (uint i = 0; i < conf_max_region_sizes; i++) {
-                tla->cached_chunks[i] = null_region_chunk_allocation;
-            }
+            auto* slab_allocator = SlabAllocator::create(Memory::from(&tla->slab_allocator), config.slab_alloc_config);
+            CUW3_CHECK_RETURN_VAL(slab_allocator, nullptr, "failed to create slab_allocator");
+
+            CUW3_CHECK_RETURN_VAL(config.tcache_config.max_size <= config.slab_alloc_config.max_size, nullptr, "tcache must not serve sizes that slab allocator cannot");
+            auto* tcache = ThreadLocalCache::create(Memory::from(&tla->tcache), config.tcache_config);
+            CUW3_CHECK_RETURN_VAL(tcache, nullptr, "failed to create tcache");
+
+            auto* remote_frees = RemoteFreeBuffer::create(Memory::from(&tla->remote_frees), config.remote_free_config);
+            CUW3_CHECK_RETURN_VAL(remote_frees, nullptr, "failed to create remote free buffer");
 
             tla->thread_id = config.thread_id;
 
+            // thread ids are sequential so threads are spread evenly over the pool splits, split is masked by the pools
+            for (auto& split : tla->last_chunk_pool_split_id) {
+                split = config.thread_id;
+            }
+
             return tla;
         }
 
@@ -54,14 +71,17 @@ namespace cuw3 {
         }
 
         bool empty() const {
-            return step_split_allocator.empty() && small_allocator.empty();
+            return tcache.empty() && remote_frees.empty() && step_split_allocator.empty() && small_allocator.empty() && slab_allocator.empty();
         }
 
         ThreadGraveyardEntry graveyard_entry{};
 
-        RegionChunkAllocation cached_chunks[conf_max_region_sizes] = {};
+        ThreadLocalCache tcache{}; // hottest data goes first
+        RemoteFreeBuffer remote_frees{};
+
         uint64 total_chunk_storage_size{};
         uint64 last_chunk_pool_split_id[conf_max_region_sizes] = {};
+        RegionChunkMagazine chunk_magazines[conf_max_magazine_chunk_size_id + 1] = {};
         uint64 last_graveyard_id{};
         uint64 this_cleanup_counter{};
         uint64 grave_cleanup_counter{};
@@ -70,5 +90,6 @@ namespace cuw3 {
 
         FastArenaStepSplitAllocator step_split_allocator{};
         FastArenaSmallAllocator small_allocator{};
+        SlabAllocator slab_allocator{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "conf.hpp"
+#include "utils.hpp"
+#include "assert.hpp"
+#include "slab_allocator.hpp"
+
+namespace cuw3 {
+    // thread local cache (tcache): LIFO stacks of freed slab blocks, one stack per slab size class
+    // * same-thread free pushes block here, allocation pops it: no chunk lookup, no page bookkeeping
+    // * block is keyed by the size class of the size it was freed with, not by its page
+    //   * block from the bin k can be bigger than class size (alignment pushed it into the bigger class)
+    //   * its address is still aligned to any alignment class size of k is aligned to, so bin k can serve any request that maps to k
+    // * bin overflow is flushed back into the slab allocator in batches (the coldest blocks go first), flushing is done by the allocator
+    // * next pointer is stored within the block
+    struct ThreadLocalCacheBin {
+        void* head{};
+        uint64 count{};
+    };
+
+    struct ThreadLocalCacheConfig {
+        uint64 max_size{}; // must not exceed slab max size
+        uint64 bin_capacity{}; // zero disables cache
+        uint64 flush_batch{};
+    };
+
+    struct ThreadLocalCache {
+        [[nodiscard]] static ThreadLocalCache* create(Memory memory, const ThreadLocalCacheConfig& config) {
+            CUW3_CHECK_RETURN_VAL(memory.fits<ThreadLocalCache>(), nullptr, "invalid memory");
+            CUW3_CHECK_RETURN_VAL(config.max_size <= conf_slab_max_size, nullptr, "max size is too big");
+            CUW3_CHECK_RETURN_VAL(config.flush_batch <= config.bin_capacity, nullptr, "flush batch is greater than bin capacity");
+            CUW3_CHECK_RETURN_VAL(!config.bin_capacity || config.flush_batch, nullptr, "flush batch must be positive");
+
+            auto* cache = new (memory.get()) ThreadLocalCache{};
+            cache->max_size = config.bin_capacity ? config.max_size : 0;
+            cache->bin_capacity = config.bin_capacity;
+            cache->flush_batch = config.flush_batch;
+            return cache;
+        }
+
+
+        // returns slab_null_size_class if request cannot be served by the cache
+        uint64 locate_size_class(uint64 size, uint64 alignment) const {
+            if (size > max_size) {
+                return slab_null_size_class;
+            }
+            auto size_class = slab_size_to_size_class(std::max<uint64>(size, 1));
+            if (!is_aligned(slab_size_class_to_size(size_class), alignment)) {
+                return slab_null_size_class;
+            }
+            return size_class;
+        }
+
+        [[nodiscard]] void* pop(uint64 size_class) {
+            CUW3_CHECK(size_class < conf_slab_num_size_classes, "invalid size class");
+
+            auto& bin = bins[size_class];
+            void* block = bin.head;
+            if (!block) {
+                return nullptr;
+            }
+            bin.head = *(void**)block;
+            bin.count--;
+            total_cached--;
+            return block;
+        }
+
+        // bin must not be full
+        void push(uint64 size_class, void* block) {
+            CUW3_CHECK(size_class < conf_slab_num_size_classes, "invalid size class");
+
+            auto& bin = bins[size_class];
+            CUW3_CHECK(bin.count < bin_capacity, "bin is full");
+
+            *(void**)block = bin.head;
+            bin.head = block;
+            bin.count++;
+            total_cached++;
+        }
+
+        // detaches everything but first 'keep' blocks (most recently freed ones stay in the cache)
+        // returns detached chain, next pointer is stored within the block
+        [[nodiscard]] void* detach_tail(uint64 size_class, uint64 keep) {
+            CUW3_CHECK(size_class < conf_slab_num_size_classes, "invalid size class");
+
+            auto& bin = bins[size_class];
+            if (bin.count <= keep) {
+                return nullptr;
+            }
+
+            void* detached{};
+            if (keep == 0) {
+                detached = std::exchange(bin.head, nullptr);
+            } else {
+                void* last_kept = bin.head;
+                for (uint64 i = 1; i < keep; i++) {
+                    last_kept = *(void**)last_kept;
+                }
+                detached = std::exchange(*(void**)last_kept, nullptr);
+            }
+            total_cached -= bin.count - keep;
+            bin.count = keep;
+            return detached;
+        }
+
+        bool full(uint64 size_class) const {
+            CUW3_CHECK(size_class < conf_slab_num_size_classes, "invalid size class");
+
+            return bins[size_class].count >= bin_capacity;
+        }
+
+        bool empty() const {
+            return total_cached == 0;
+        }
+
+
+        ThreadLocalCacheBin bins[conf_slab_num_size_classes] = {};
+        uint64 max_size{};
+        uint64 bin_capacity{};
+        uint64 flush_batch{};
+        uint64 total_cached{};
+    };
+}
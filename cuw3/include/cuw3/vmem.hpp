@@ -7,13 +7,22 @@
 // memory access rights are always read-write
 // memory can be reserved or reserved and committed only
 // memory can be committed/decommitted later
+// committed memory can be purged: physical pages are given back but range stays accessible
+// committed mapping can be resized in place or moved with its pages (linux only)
 namespace cuw3 {
     enum VMemAllocType : uintptr {
         VMemReserve = 1,
         VMemCommit = 2,
         // Jesus Christ, just use this. I have to look into the implementation each time I attempt to use this
         VMemReserveCommit = VMemReserve | VMemCommit,
-        VMemHugepages = 4, // for now ignored and unused
+        VMemHugepages = 4, // transparent huge pages hint (MADV_HUGEPAGE), ignored on windows
+        VMemNoReserve = 8, // committed memory is not accounted against commit limit (overcommit), ignored on windows
+        VMemHugetlb = 16, // try explicit huge pages (MAP_HUGETLB) first, falls back to VMemHugepages, ignored on windows
+    };
+
+    enum VMemPurgeType : uintptr {
+        VMemPurgeFree = 1, // lazy: pages are reclaimed only under memory pressure, contents are undefined until written
+        VMemPurgeDontNeed = 2, // eager: pages are reclaimed right away, range reads as zeroes afterwards
     };
 
     using ErrorCode = uint64;
@@ -28,6 +37,10 @@ namespace cuw3 {
     
     CUW3_API bool vmem_commit(void* mem, usize size);
     CUW3_API bool vmem_decommit(void* mem, usize size);
+    CUW3_API bool vmem_purge(void* mem, usize size, VMemPurgeType purge_type);
+
+    // resizes the mapping keeping its pages (no copy), returns new address or nullptr on failure, not supported on windows
+    CUW3_API void* vmem_remap(void* mem, usize size, usize new_size, bool may_move);
 
     CUW3_API ErrorCode vmem_get_last_error();
 }
\ No newline at end of file
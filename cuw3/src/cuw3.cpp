@@ -1,14 +1,29 @@
 #include "cuw3/conf.hpp"
 #include "cuw3/defs.hpp"
+#include "cuw3/cuw3.hpp"
+#include "cuw3/memory_resource.hpp"
+#include "cuw3/fast_path.hpp"
 #include "cuw3/export.hpp"
 
 #include "cuw3/vmem.hpp"
 #include "cuw3/allocator.hpp"
+#include "cuw3/scoped_arena.hpp"
 #include "cuw3/region_chunk_allocator.hpp"
 #include "cuw3/thread_local_allocator.hpp"
 
+#include <bit>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
 using namespace cuw3;
 
+#if CUW3_INLINE_FAST_PATH
+constinit cuw3::Allocator* cuw3::fast_path_allocator{};
+constinit thread_local cuw3::ThreadLocalAllocator* cuw3::fast_path_tla [[gnu::tls_model("initial-exec")]]{};
+#endif
+
 // many tests and benchmarks rely on the consts used here
 // so be sure to change themas well or too provide appropriate means to query necessary info
 namespace {
@@ -21,17 +36,51 @@ namespace {
         config.handle_size = conf_region_handle_size;
         config.handle_alignment = conf_cacheline;
         config.region_alignment = std::max<uint64>({vmem_huge_page_size(), conf_min_region_chunk_size, intpow2(conf_max_alignment_log2)});
+        config.segment_size_log2 = conf_region_segment_size_log2;
+        config.address_space_bits = conf_address_space_bits;
+        config.unified = conf_unified_regions;
+        return config;
+    }
+
+    RegionChunkCacheConfig cuw3_create_chunk_cache_config() {
+        RegionChunkCacheConfig config{};
+        config.budget = conf_chunk_cache_budget;
+        config.num_shards = conf_chunk_cache_shards;
+        config.decay_ms = conf_chunk_cache_decay_ms;
+        for (usize region = 0; region < array_size(conf_chunk_cache_high_watermarks); region++) {
+            config.high_watermarks[region] = conf_chunk_cache_high_watermarks[region];
+            config.low_watermarks[region] = conf_chunk_cache_low_watermarks[region];
+        }
         return config;
     }
 
+    // fewer splits strand less memory in pools nobody allocates from, more splits spread the contention on big machines
+    uint64 cuw3_contention_split() {
+        if (conf_region_chunk_pool_contention_split) {
+            return conf_region_chunk_pool_contention_split;
+        }
+        uint64 hardware_threads = std::clamp<uint64>(std::thread::hardware_concurrency(), 1, conf_max_contention_split);
+        return std::bit_ceil(hardware_threads);
+    }
+
     AllocatorConfig cuw3_create_allocator_config() {
         AllocatorConfig config{};
         config.rca_specs_config = cuw3_create_rca_alloc_specs_config();
-        config.contention_split = 16;
+        config.chunk_cache_config = cuw3_create_chunk_cache_config();
+        config.sub_arena_pool_config.arena_size_log2 = conf_sub_chunk_arena_size_log2;
+        config.sub_arena_pool_config.thread_limit = conf_sub_chunk_arena_thread_limit;
+        config.contention_split = cuw3_contention_split();
         config.num_grave_entries = conf_graveyard_slot_count;
+        config.chunk_commit_mode = (ChunkCommitMode)conf_chunk_commit_mode;
+        config.chunk_huge_page_mode = (ChunkHugePageMode)conf_chunk_hugepage_mode;
         return config;
     }
 
+    uint64 cuw3_monotonic_time_ms() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    }
+
     [[nodiscard]] cuw3::Allocator* cuw3_create_allocator() {
         auto config = cuw3_create_allocator_config();
         uint64 alloc_size = sizeof(cuw3::Allocator);
@@ -46,6 +95,9 @@ namespace {
             return nullptr;
         }
         CUW3_UNPOISON_MEMORY_REGION(alloc_mem, alloc_size);
+#if CUW3_INLINE_FAST_PATH
+        fast_path_allocator = alloc;
+#endif
         return alloc;
     }
 
@@ -58,7 +110,7 @@ namespace {
     cuw3::FastArenaSmallAllocatorConfig cuw3_create_fast_arena_small_alloc_config() {
         cuw3::FastArenaSmallAllocatorConfig config{};
         config.bins_config.min_arena_alignment_log2 = conf_fast_arena_min_alignment_log2;
-        config.bins_config.max_arena_alignment_log2 = conf_fast_arena_max_alignment_log2;
+        config.bins_config.max_arena_alignment_log2 = conf_fast_arena_binned_max_alignment_log2;
         config.bins_config.size_cutoff = conf_size_cutoff;
         return config;
     }
@@ -69,12 +121,36 @@ namespace {
         config.bins_config.min_arena_step_size_log2 = conf_max_region_chunk_size_log2 - CUW3_MAX_FAST_ARENA_LOOKUP_STEPS;
         config.bins_config.max_arena_step_size_log2 = conf_max_region_chunk_size_log2 - 1;
         config.bins_config.min_arena_alignment_log2 = conf_fast_arena_min_alignment_log2;
-        config.bins_config.max_arena_alignment_log2 = conf_fast_arena_max_alignment_log2;
+        config.bins_config.max_arena_alignment_log2 = conf_fast_arena_binned_max_alignment_log2;
+        return config;
+    }
+
+    cuw3::SlabAllocatorConfig cuw3_create_slab_alloc_config() {
+        cuw3::SlabAllocatorConfig config{};
+        config.max_size = conf_slab_max_size;
+        return config;
+    }
+
+    cuw3::ThreadLocalCacheConfig cuw3_create_tcache_config() {
+        cuw3::ThreadLocalCacheConfig config{};
+        config.max_size = conf_slab_max_size;
+        config.bin_capacity = conf_tcache_bin_capacity;
+        config.flush_batch = conf_tcache_flush_batch;
+        return config;
+    }
+
+    cuw3::RemoteFreeBufferConfig cuw3_create_remote_free_config() {
+        cuw3::RemoteFreeBufferConfig config{};
+        config.num_batches = conf_remote_free_batches;
+        config.batch_capacity = conf_remote_free_batch_capacity;
         return config;
     }
 
     cuw3::ThreadLocalAllocatorConfig cuw3_create_tla_config(uint64 thread_id) {
         cuw3::ThreadLocalAllocatorConfig config{};
+        config.slab_alloc_config = cuw3_create_slab_alloc_config();
+        config.tcache_config = cuw3_create_tcache_config();
+        config.remote_free_config = cuw3_create_remote_free_config();
         config.small_alloc_config = cuw3_create_fast_arena_small_alloc_config();
         config.step_split_alloc_config = cuw3_create_fast_arena_step_split_alloc_config();
         config.thread_id = thread_id;
@@ -121,18 +197,29 @@ namespace {
     void cuw3_destroy_tla(cuw3::ThreadLocalAllocator* tla) {
         auto* alloc = cuw3_get_allocator();
         CUW3_CHECK_CRITICAL(alloc, "Failed to get alloc");
-        alloc->free_tla_resources(tla); // TODO
 
         uint64 tla_size = sizeof(cuw3::ThreadLocalAllocator);
         CUW3_POISON_MEMORY_REGION(tla, tla_size);
         vmem_free(tla, tla_size);
     }
 
+    // thread_local destructors run before the static ones so allocator may still be called after guard is dead
+    // guard cannot tell it itself: store to the dying object is dead one and compiler drops it
+    thread_local bool cuw3_tla_released{};
+
     struct ThreadLocalAllocatorGuard {
         ~ThreadLocalAllocatorGuard() {
+            cuw3_tla_released = true;
+#if CUW3_INLINE_FAST_PATH
+            fast_path_tla = nullptr;
+#endif
+
             auto* alloc = cuw3_get_allocator();
             CUW3_CHECK_CRITICAL(alloc, "allocator was nullptr");
             if (tla) {
+                alloc->flush_remote_frees(tla);
+                alloc->flush_tcache(tla);
+                alloc->flush_chunk_magazines(tla);
                 if (alloc->reclaim(tla)) {
                     cuw3_destroy_tla(tla);
                 } else {
@@ -146,18 +233,57 @@ namespace {
     };
 
     cuw3::ThreadLocalAllocator* cuw3_get_tla() {
+        if (cuw3_tla_released) {
+            return nullptr;
+        }
         static thread_local ThreadLocalAllocatorGuard guard{cuw3_create_tla()};
+#if CUW3_INLINE_FAST_PATH
+        fast_path_tla = guard.tla;
+#endif
         return guard.tla;
     }
-}
 
-extern "C" {
-    CUW3_API void* cuw3_alloc(uint64_t size, uint64_t alignment) {
+    struct Cuw3ThisThread {
+        cuw3::Allocator* alloc{};
+        cuw3::ThreadLocalAllocator* tla{};
+    };
+
+    // published fast path allocator first, it is set once the allocator is created
+    [[nodiscard]] cuw3::Allocator* cuw3_this_thread_allocator() {
+#if CUW3_INLINE_FAST_PATH
+        if (auto* alloc = fast_path_allocator) {
+            return alloc;
+        }
+#endif
+        return cuw3_get_allocator();
+    }
+
+    // published fast path pointers first, full lookup (allocator and tla creation) only if the thread has none yet
+    // tla is null if the allocator cannot be used by this thread: allocator failed to be created or thread is exiting
+    Cuw3ThisThread cuw3_this_thread() {
+#if CUW3_INLINE_FAST_PATH
+        if (auto* tla = fast_path_tla) {
+            return {fast_path_allocator, tla};
+        }
+#endif
         auto* alloc = cuw3_get_allocator();
         if (!alloc) {
-            return nullptr;
+            return {};
         }
-        auto* tla = cuw3_get_tla();
+        return {alloc, cuw3_get_tla()};
+    }
+
+    // every free of this thread goes through here: periodic reclaim and graveyard cleanup cadence
+    void cuw3_this_thread_cleanup(cuw3::Allocator* alloc, cuw3::ThreadLocalAllocator* tla) {
+        (void)alloc->this_tla_cleanup(tla);// tla is still alive
+        if (auto* released = alloc->grave_tla_cleanup(tla)) {
+            cuw3_destroy_tla(released);
+        }
+    }
+
+    // shared by the C API and the C++ adapters
+    [[nodiscard]] void* cuw3_this_thread_alloc(uint64 size, uint64 alignment) {
+        auto [alloc, tla] = cuw3_this_thread();
         if (!tla) {
             return nullptr;
         }
@@ -168,21 +294,302 @@ extern "C" {
         return nullptr;
     }
 
+    void cuw3_this_thread_free(void* ptr, uint64 size) {
+        auto [alloc, tla] = cuw3_this_thread();
+        if (!tla) {
+            return;
+        }
+        alloc->deallocate(tla, ptr, size);
+        cuw3_this_thread_cleanup(alloc, tla);
+    }
+}
+
+// heaps
+namespace {
+    // tlas of a heap are never released one by one: they are linked here and released along with the heap
+    struct Cuw3HeapTla {
+        cuw3::ThreadLocalAllocator tla{};
+        Cuw3HeapTla* next{};
+    };
+}
+
+struct cuw3_heap {
+    cuw3::Allocator alloc{};
+    Cuw3HeapTla* tlas{}; // atomic, push only
+    uint64 id{}; // readonly, unique, never reused
+    uint32 slot{}; // readonly
+};
+
+namespace {
+    // heap slot: heap id << cuw3_heap_pin_bits | pins, zero if slot is free
+    // exiting thread pins heaps it has used so they are not destroyed while their tlas are flushed, destroy waits for the pins
+    // id tells a live heap from a destroyed one that had the same address or the same slot
+    inline constexpr uint64 cuw3_heap_pin_bits = 16;
+
+    uint64 cuw3_heap_slots[conf_max_heaps] = {}; // atomic
+    uint64 cuw3_heap_last_id{}; // atomic
+
+    [[nodiscard]] bool cuw3_pin_heap(uint32 slot, uint64 id) {
+        auto slot_ref = std::atomic_ref{cuw3_heap_slots[slot]};
+        auto slot_old = slot_ref.load(std::memory_order_relaxed);
+        while (divpow2(slot_old, cuw3_heap_pin_bits) == id) {
+            if (slot_ref.compare_exchange_weak(slot_old, slot_old + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void cuw3_unpin_heap(uint32 slot) {
+        std::atomic_ref{cuw3_heap_slots[slot]}.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool cuw3_heap_alive(uint32 slot, uint64 id) {
+        return divpow2(std::atomic_ref{cuw3_heap_slots[slot]}.load(std::memory_order_relaxed), cuw3_heap_pin_bits) == id;
+    }
+
+    [[nodiscard]] cuw3_heap* cuw3_create_heap(const cuw3_heap_config& heap_config) {
+        CUW3_CHECK_RETURN_VAL(heap_config.chunk_commit_mode <= (uint32)ChunkCommitMode::LazyDontNeed, nullptr, "invalid chunk commit mode");
+        CUW3_CHECK_RETURN_VAL(heap_config.chunk_huge_page_mode <= (uint32)ChunkHugePageMode::Hugetlb, nullptr, "invalid chunk huge page mode");
+        CUW3_CHECK_RETURN_VAL(
+            heap_config.chunk_huge_page_mode == (uint32)ChunkHugePageMode::None || conf_min_region_chunk_size % conf_hugepage_size == 0,
+            nullptr, "chunks must not share huge pages"
+        );
+
+        auto config = cuw3_create_allocator_config();
+        uint64 region_sizes[conf_num_region_sizes] = {};
+        if (heap_config.region_size_log2) {
+            std::fill(std::begin(region_sizes), std::end(region_sizes), heap_config.region_size_log2);
+            config.rca_specs_config.region_sizes = region_sizes;
+        }
+        config.chunk_cache_config.budget = heap_config.chunk_cache_budget;
+        if (heap_config.contention_split) {
+            config.contention_split = heap_config.contention_split;
+        }
+        config.num_grave_entries = heap_config.num_grave_entries;
+        config.chunk_commit_mode = (ChunkCommitMode)heap_config.chunk_commit_mode;
+        config.chunk_huge_page_mode = (ChunkHugePageMode)heap_config.chunk_huge_page_mode;
+
+        uint64 id = std::atomic_ref{cuw3_heap_last_id}.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint32 slot = 0;
+        for (; slot < conf_max_heaps; slot++) {
+            uint64 expected = 0;
+            if (std::atomic_ref{cuw3_heap_slots[slot]}.compare_exchange_strong(expected, mulpow2(id, cuw3_heap_pin_bits), std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        CUW3_CHECK_RETURN_VAL(slot < conf_max_heaps, nullptr, "too many heaps");
+
+        uint64 heap_size = sizeof(cuw3_heap);
+        void* heap_mem = vmem_alloc(heap_size, VMemAllocType::VMemReserveCommit);
+        auto* heap = heap_mem ? new (heap_mem) cuw3_heap{} : nullptr;
+        if (!heap || !Allocator::create(Memory::from(&heap->alloc), config)) {
+            if (heap_mem) {
+                vmem_free(heap_mem, heap_size);
+            }
+            std::atomic_ref{cuw3_heap_slots[slot]}.store(0, std::memory_order_relaxed);
+            return nullptr;
+        }
+        CUW3_UNPOISON_MEMORY_REGION(heap_mem, heap_size);
+
+        heap->id = id;
+        heap->slot = slot;
+        return heap;
+    }
+
+    // every tla still alive is released here, memory of the heap goes away at once
+    void cuw3_destroy_heap(cuw3_heap* heap) {
+        auto slot_ref = std::atomic_ref{cuw3_heap_slots[heap->slot]};
+        uint64 expected = mulpow2(heap->id, cuw3_heap_pin_bits);
+        while (!slot_ref.compare_exchange_weak(expected, 0, std::memory_order_acquire, std::memory_order_relaxed)) {
+            CUW3_CHECK(divpow2(expected, cuw3_heap_pin_bits) == heap->id, "heap slot was taken by another heap");
+            expected = mulpow2(heap->id, cuw3_heap_pin_bits);
+            std::this_thread::yield();
+        }
+
+        Allocator::destroy(&heap->alloc);
+        for (auto* heap_tla = heap->tlas; heap_tla; ) {
+            auto* next = heap_tla->next;
+            CUW3_POISON_MEMORY_REGION(heap_tla, sizeof(Cuw3HeapTla));
+            vmem_free(heap_tla, sizeof(Cuw3HeapTla));
+            heap_tla = next;
+        }
+        vmem_free(heap, sizeof(cuw3_heap));
+    }
+
+    // dead thread of the heap is reused first
+    [[nodiscard]] cuw3::ThreadLocalAllocator* cuw3_create_heap_tla(cuw3_heap* heap) {
+        if (auto* tla = heap->alloc.snatch_dead_tla()) {
+            return tla;
+        }
+
+        uint64 heap_tla_size = sizeof(Cuw3HeapTla);
+        uint64 heap_tla_alignment = std::max<uint64>(region_owner_alignment, vmem_page_size());
+        void* heap_tla_mem = vmem_alloc_aligned(heap_tla_size, VMemAllocType::VMemReserveCommit, heap_tla_alignment);
+        if (!heap_tla_mem) {
+            return nullptr;
+        }
+
+        auto* heap_tla = new (heap_tla_mem) Cuw3HeapTla{};
+        auto config = cuw3_create_tla_config(heap->alloc.acquire_thread_id());
+        auto* tla = cuw3::ThreadLocalAllocator::create(Memory::from(&heap_tla->tla), config);
+        if (!tla) {
+            vmem_free(heap_tla_mem, heap_tla_size);
+            return nullptr;
+        }
+        CUW3_UNPOISON_MEMORY_REGION(heap_tla_mem, heap_tla_size);
+
+        auto tlas_ref = std::atomic_ref{heap->tlas};
+        heap_tla->next = tlas_ref.load(std::memory_order_relaxed);
+        while (!tlas_ref.compare_exchange_weak(heap_tla->next, heap_tla, std::memory_order_release, std::memory_order_relaxed)) {}
+        return tla;
+    }
+
+    // tla of the heap is never released by the thread, it goes to the graveyard of the heap for the next thread
+    void cuw3_retire_heap_tla(cuw3_heap* heap, cuw3::ThreadLocalAllocator* tla) {
+        heap->alloc.flush_remote_frees(tla);
+        heap->alloc.flush_tcache(tla);
+        heap->alloc.flush_chunk_magazines(tla);
+        (void)heap->alloc.reclaim(tla);
+        heap->alloc.retire_dead_tla(tla);
+    }
+
+    thread_local bool cuw3_heap_tlas_released{};
+
+    struct HeapTlaEntry {
+        cuw3_heap* heap{};
+        uint64 id{};
+        uint32 slot{};
+        cuw3::ThreadLocalAllocator* tla{};
+    };
+
+    // heaps used by the thread, entries of destroyed heaps are reused
+    struct HeapTlaGuard {
+        ~HeapTlaGuard() {
+            cuw3_heap_tlas_released = true;
+
+            for (auto& entry : entries) {
+                if (entry.tla && cuw3_pin_heap(entry.slot, entry.id)) {
+                    cuw3_retire_heap_tla(entry.heap, entry.tla);
+                    cuw3_unpin_heap(entry.slot);
+                }
+                entry = {};
+            }
+        }
+
+        HeapTlaEntry entries[conf_max_thread_heaps] = {};
+    };
+
+    cuw3::ThreadLocalAllocator* cuw3_get_heap_tla(cuw3_heap* heap) {
+        if (cuw3_heap_tlas_released) {
+            return nullptr;
+        }
+        static thread_local HeapTlaGuard guard{};
+        for (auto& entry : guard.entries) {
+            if (entry.heap == heap && entry.id == heap->id) {
+                return entry.tla;
+            }
+        }
+        for (auto& entry : guard.entries) {
+            if (!entry.tla || !cuw3_heap_alive(entry.slot, entry.id)) {
+                auto* tla = cuw3_create_heap_tla(heap);
+                if (!tla) {
+                    return nullptr;
+                }
+                entry = {heap, heap->id, heap->slot, tla};
+                return tla;
+            }
+        }
+        return nullptr;
+    }
+}
+
+extern "C" {
+    CUW3_API void* cuw3_alloc(uint64_t size, uint64_t alignment) {
+        return cuw3_this_thread_alloc(size, alignment);
+    }
+
     CUW3_API void cuw3_free(void* ptr, uint64_t size) {
-        auto* alloc = cuw3_get_allocator();
-        if (!alloc) {
+        cuw3_this_thread_free(ptr, size);
+    }
+
+    // null is fine here as it is for free()
+    CUW3_API void cuw3_free_unsized(void* ptr) {
+        if (!ptr) {
             return;
         }
-        auto* tla = cuw3_get_tla();
+        auto [alloc, tla] = cuw3_this_thread();
         if (!tla) {
             return;
         }
+        alloc->deallocate_unsized(tla, ptr);
+        cuw3_this_thread_cleanup(alloc, tla);
+    }
 
-        alloc->deallocate(tla, ptr, size);
-        (void)alloc->this_tla_cleanup(tla);// tla is still alive
-        if (auto* released = alloc->grave_tla_cleanup(tla)) {
-            cuw3_destroy_tla(released);
+    CUW3_API uint64_t cuw3_alloc_batch(uint64_t size, uint64_t alignment, uint64_t count, void** ptrs) {
+        auto [alloc, tla] = cuw3_this_thread();
+        if (!tla) {
+            return 0;
+        }
+        return alloc->allocate_batch(tla, size, alignment, count, ptrs);
+    }
+
+    CUW3_API void cuw3_free_batch(void* const* ptrs, const uint64_t* sizes, uint64_t count) {
+        auto [alloc, tla] = cuw3_this_thread();
+        if (!tla) {
+            return;
+        }
+        alloc->deallocate_batch(tla, ptrs, sizes, count);
+        cuw3_this_thread_cleanup(alloc, tla);
+    }
+
+    CUW3_API uint64_t cuw3_usable_size(void* ptr) {
+        if (!ptr) {
+            return 0;
+        }
+        auto* alloc = cuw3_this_thread_allocator();
+        if (!alloc) {
+            return 0;
+        }
+        return alloc->usable_size(ptr);
+    }
+
+    CUW3_API int cuw3_try_resize(void* ptr, uint64_t size, uint64_t new_size) {
+        if (!ptr) {
+            return 0;
+        }
+        auto [alloc, tla] = cuw3_this_thread();
+        if (!tla) {
+            return 0;
+        }
+        return alloc->try_resize(tla, ptr, size, new_size);
+    }
+
+    // null ptr allocates, zero new_size frees, old allocation stays intact on failure
+    CUW3_API void* cuw3_realloc(void* ptr, uint64_t size, uint64_t new_size, uint64_t alignment) {
+        if (!ptr) {
+            return cuw3_alloc(new_size, alignment);
+        }
+        if (!new_size) {
+            cuw3_free(ptr, size);
+            return nullptr;
+        }
+        if (is_alignment(alignment) && is_aligned(ptr, alignment) && cuw3_try_resize(ptr, size, new_size)) {
+            return ptr;
+        }
+        if (auto* alloc = cuw3_this_thread_allocator(); alloc && is_alignment(alignment)) {
+            if (void* moved = alloc->reallocate_large(ptr, new_size, alignment)) {
+                return moved;
+            }
+        }
+
+        void* new_ptr = cuw3_alloc(new_size, alignment);
+        if (!new_ptr) {
+            return nullptr;
         }
+        std::memcpy(new_ptr, ptr, std::min(size, new_size));
+        cuw3_free(ptr, size);
+        return new_ptr;
     }
 
     CUW3_API void cuw3_reclaim() {
@@ -194,7 +601,28 @@ extern "C" {
         if (!tla) {
             return;
         }
+        alloc->flush_remote_frees(tla);
+        alloc->flush_tcache(tla);
+        alloc->flush_chunk_magazines(tla);
         alloc->reclaim(tla);
+        alloc->trim_chunk_cache(tla->thread_id);
+    }
+
+    // does not touch thread local allocator so can be called periodically from a dedicated thread
+    CUW3_API uint64_t cuw3_purge(uint64_t max_bytes) {
+        auto* alloc = cuw3_get_allocator();
+        if (!alloc) {
+            return 0;
+        }
+        return alloc->purge_chunk_cache(cuw3_monotonic_time_ms(), max_bytes);
+    }
+
+    CUW3_API uint64_t cuw3_chunk_pool_cas_failures() {
+        auto* alloc = cuw3_get_allocator();
+        if (!alloc) {
+            return 0;
+        }
+        return alloc->chunk_pool_cas_failures();
     }
 
     CUW3_API void cuw3_cleanup() {
@@ -210,4 +638,129 @@ extern "C" {
             cuw3_destroy_tla(released);
         }
     }
-}
\ No newline at end of file
+
+    CUW3_API void cuw3_heap_default_config(cuw3_heap_config* config) {
+        *config = {};
+        config->region_size_log2 = 0;
+        config->chunk_cache_budget = conf_chunk_cache_budget;
+        config->contention_split = 0;
+        config->num_grave_entries = conf_graveyard_slot_count;
+        config->chunk_commit_mode = conf_chunk_commit_mode;
+        config->chunk_huge_page_mode = conf_chunk_hugepage_mode;
+    }
+
+    CUW3_API cuw3_heap* cuw3_heap_create(const cuw3_heap_config* config) {
+        if (!config) {
+            cuw3_heap_config default_config{};
+            cuw3_heap_default_config(&default_config);
+            return cuw3_create_heap(default_config);
+        }
+        return cuw3_create_heap(*config);
+    }
+
+    CUW3_API void cuw3_heap_destroy(cuw3_heap* heap) {
+        if (!heap) {
+            return;
+        }
+        cuw3_destroy_heap(heap);
+    }
+
+    CUW3_API void* cuw3_heap_alloc(cuw3_heap* heap, uint64_t size, uint64_t alignment) {
+        auto* tla = cuw3_get_heap_tla(heap);
+        if (!tla) {
+            return nullptr;
+        }
+        auto res = heap->alloc.allocate(tla, size, alignment);
+        if (res.status_acquired()) {
+            return res.get();
+        }
+        return nullptr;
+    }
+
+    CUW3_API void cuw3_heap_free(cuw3_heap* heap, void* ptr, uint64_t size) {
+        auto* tla = cuw3_get_heap_tla(heap);
+        if (!tla) {
+            return;
+        }
+
+        heap->alloc.deallocate(tla, ptr, size);
+        (void)heap->alloc.this_tla_cleanup(tla);// tla is still alive
+        if (auto* released = heap->alloc.grave_tla_cleanup(tla)) {
+            heap->alloc.retire_dead_tla(released); // see cuw3_retire_heap_tla()
+        }
+    }
+
+    CUW3_API cuw3_arena* cuw3_arena_create(uint64_t size) {
+        auto* alloc = cuw3_get_allocator();
+        if (!alloc) {
+            return nullptr;
+        }
+        auto* tla = cuw3_get_tla();
+        if (!tla) {
+            return nullptr;
+        }
+        return (cuw3_arena*)alloc->create_scoped_arena(tla, size);
+    }
+
+    CUW3_API void* cuw3_arena_alloc(cuw3_arena* arena, uint64_t size, uint64_t alignment) {
+        if (!arena) {
+            return nullptr;
+        }
+        auto* alloc = cuw3_get_allocator();
+        if (!alloc) {
+            return nullptr;
+        }
+        return alloc->scoped_arena_allocate((ScopedArena*)arena, size, alignment);
+    }
+
+    CUW3_API void* cuw3_arena_mark(cuw3_arena* arena) {
+        if (!arena) {
+            return nullptr;
+        }
+        return ScopedArenaView{(ScopedArena*)arena}.mark();
+    }
+
+    CUW3_API void cuw3_arena_rewind(cuw3_arena* arena, void* mark) {
+        if (!arena) {
+            return;
+        }
+        auto* alloc = cuw3_get_allocator();
+        if (!alloc) {
+            return;
+        }
+        alloc->rewind_scoped_arena((ScopedArena*)arena, mark);
+    }
+
+    CUW3_API void cuw3_arena_release(cuw3_arena* arena) {
+        if (!arena) {
+            return;
+        }
+        auto* alloc = cuw3_get_allocator();
+        if (!alloc) {
+            return;
+        }
+        alloc->destroy_scoped_arena((ScopedArena*)arena);
+    }
+}
+// allocator adapters, they talk to the allocator directly
+void* cuw3::MemoryResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* ptr = cuw3_this_thread_alloc(bytes, alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void cuw3::MemoryResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) {
+    (void)alignment;
+    cuw3_this_thread_free(ptr, bytes);
+}
+
+bool cuw3::MemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return dynamic_cast<const MemoryResource*>(&other) != nullptr;
+}
+
+cuw3::MemoryResource* cuw3::get_memory_resource() {
+    static MemoryResource* resource = new MemoryResource{};
+    return resource;
+}
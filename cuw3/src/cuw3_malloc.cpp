@@ -0,0 +1,341 @@
+#include "cuw3/cuw3.hpp"
+#include "cuw3/conf.hpp"
+#include "cuw3/vmem.hpp"
+#include "cuw3/funcs.hpp"
+#include "cuw3/export.hpp"
+
+#include <new>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+
+#include <malloc.h>
+
+using namespace cuw3;
+
+// malloc replacement built on top of cuw3 API: LD_PRELOAD it or link it before libc
+// * free() has no size so it goes through cuw3_free_unsized(), sized delete keeps the sized fast path
+// * bootstrap arena (static buffer, bump allocation, never reused) serves small requests that cuw3 cannot serve:
+//   * reentrant ones: cuw3 may call into libc that calls malloc back (e.g. glibc allocates thread_local destructor list
+//     with calloc while thread local allocator is being created)
+//   * late ones: thread local allocator is gone after thread_local destructors ran but libc/atexit code can still allocate
+//   bootstrap allocation is prefixed with its size so realloc() & malloc_usable_size() work, free() ignores it
+// * reentrant free of cuw3 memory is leaked: we must not touch thread local allocator that is in use
+namespace {
+    inline constexpr uint64 cuw3_malloc_alignment = conf_min_alloc_alignment;
+    inline constexpr uint64 cuw3_malloc_bootstrap_size = 1 << 24; // bss, pages are backed on the first touch only
+    inline constexpr uint64 cuw3_malloc_bootstrap_header = conf_min_alloc_alignment;
+    inline constexpr uint64 cuw3_malloc_bootstrap_max_alloc = cuw3_malloc_bootstrap_size / 16; // single request cannot drain it
+    inline constexpr uint64 cuw3_malloc_bootstrap_max_alignment = CUW3_PAGE_SIZE;
+
+    // must be constant initialized: malloc can be called before constructors of this library run
+    struct alignas(conf_cacheline) BootstrapArena {
+        std::byte memory[cuw3_malloc_bootstrap_size] = {};
+        uint64 top{}; // atomic
+    };
+
+    constinit BootstrapArena cuw3_malloc_bootstrap{};
+
+    [[gnu::tls_model("initial-exec")]] thread_local bool cuw3_malloc_busy{};
+
+    bool bootstrap_owns(void* ptr) {
+        auto* bytes = (std::byte*)ptr;
+        return cuw3_malloc_bootstrap.memory <= bytes && bytes < cuw3_malloc_bootstrap.memory + cuw3_malloc_bootstrap_size;
+    }
+
+    void* bootstrap_alloc(uint64 size, uint64 alignment) {
+        if (size > cuw3_malloc_bootstrap_max_alloc || alignment > cuw3_malloc_bootstrap_max_alignment) {
+            return nullptr;
+        }
+
+        auto top_ref = std::atomic_ref{cuw3_malloc_bootstrap.top};
+        uint64 top = top_ref.load(std::memory_order_relaxed);
+        uint64 start{};
+        do {
+            start = align(top + cuw3_malloc_bootstrap_header, alignment);
+            if (start > cuw3_malloc_bootstrap_size || size > cuw3_malloc_bootstrap_size - start) {
+                return nullptr;
+            }
+        } while (!top_ref.compare_exchange_weak(top, start + size, std::memory_order_relaxed));
+
+        void* ptr = cuw3_malloc_bootstrap.memory + start;
+        std::memcpy((std::byte*)ptr - sizeof(uint64), &size, sizeof(uint64));
+        return ptr;
+    }
+
+    uint64 bootstrap_usable_size(void* ptr) {
+        uint64 size{};
+        std::memcpy(&size, (std::byte*)ptr - sizeof(uint64), sizeof(uint64));
+        return size;
+    }
+
+    struct ReentrancyGuard {
+        ReentrancyGuard() {
+            cuw3_malloc_busy = true;
+        }
+
+        ~ReentrancyGuard() {
+            cuw3_malloc_busy = false;
+        }
+    };
+
+    void* shim_alloc(uint64 size, uint64 alignment) {
+        alignment = std::max(alignment, cuw3_malloc_alignment);
+        void* ptr{};
+        if (!cuw3_malloc_busy) {
+            ReentrancyGuard guard{};
+            ptr = cuw3_alloc(size, alignment);
+        }
+        if (!ptr) {
+            ptr = bootstrap_alloc(size, alignment);
+        }
+        if (!ptr) {
+            errno = ENOMEM;
+        }
+        return ptr;
+    }
+
+    void shim_free(void* ptr) {
+        if (!ptr || bootstrap_owns(ptr) || cuw3_malloc_busy) {
+            return;
+        }
+        ReentrancyGuard guard{};
+        cuw3_free_unsized(ptr);
+    }
+
+    void shim_free_sized(void* ptr, uint64 size) {
+        if (!ptr || bootstrap_owns(ptr) || cuw3_malloc_busy) {
+            return;
+        }
+        ReentrancyGuard guard{};
+        cuw3_free(ptr, size);
+    }
+
+    uint64 shim_usable_size(void* ptr) {
+        if (!ptr) {
+            return 0;
+        }
+        if (bootstrap_owns(ptr)) {
+            return bootstrap_usable_size(ptr);
+        }
+        return cuw3_usable_size(ptr);
+    }
+
+    // in place resize first, then cuw3 realloc: large spans are moved without copying
+    // usable size is what unsized free uses so it is fine to pass it as the allocation size
+    void* shim_cuw3_realloc(void* ptr, uint64 usable_size, uint64 size) {
+        if (bootstrap_owns(ptr) || cuw3_malloc_busy) {
+            return nullptr;
+        }
+        ReentrancyGuard guard{};
+        return cuw3_realloc(ptr, usable_size, size, cuw3_malloc_alignment);
+    }
+
+    // block is kept if it is big enough and not too wasteful, otherwise cuw3 reallocates it
+    void* shim_realloc(void* ptr, uint64 size) {
+        if (!ptr) {
+            return shim_alloc(size, cuw3_malloc_alignment);
+        }
+        if (!size) {
+            shim_free(ptr);
+            return nullptr;
+        }
+
+        uint64 usable_size = shim_usable_size(ptr);
+        if (size <= usable_size && size >= usable_size / 2 && !bootstrap_owns(ptr)) {
+            return ptr;
+        }
+        if (void* new_ptr = shim_cuw3_realloc(ptr, usable_size, size)) {
+            return new_ptr;
+        }
+
+        void* new_ptr = shim_alloc(size, cuw3_malloc_alignment);
+        if (!new_ptr) {
+            return nullptr;
+        }
+        std::memcpy(new_ptr, ptr, std::min(size, usable_size));
+        shim_free(ptr);
+        return new_ptr;
+    }
+
+    void* shim_calloc(uint64 count, uint64 size) {
+        uint64 total{};
+        if (__builtin_mul_overflow(count, size, &total)) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        void* ptr = shim_alloc(total, cuw3_malloc_alignment);
+        if (ptr) {
+            std::memset(ptr, 0, total);
+        }
+        return ptr;
+    }
+
+    void* shim_new(uint64 size, uint64 alignment) {
+        while (true) {
+            if (void* ptr = shim_alloc(size, alignment)) {
+                return ptr;
+            }
+            auto handler = std::get_new_handler();
+            if (!handler) {
+                throw std::bad_alloc{};
+            }
+            handler();
+        }
+    }
+
+    void* shim_new_nothrow(uint64 size, uint64 alignment) noexcept {
+        try {
+            return shim_new(size, alignment);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+}
+
+extern "C" {
+    CUW3_API void* malloc(size_t size) noexcept {
+        return shim_alloc(size, cuw3_malloc_alignment);
+    }
+
+    CUW3_API void free(void* ptr) noexcept {
+        shim_free(ptr);
+    }
+
+    CUW3_API void* calloc(size_t count, size_t size) noexcept {
+        return shim_calloc(count, size);
+    }
+
+    CUW3_API void* realloc(void* ptr, size_t size) noexcept {
+        return shim_realloc(ptr, size);
+    }
+
+    CUW3_API void* reallocarray(void* ptr, size_t count, size_t size) noexcept {
+        uint64 total{};
+        if (__builtin_mul_overflow(count, size, &total)) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        return shim_realloc(ptr, total);
+    }
+
+    CUW3_API void* aligned_alloc(size_t alignment, size_t size) noexcept {
+        if (!is_alignment(alignment)) {
+            errno = EINVAL;
+            return nullptr;
+        }
+        return shim_alloc(size, alignment);
+    }
+
+    CUW3_API int posix_memalign(void** memptr, size_t alignment, size_t size) noexcept {
+        if (!is_alignment(alignment) || alignment < sizeof(void*)) {
+            return EINVAL;
+        }
+        void* ptr = shim_alloc(size, alignment);
+        if (!ptr) {
+            return ENOMEM;
+        }
+        *memptr = ptr;
+        return 0;
+    }
+
+    // glibc rounds invalid alignment up to the power of two
+    CUW3_API void* memalign(size_t alignment, size_t size) noexcept {
+        return shim_alloc(size, std::bit_ceil<uint64>(alignment));
+    }
+
+    CUW3_API void* valloc(size_t size) noexcept {
+        return shim_alloc(size, vmem_page_size());
+    }
+
+    CUW3_API void* pvalloc(size_t size) noexcept {
+        uint64 page_size = vmem_page_size();
+        return shim_alloc(align<uint64>(std::max<uint64>(size, 1), page_size), page_size);
+    }
+
+    CUW3_API size_t malloc_usable_size(void* ptr) noexcept {
+        return shim_usable_size(ptr);
+    }
+}
+
+CUW3_API void* operator new(size_t size) {
+    return shim_new(size, cuw3_malloc_alignment);
+}
+
+CUW3_API void* operator new[](size_t size) {
+    return shim_new(size, cuw3_malloc_alignment);
+}
+
+CUW3_API void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return shim_new_nothrow(size, cuw3_malloc_alignment);
+}
+
+CUW3_API void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return shim_new_nothrow(size, cuw3_malloc_alignment);
+}
+
+CUW3_API void* operator new(size_t size, std::align_val_t alignment) {
+    return shim_new(size, (uint64)alignment);
+}
+
+CUW3_API void* operator new[](size_t size, std::align_val_t alignment) {
+    return shim_new(size, (uint64)alignment);
+}
+
+CUW3_API void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return shim_new_nothrow(size, (uint64)alignment);
+}
+
+CUW3_API void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return shim_new_nothrow(size, (uint64)alignment);
+}
+
+CUW3_API void operator delete(void* ptr) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete[](void* ptr) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete(void* ptr, size_t size) noexcept {
+    shim_free_sized(ptr, size);
+}
+
+CUW3_API void operator delete[](void* ptr, size_t size) noexcept {
+    shim_free_sized(ptr, size);
+}
+
+CUW3_API void operator delete(void* ptr, std::align_val_t) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete[](void* ptr, std::align_val_t) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    shim_free(ptr);
+}
+
+CUW3_API void operator delete(void* ptr, size_t size, std::align_val_t) noexcept {
+    shim_free_sized(ptr, size);
+}
+
+CUW3_API void operator delete[](void* ptr, size_t size, std::align_val_t) noexcept {
+    shim_free_sized(ptr, size);
+}
@@ -67,6 +67,7 @@ namespace cuw3 {
     }
 
     CUW3_API bool vmem_free(void* mem, usize size) {
+        CUW3_UNPOISON_MEMORY_REGION(mem, size);
         return VirtualFree(mem, 0, MEM_RELEASE);
     }
 
@@ -79,6 +80,18 @@ namespace cuw3 {
         return VirtualFree(mem, size, MEM_DECOMMIT);
     }
 
+    CUW3_API bool vmem_purge(void* mem, usize size, VMemPurgeType purge_type) {
+        if (purge_type == VMemPurgeFree) {
+            return VirtualAlloc(mem, size, MEM_RESET, PAGE_READWRITE);
+        }
+        // no direct analogue of MADV_DONTNEED, recommitted pages are zeroed
+        return vmem_decommit(mem, size) && vmem_commit(mem, size);
+    }
+
+    CUW3_API void* vmem_remap(void* mem, usize size, usize new_size, bool may_move) {
+        return nullptr;
+    }
+
     CUW3_API ErrorCode vmem_get_last_error() {
         return GetLastError();
     }
@@ -115,6 +128,9 @@ namespace cuw3 {
 
     CUW3_API void* vmem_alloc(usize size, VMemAllocType alloc_type) {
         int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (alloc_type & VMemNoReserve) {
+            flags |= MAP_NORESERVE;
+        }
         int protection = {};
         if ((alloc_type & VMemReserveCommit) == VMemReserve) {
             protection = PROT_NONE;
@@ -123,7 +139,21 @@ namespace cuw3 {
         } else {
             return nullptr;
         }
-        void* mem = mmap(nullptr, size, protection, flags, -1, 0);
+
+        void* mem = MAP_FAILED;
+        // hugetlb pages are reserved on mmap so it fails right away if the pool is exhausted (or was never configured)
+        // without reservation (MAP_NORESERVE) we would get SIGBUS on the first touch instead so we do not even try
+        // size must be a multiple of the huge page size
+        if ((alloc_type & VMemHugetlb) && !(alloc_type & VMemNoReserve) && is_aligned(size, vmem_huge_page_size())) {
+            mem = mmap(nullptr, size, protection, flags | MAP_HUGETLB, -1, 0);
+        }
+        if (mem == MAP_FAILED) {
+            mem = mmap(nullptr, size, protection, flags, -1, 0);
+            if (mem != MAP_FAILED && (alloc_type & (VMemHugepages | VMemHugetlb))) {
+                // advice is inherited by all future commits of this range, result is ignored: THP can be disabled system-wide
+                (void)madvise(mem, size, MADV_HUGEPAGE);
+            }
+        }
         // it seems okay to use nullptr as failed value here as we dont use MAP_FIXED to create a new mapping
         // and mmap never returns nullptr as a valid address in such a case
         return mem != MAP_FAILED ? mem : nullptr;
@@ -143,8 +173,13 @@ namespace cuw3 {
             return vmem_alloc(size, alloc_type);
         }
         
+        // head & tail trimming of hugetlb mapping must be done on huge page boundaries
+        if (!is_aligned(size, vmem_huge_page_size()) || !is_aligned(address_alignment, vmem_huge_page_size())) {
+            alloc_type = (VMemAllocType)(alloc_type & ~VMemHugetlb);
+        }
+
         usize address_aligned_size = align(size, address_alignment);
-        void* raw_mem = vmem_alloc(address_aligned_size + address_alignment, VMemReserve);
+        void* raw_mem = vmem_alloc(address_aligned_size + address_alignment, (VMemAllocType)(VMemReserve | (alloc_type & (VMemNoReserve | VMemHugepages | VMemHugetlb))));
         if (!raw_mem) {
             return nullptr;
         }
@@ -168,7 +203,9 @@ namespace cuw3 {
         return aligned_mem;
     }
 
+    // shadow outlives the mapping: whatever is mapped here next must not inherit the poison
     CUW3_API bool vmem_free(void* mem, usize size) {
+        CUW3_UNPOISON_MEMORY_REGION(mem, size);
         return munmap(mem, size) == 0;
     }
 
@@ -183,6 +220,26 @@ namespace cuw3 {
         return prot && adv;
     }
 
+    CUW3_API bool vmem_purge(void* mem, usize size, VMemPurgeType purge_type) {
+    #ifdef MADV_FREE
+        if (purge_type == VMemPurgeFree) {
+            if (madvise(mem, size, MADV_FREE) == 0) {
+                return true;
+            }
+            if (errno != EINVAL) {
+                return false;
+            }
+            // kernel is too old (< 4.5), fallback to MADV_DONTNEED
+        }
+    #endif
+        return madvise(mem, size, MADV_DONTNEED) == 0;
+    }
+
+    CUW3_API void* vmem_remap(void* mem, usize size, usize new_size, bool may_move) {
+        void* new_mem = mremap(mem, size, new_size, may_move ? MREMAP_MAYMOVE : 0);
+        return new_mem != MAP_FAILED ? new_mem : nullptr;
+    }
+
 
     CUW3_API ErrorCode vmem_get_last_error() {
         return errno;
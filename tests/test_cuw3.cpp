@@ -2,8 +2,12 @@
 #include <mutex>
 #include <vector>
 #include <iostream>
+#include <map>
+#include <unordered_map>
 
 #include <cuw3/cuw3.hpp>
+#include <cuw3/memory_resource.hpp>
+#include <cuw3/fast_path.hpp>
 
 #include "tests_common.hpp"
 
@@ -100,6 +104,40 @@ void test_cuw3_st_mini() {
     allocs.clear();
 }
 
+// freed small block must be handed out again by the very next allocation of the same size
+void test_cuw3_tcache_reuse(uint rounds) {
+    for (uint64 alloc_size = 16; alloc_size <= 1024; alloc_size += 16) {
+        void* ptr = cuw3_alloc(alloc_size, 16);
+        if (!ptr) {
+            MAKE_AN_ABORTION("failed to make an allocation");
+        }
+        for (uint round = 0; round < rounds; round++) {
+            cuw3_free(ptr, alloc_size);
+            void* reused = cuw3_alloc(alloc_size, 16);
+            if (reused != ptr) {
+                MAKE_AN_ABORTION("block was not reused");
+            }
+        }
+        cuw3_free(ptr, alloc_size);
+    }
+
+    // overflow bins so they get flushed back
+    std::vector<Alloc> allocs{};
+    for (uint i = 0; i < 1024; i++) {
+        uint64 alloc_size = 16 + i % 64;
+        if (void* ptr = cuw3_alloc(alloc_size, 16)) {
+            memset(ptr, 0xff, alloc_size);
+            allocs.push_back({ptr, alloc_size});
+        } else {
+            MAKE_AN_ABORTION("failed to make an allocation");
+        }
+    }
+    for (auto alloc : allocs) {
+        cuw3_free(alloc.ptr, alloc.size);
+    }
+    cuw3_reclaim();
+}
+
 void test_cuw3_mt_spam(uint total_spam_rounds, uint await_queue_size, uint alloc_rounds) {
     std::queue<std::thread> await_queue{};
     auto push_thread = [&] () {
@@ -266,6 +304,710 @@ void test_cuw3_mt_cross(uint threads, uint total_allocations, uint max_alloc_siz
     }
 }
 
+// producer allocates, consumer frees: every free is a cross-thread one and goes through remote free buffer
+// consumer checks the pattern so block handed out twice would be noticed
+void test_cuw3_pipeline(uint rounds, uint allocs_per_round) {
+    Channel<Alloc> channel{};
+
+    std::thread consumer([&]() {
+        while (auto alloc_opt = channel.pop()) {
+            auto* bytes = (unsigned char*)alloc_opt->ptr;
+            if (bytes[0] != (unsigned char)alloc_opt->size || bytes[alloc_opt->size - 1] != (unsigned char)alloc_opt->size) {
+                MAKE_AN_ABORTION("allocation was corrupted");
+            }
+            cuw3_free(alloc_opt->ptr, alloc_opt->size);
+        }
+        cuw3_reclaim();
+    });
+
+    std::minstd_rand gen(42);
+    for (uint round = 0; round < rounds; round++) {
+        for (uint i = 0; i < allocs_per_round; i++) {
+            uint64 max_size = i % 3 == 0 ? 1024 : i % 3 == 1 ? (1 << 14) : (1 << 17);
+            uint64 size = gen() % max_size + 1;
+            void* ptr = cuw3_alloc(size, 16);
+            if (!ptr) {
+                MAKE_AN_ABORTION("failed to make allocation");
+            }
+            memset(ptr, (unsigned char)size, size);
+            channel.push({ptr, size});
+        }
+        cuw3_reclaim();
+    }
+    channel.close();
+    consumer.join();
+    cuw3_reclaim();
+}
+
+// usable size must cover the requested size and must not depend on the neighbours being alive
+// every allocation is freed without size: half by the owner, half by another thread
+void test_cuw3_unsized(uint allocs) {
+    std::vector<Alloc> allocations{};
+    std::minstd_rand gen(42);
+    for (uint i = 0; i < allocs; i++) {
+        uint64 max_size = i % 3 == 0 ? 1024 : i % 3 == 1 ? (1 << 14) : (1 << 20);
+        uint64 size = gen() % max_size + 1;
+        void* ptr = cuw3_alloc(size, 16);
+        if (!ptr) {
+            MAKE_AN_ABORTION("failed to make allocation");
+        }
+        allocations.push_back({ptr, size});
+    }
+
+    std::vector<uint64> usable_sizes{};
+    for (auto alloc : allocations) {
+        uint64 usable_size = cuw3_usable_size(alloc.ptr);
+        if (usable_size < alloc.size) {
+            MAKE_AN_ABORTION("usable size is less than requested");
+        }
+        memset(alloc.ptr, 0xff, usable_size);
+        usable_sizes.push_back(usable_size);
+    }
+
+    std::vector<Alloc> remote{};
+    for (uint i = 0; i < allocations.size(); i++) {
+        if (i % 2 == 0) {
+            remote.push_back(allocations[i]);
+            continue;
+        }
+        cuw3_free_unsized(allocations[i].ptr);
+    }
+    for (uint i = 0; i < allocations.size(); i += 2) {
+        if (cuw3_usable_size(allocations[i].ptr) != usable_sizes[i]) {
+            MAKE_AN_ABORTION("usable size changed after neighbour was freed");
+        }
+    }
+
+    std::thread freer([&]() {
+        for (auto alloc : remote) {
+            cuw3_free_unsized(alloc.ptr);
+        }
+        cuw3_reclaim();
+    });
+    freer.join();
+
+    cuw3_free_unsized(nullptr);
+    if (cuw3_usable_size(nullptr) != 0) {
+        MAKE_AN_ABORTION("usable size of null must be zero");
+    }
+    cuw3_reclaim();
+}
+
+// growing buffer that is the last allocation of its arena must not move, contents must survive every move
+void test_cuw3_realloc(uint rounds) {
+    for (uint round = 0; round < rounds; round++) {
+        uint64 size = 2048;
+        auto* bytes = (unsigned char*)cuw3_alloc(size, 16);
+        if (!bytes) {
+            MAKE_AN_ABORTION("failed to make allocation");
+        }
+        memset(bytes, (int)round, size);
+
+        uint64 moves = 0;
+        for (uint64 new_size = size + 4096; new_size <= (1 << 20); new_size += 4096) {
+            auto* new_bytes = (unsigned char*)cuw3_realloc(bytes, size, new_size, 16);
+            if (!new_bytes) {
+                MAKE_AN_ABORTION("failed to realloc");
+            }
+            moves += new_bytes != bytes;
+            for (uint64 i = 0; i < size; i++) {
+                if (new_bytes[i] != (unsigned char)round) {
+                    MAKE_AN_ABORTION("realloc lost data");
+                }
+            }
+            memset(new_bytes, (int)round, new_size);
+            bytes = new_bytes;
+            size = new_size;
+        }
+        if (moves > 2) {
+            MAKE_AN_ABORTION("growing allocation was moved too many times");
+        }
+
+        // slab block keeps its size class only
+        void* block = cuw3_alloc(100, 16);
+        if (!cuw3_try_resize(block, 100, 101) || cuw3_try_resize(block, 101, 4000)) {
+            MAKE_AN_ABORTION("slab block resize is wrong");
+        }
+        cuw3_free(block, 101);
+
+        if (cuw3_realloc(bytes, size, 0, 16)) {
+            MAKE_AN_ABORTION("realloc to zero must free");
+        }
+    }
+
+    // foreign thread cannot move the top of somebody else's arena
+    void* ptr = cuw3_alloc(1 << 16, 16);
+    std::thread([&]() {
+        if (cuw3_try_resize(ptr, 1 << 16, 1 << 17)) {
+            MAKE_AN_ABORTION("non-owner resized arena allocation");
+        }
+        cuw3_free(ptr, 1 << 16);
+        cuw3_reclaim();
+    }).join();
+    cuw3_reclaim();
+}
+
+// alignments above the max arena alignment are served by padding, half is freed by another thread
+void test_cuw3_over_aligned(uint allocs) {
+    std::vector<Alloc> allocations{};
+    std::minstd_rand gen(42);
+    for (uint i = 0; i < allocs; i++) {
+        uint64 alignment = (uint64)8192 << (gen() % 9); // up to 2 MiB
+        uint64 size = gen() % (1 << 17) + 1;
+        void* ptr = cuw3_alloc(size, alignment);
+        if (!ptr) {
+            MAKE_AN_ABORTION("failed to make over-aligned allocation");
+        }
+        if (!is_aligned(ptr, alignment)) {
+            MAKE_AN_ABORTION("over-aligned allocation is misaligned");
+        }
+        if (cuw3_usable_size(ptr) < size) {
+            MAKE_AN_ABORTION("usable size is less than requested");
+        }
+        memset(ptr, 0xff, size);
+        allocations.push_back({ptr, size});
+    }
+
+    std::vector<Alloc> remote{};
+    for (uint i = 0; i < allocations.size(); i++) {
+        if (i % 2 == 0) {
+            remote.push_back(allocations[i]);
+        } else {
+            cuw3_free(allocations[i].ptr, allocations[i].size);
+        }
+    }
+    std::thread([&]() {
+        for (auto alloc : remote) {
+            cuw3_free_unsized(alloc.ptr);
+        }
+        cuw3_reclaim();
+    }).join();
+
+    if (cuw3_alloc(16, (uint64)1 << 40)) {
+        MAKE_AN_ABORTION("alignment above the max chunk size must fail");
+    }
+    cuw3_reclaim();
+}
+
+// allocations above the max chunk size get dedicated spans: freed spans are cached, resize moves pages instead of copying
+void test_cuw3_large(uint rounds) {
+    constexpr uint64 mib = 1 << 20;
+
+    (void)cuw3_purge(~(uint64)0); // drops cached spans of the previous runs
+    for (uint round = 0; round < rounds; round++) {
+        uint64 size = 100 * mib + round;
+        auto* bytes = (unsigned char*)cuw3_alloc(size, 16);
+        if (!bytes) {
+            MAKE_AN_ABORTION("failed to make large allocation");
+        }
+        if (cuw3_usable_size(bytes) < size) {
+            MAKE_AN_ABORTION("usable size is less than requested");
+        }
+        memset(bytes, 0xff, size);
+        cuw3_free(bytes, size);
+
+        // span was just cached, nothing else is
+        auto* reused = (unsigned char*)cuw3_alloc(size, 16);
+        if (reused != bytes) {
+            MAKE_AN_ABORTION("freed span was not reused");
+        }
+        reused[0] = (unsigned char)round;
+        reused[size - 1] = (unsigned char)round;
+
+        // grows in place or moves with its pages
+        uint64 new_size = 300 * mib;
+        auto* grown = (unsigned char*)cuw3_realloc(reused, size, new_size, 16);
+        if (!grown || grown[0] != (unsigned char)round || grown[size - 1] != (unsigned char)round) {
+            MAKE_AN_ABORTION("large realloc lost data");
+        }
+        grown[new_size - 1] = 1;
+
+        if (!cuw3_try_resize(grown, new_size, 80 * mib) || cuw3_usable_size(grown) != 80 * mib) {
+            MAKE_AN_ABORTION("large allocation was not shrunk in place");
+        }
+
+        // freed by another thread
+        std::thread([&]() {
+            cuw3_free_unsized(grown);
+        }).join();
+
+        uint64 alignment = 8 * mib;
+        void* aligned = cuw3_alloc(70 * mib, alignment);
+        if (!aligned || !is_aligned(aligned, alignment)) {
+            MAKE_AN_ABORTION("large aligned allocation is misaligned");
+        }
+        cuw3_free(aligned, 70 * mib);
+    }
+    if (cuw3_purge(~(uint64)0) == 0) {
+        MAKE_AN_ABORTION("cached spans were not released");
+    }
+}
+
+// every arena alignment interleaved, sizes cross both the slab and small allocator cutoffs
+// with alignment-agnostic arenas (CUW3_ALIGNMENT_AGNOSTIC_ARENAS) they all share the same arenas
+void test_cuw3_mixed_aligned(uint allocs) {
+    std::vector<Alloc> allocations{};
+    std::minstd_rand gen(42);
+    for (uint i = 0; i < allocs; i++) {
+        uint64 alignment = (uint64)16 << (gen() % 9); // up to 4 KiB
+        uint64 size = gen() % (1 << 15) + 1;
+        void* ptr = cuw3_alloc(size, alignment);
+        if (!ptr) {
+            MAKE_AN_ABORTION("failed to make an aligned allocation");
+        }
+        if (!is_aligned(ptr, alignment)) {
+            MAKE_AN_ABORTION("aligned allocation is misaligned");
+        }
+        if (cuw3_usable_size(ptr) < size) {
+            MAKE_AN_ABORTION("usable size is less than requested");
+        }
+        memset(ptr, 0xff, size);
+        allocations.push_back({ptr, size});
+    }
+    for (uint i = 0; i < allocations.size(); i += 2) {
+        cuw3_free(allocations[i].ptr, allocations[i].size);
+    }
+    for (uint i = 1; i < allocations.size(); i += 2) {
+        cuw3_free_unsized(allocations[i].ptr);
+    }
+    cuw3_reclaim();
+}
+
+// alignment below the min one is served as min aligned on every path, small thread goes through sub-chunk arenas
+void test_cuw3_under_aligned(uint allocs) {
+    std::thread([&]() {
+        std::vector<Alloc> mem{};
+        std::minstd_rand gen(allocs);
+        for (uint i = 0; i < allocs; i++) {
+            uint64 alignment = 1ull << (i % 4); // 1, 2, 4, 8
+            uint64 size = i % 8 == 0 ? gen() % (1 << 16) + 1 : gen() % 2048 + 1;
+            void* ptr = cuw3_alloc(size, alignment);
+            if (!ptr || !is_aligned(ptr, 16)) {
+                MAKE_AN_ABORTION("failed to make under-aligned allocation");
+            }
+            memset(ptr, 0xff, size);
+            mem.push_back({ptr, size});
+        }
+        for (auto alloc : mem) {
+            cuw3_free(alloc.ptr, alloc.size);
+        }
+        cuw3_reclaim();
+    }).join();
+}
+
+// lots of threads holding a few small allocations each are served by sub-chunk arenas
+// allocations outlive their threads and are freed by the threads of the next wave
+void test_cuw3_many_small_threads(uint threads, uint allocs_per_thread) {
+    std::vector<std::vector<Alloc>> thread_allocs(threads);
+    std::vector<std::thread> workers;
+    for (uint t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&, t]() {
+            std::minstd_rand gen(t);
+            for (uint i = 0; i < allocs_per_thread; i++) {
+                uint64 size = gen() % (1 << 12) + 1;
+                void* ptr = cuw3_alloc(size, 16);
+                if (!ptr) {
+                    MAKE_AN_ABORTION("failed to make an allocation");
+                }
+                memset(ptr, (int)(t & 0xff), size);
+                thread_allocs[t].push_back({ptr, size});
+            }
+            for (uint i = 0; i < allocs_per_thread; i += 2) {
+                cuw3_free(thread_allocs[t][i].ptr, thread_allocs[t][i].size);
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    for (uint t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&, t]() {
+            uint victim = (t + 1) % threads;
+            for (uint i = 1; i < allocs_per_thread; i += 2) {
+                auto alloc = thread_allocs[victim][i];
+                if (cuw3_usable_size(alloc.ptr) < alloc.size) {
+                    MAKE_AN_ABORTION("usable size is less than requested");
+                }
+                for (uint64 byte = 0; byte < alloc.size; byte++) {
+                    if (((unsigned char*)alloc.ptr)[byte] != (victim & 0xff)) {
+                        MAKE_AN_ABORTION("allocation was corrupted");
+                    }
+                }
+                cuw3_free_unsized(alloc.ptr);
+            }
+            cuw3_reclaim();
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    cuw3_reclaim();
+}
+
+// heaps are created and destroyed with allocations still alive, threads outlive some of the heaps they used
+void test_cuw3_heaps(uint threads, uint rounds, uint allocs_per_thread) {
+    constexpr uint64 mib = 1 << 20;
+
+    for (uint round = 0; round < rounds; round++) {
+        cuw3_heap* heaps[2] = {cuw3_heap_create(nullptr), cuw3_heap_create(nullptr)};
+        if (!heaps[0] || !heaps[1]) {
+            MAKE_AN_ABORTION("failed to create heap");
+        }
+
+        std::vector<std::thread> workers;
+        for (uint t = 0; t < threads; t++) {
+            workers.push_back(std::thread([&, t]() {
+                std::minstd_rand gen(t + round);
+                std::vector<Alloc> allocs[2];
+                for (uint i = 0; i < allocs_per_thread; i++) {
+                    uint heap = i % 2;
+                    uint64 size = gen() % (1 << 16) + 1;
+                    void* ptr = cuw3_heap_alloc(heaps[heap], size, 16);
+                    if (!ptr) {
+                        MAKE_AN_ABORTION("failed to make heap allocation");
+                    }
+                    memset(ptr, (int)((t + heap) & 0xff), size);
+                    allocs[heap].push_back({ptr, size});
+                }
+                // half of the allocations are left for the heap destruction
+                for (uint heap = 0; heap < 2; heap++) {
+                    for (usize i = 0; i < allocs[heap].size(); i += 2) {
+                        auto alloc = allocs[heap][i];
+                        if (((unsigned char*)alloc.ptr)[alloc.size - 1] != ((t + heap) & 0xff)) {
+                            MAKE_AN_ABORTION("heap allocation was corrupted");
+                        }
+                        cuw3_heap_free(heaps[heap], alloc.ptr, alloc.size);
+                    }
+                }
+            }));
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        cuw3_heap_destroy(heaps[0]);
+
+        // this thread has not used the heap yet, dead tlas are reused
+        void* ptr = cuw3_heap_alloc(heaps[1], 100, 16);
+        if (!ptr) {
+            MAKE_AN_ABORTION("failed to make heap allocation");
+        }
+        cuw3_heap_free(heaps[1], ptr, 100);
+        cuw3_heap_destroy(heaps[1]);
+    }
+
+    // heap bounded by its regions, more heaps than a thread keeps at once
+    cuw3_heap_config config{};
+    cuw3_heap_default_config(&config);
+    config.region_size_log2 = 30;
+    for (uint round = 0; round < 2 * CUW3_MAX_THREAD_HEAPS; round++) {
+        auto* heap = cuw3_heap_create(&config);
+        if (!heap) {
+            MAKE_AN_ABORTION("failed to create bounded heap");
+        }
+        uint64 allocated = 0;
+        while (void* ptr = cuw3_heap_alloc(heap, 32 * mib, 16)) {
+            ((char*)ptr)[0] = 1;
+            allocated += 32 * mib;
+            if (allocated > 8 * (mib << 10)) {
+                MAKE_AN_ABORTION("bounded heap grew past its regions");
+            }
+        }
+        if (allocated < (mib << 10)) {
+            MAKE_AN_ABORTION("bounded heap is exhausted too early");
+        }
+        cuw3_heap_destroy(heap);
+    }
+}
+
+// batches of every allocator path, freed by the owner in a shuffled order and by another thread
+void test_cuw3_batch(uint rounds) {
+    struct BatchSpec {
+        uint64 size{};
+        uint64 alignment{};
+        uint64 count{};
+    };
+    const BatchSpec specs[] = {
+        {16, 16, 4096},
+        {100, 8, 4096},
+        {3000, 64, 1024},
+        {40000, 16, 256},
+        {300000, 4096, 64},
+        {100 << 20, 16, 2},
+    };
+
+    std::minstd_rand gen(42);
+    for (uint round = 0; round < rounds; round++) {
+        for (auto spec : specs) {
+            std::vector<void*> ptrs(spec.count);
+            if (cuw3_alloc_batch(spec.size, spec.alignment, spec.count, ptrs.data()) != spec.count) {
+                MAKE_AN_ABORTION("failed to allocate batch");
+            }
+            for (uint64 i = 0; i < spec.count; i++) {
+                if (!ptrs[i] || !is_aligned(ptrs[i], spec.alignment)) {
+                    MAKE_AN_ABORTION("batch allocation is invalid");
+                }
+                memset(ptrs[i], (int)(i & 0xff), std::min<uint64>(spec.size, 256));
+                ((unsigned char*)ptrs[i])[spec.size - 1] = (unsigned char)(i & 0xff);
+            }
+            for (uint64 i = 0; i < spec.count; i++) {
+                auto* bytes = (unsigned char*)ptrs[i];
+                if (bytes[0] != (i & 0xff) || bytes[spec.size - 1] != (i & 0xff)) {
+                    MAKE_AN_ABORTION("batch allocations overlap");
+                }
+            }
+
+            // first half by the owner: some one by one, the rest shuffled in a batch with a null in the middle
+            uint64 half = spec.count / 2;
+            std::vector<void*> owned(ptrs.begin(), ptrs.begin() + half);
+            for (uint64 i = 0; i < owned.size(); i += 8) {
+                cuw3_free(owned[i], spec.size);
+                owned[i] = nullptr;
+            }
+            std::shuffle(owned.begin(), owned.end(), gen);
+            std::vector<uint64> sizes(spec.count, spec.size);
+            cuw3_free_batch(owned.data(), sizes.data(), owned.size());
+
+            // second half by another thread
+            std::thread([&]() {
+                cuw3_free_batch(ptrs.data() + half, sizes.data(), spec.count - half);
+            }).join();
+        }
+
+        // slab, small and step-split sizes interleaved in one batch: grouped by their chunk, not by runs
+        std::vector<void*> mixed{};
+        std::vector<uint64> mixed_sizes{};
+        for (uint64 i = 0; i < 1024; i++) {
+            uint64 size = i % 3 == 0 ? 16 : i % 3 == 1 ? 3000 : 40000;
+            void* ptr = cuw3_alloc(size, 16);
+            if (!ptr) {
+                MAKE_AN_ABORTION("failed to make an allocation");
+            }
+            memset(ptr, 0xff, size);
+            mixed.push_back(ptr);
+            mixed_sizes.push_back(size);
+        }
+        cuw3_free_batch(mixed.data(), mixed_sizes.data(), mixed.size());
+        cuw3_reclaim();
+    }
+}
+
+// containers on top of the adapters, nodes and buffers are partly freed by another thread
+void test_cuw3_adapters(uint rounds, uint elems) {
+    auto* resource = cuw3::get_memory_resource();
+    if (!resource->is_equal(cuw3::MemoryResource{}) || resource->is_equal(*std::pmr::new_delete_resource())) {
+        MAKE_AN_ABORTION("memory resource equality is broken");
+    }
+
+    for (uint round = 0; round < rounds; round++) {
+        std::pmr::vector<uint64> pmr_vec{resource};
+        std::pmr::map<uint64, uint64> pmr_map{resource};
+        std::vector<uint64, cuw3::StlAllocator<uint64>> vec;
+        std::unordered_map<uint64, uint64, std::hash<uint64>, std::equal_to<uint64>, cuw3::StlAllocator<std::pair<const uint64, uint64>>> map;
+        for (uint64 i = 0; i < elems; i++) {
+            pmr_vec.push_back(i);
+            pmr_map[i] = i;
+            vec.push_back(i);
+            map[i] = i;
+        }
+
+        // over-aligned request goes through the resource as is
+        void* aligned = resource->allocate(100, 4096);
+        if (!is_aligned(aligned, 4096)) {
+            MAKE_AN_ABORTION("memory resource ignored alignment");
+        }
+
+        std::thread([&]() {
+            for (uint64 i = 0; i < elems; i += 2) {
+                pmr_map.erase(i);
+                map.erase(i);
+            }
+            resource->deallocate(aligned, 100, 4096);
+        }).join();
+
+        for (uint64 i = 0; i < elems; i++) {
+            if (pmr_vec[i] != i || vec[i] != i) {
+                MAKE_AN_ABORTION("vector was corrupted");
+            }
+            if ((pmr_map.count(i) != 0) != (i % 2 != 0) || (map.count(i) != 0) != (i % 2 != 0)) {
+                MAKE_AN_ABORTION("map was corrupted");
+            }
+        }
+    }
+
+    bool thrown = false;
+    try {
+        (void)resource->allocate(1ull << 62, 16);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    if (!thrown) {
+        MAKE_AN_ABORTION("memory resource must throw on failure");
+    }
+}
+
+// inline fast path must agree with the library path: same tcache, pointers freely mixed between both and between threads
+void test_cuw3_fast_path(uint rounds, uint allocs) {
+    // small thread serves slab sizes from its arenas, ballast makes it take slab chunks so the tcache gets involved
+    std::vector<Alloc> ballast{};
+    for (uint i = 0; i < 1024; i++) {
+        ballast.push_back({cuw3::alloc_inline(1024, 16), 1024});
+    }
+#if CUW3_INLINE_FAST_PATH
+    if (!cuw3::fast_path_tla || !cuw3::fast_path_allocator) {
+        MAKE_AN_ABORTION("fast path was not set up");
+    }
+#endif
+
+    for (uint64 alloc_size = 16; alloc_size <= 1024; alloc_size += 16) {
+        void* ptr = cuw3::alloc_inline(alloc_size, 16);
+        if (!ptr) {
+            MAKE_AN_ABORTION("failed to make an allocation");
+        }
+        for (uint round = 0; round < rounds; round++) {
+            cuw3::free_inline(ptr, alloc_size);
+            void* reused = cuw3::alloc_inline(alloc_size, 16);
+            if (reused != ptr) {
+                MAKE_AN_ABORTION("block was not reused");
+            }
+        }
+        cuw3_free(ptr, alloc_size);
+        if (cuw3_alloc(alloc_size, 16) != ptr) {
+            MAKE_AN_ABORTION("block was not reused");
+        }
+        cuw3::free_inline(ptr, alloc_size);
+    }
+#if CUW3_INLINE_FAST_PATH
+    // every free counts for both cleanup cadences, inline or not
+    auto* tla = cuw3::fast_path_tla;
+    uint64 this_cleanup_counter = tla->this_cleanup_counter;
+    uint64 grave_cleanup_counter = tla->grave_cleanup_counter;
+#endif
+    for (auto alloc : ballast) {
+        cuw3::free_inline(alloc.ptr, alloc.size);
+    }
+#if CUW3_INLINE_FAST_PATH
+    if (tla->this_cleanup_counter - this_cleanup_counter != ballast.size() || tla->grave_cleanup_counter - grave_cleanup_counter != ballast.size()) {
+        MAKE_AN_ABORTION("inline frees skipped cleanup cadence");
+    }
+#endif
+
+    auto fill = [&](std::vector<Alloc>& mem, uint seed) {
+        std::minstd_rand gen(seed);
+        for (uint i = 0; i < allocs; i++) {
+            // large and over-aligned ones never hit the cache
+            uint64 alloc_size = i % 64 == 0 ? (1 << 20) : gen() % 2048;
+            uint64 alignment = i % 32 == 0 ? 256 : 16;
+            void* ptr = cuw3::alloc_inline(alloc_size, alignment);
+            if (!ptr || !is_aligned(ptr, alignment)) {
+                MAKE_AN_ABORTION("failed to make an allocation");
+            }
+            memset(ptr, 0xff, alloc_size);
+            mem.push_back({ptr, alloc_size});
+        }
+    };
+
+    for (uint round = 0; round < rounds; round++) {
+        std::vector<Alloc> local{};
+        std::vector<Alloc> remote{};
+        fill(local, round);
+
+        // fresh thread: first frees go the full path as thread has no tla yet, its own memory goes through the tcache
+        std::thread([&]() {
+            fill(remote, round + rounds);
+            for (uint i = 0; i < local.size(); i += 2) {
+                cuw3::free_inline(local[i].ptr, local[i].size);
+            }
+            for (uint i = 1; i < remote.size(); i += 2) {
+                cuw3::free_inline(remote[i].ptr, remote[i].size);
+            }
+        }).join();
+
+        for (uint i = 1; i < local.size(); i += 2) {
+            cuw3::free_inline(local[i].ptr, local[i].size);
+        }
+        for (uint i = 0; i < remote.size(); i += 2) {
+            cuw3::free_inline(remote[i].ptr, remote[i].size);
+        }
+    }
+    cuw3_reclaim();
+}
+
+// arena spans many chunks, rewound chunks are reused, earlier allocations survive everything above the mark
+void test_cuw3_arena(uint rounds, uint allocs) {
+    constexpr uint64 mib = 1 << 20;
+
+    for (uint round = 0; round < rounds; round++) {
+        auto* arena = cuw3_arena_create(0);
+        if (!arena) {
+            MAKE_AN_ABORTION("failed to create arena");
+        }
+
+        std::minstd_rand gen(round);
+        std::vector<Alloc> below;
+        for (uint i = 0; i < allocs; i++) {
+            uint64 size = gen() % 512 + 1;
+            void* ptr = cuw3_arena_alloc(arena, size, 16);
+            if (!ptr || !is_aligned(ptr, 16)) {
+                MAKE_AN_ABORTION("failed to make arena allocation");
+            }
+            memset(ptr, (int)(i & 0xff), size);
+            below.push_back({ptr, size});
+        }
+
+        void* mark = cuw3_arena_mark(arena);
+        for (uint pass = 0; pass < 2; pass++) {
+            // way more than the first chunk, over-aligned ones in between
+            uint64 total = 0;
+            for (uint i = 0; total < 64 * mib; i++) {
+                uint64 size = gen() % (1 << 16) + 1;
+                uint64 alignment = i % 16 ? 8 : 4096;
+                void* ptr = cuw3_arena_alloc(arena, size, alignment);
+                if (!ptr || !is_aligned(ptr, alignment)) {
+                    MAKE_AN_ABORTION("failed to make arena allocation above the mark");
+                }
+                memset(ptr, 0xcd, size);
+                total += size;
+            }
+            // way above the max alignment of the allocator, fits only with the padding
+            for (uint64 alignment : {mib / 16, mib, 4 * mib}) {
+                void* ptr = cuw3_arena_alloc(arena, 4096, alignment);
+                if (!ptr || !is_aligned(ptr, alignment)) {
+                    MAKE_AN_ABORTION("failed to make over-aligned arena allocation");
+                }
+                memset(ptr, 0xcd, 4096);
+            }
+            if (cuw3_arena_alloc(arena, 1ull << 40, 16)) {
+                MAKE_AN_ABORTION("arena allocation must not exceed the max chunk size");
+            }
+
+            cuw3_arena_rewind(arena, mark);
+            if (cuw3_arena_mark(arena) != mark) {
+                MAKE_AN_ABORTION("arena was not rewound to the mark");
+            }
+            void* ptr = cuw3_arena_alloc(arena, 16, 16);
+            if (ptr != align(mark, 16)) {
+                MAKE_AN_ABORTION("allocation after rewind must start at the mark");
+            }
+        }
+
+        for (usize i = 0; i < below.size(); i++) {
+            auto alloc = below[i];
+            if (((unsigned char*)alloc.ptr)[0] != (i & 0xff) || ((unsigned char*)alloc.ptr)[alloc.size - 1] != (i & 0xff)) {
+                MAKE_AN_ABORTION("arena allocation below the mark was corrupted");
+            }
+        }
+        cuw3_arena_release(arena);
+    }
+
+    if (cuw3_arena_alloc(nullptr, 16, 16) || cuw3_arena_mark(nullptr)) {
+        MAKE_AN_ABORTION("null arena must be rejected");
+    }
+    cuw3_arena_rewind(nullptr, nullptr);
+    cuw3_arena_release(nullptr);
+}
+
 void test_allocation_chaos(uint st, uint spam, uint cross) {
     uint total = st + spam + cross;
 
@@ -318,6 +1060,10 @@ TEST(Cuw3, StMini) {
     }
 }
 
+TEST(Cuw3, TcacheReuse) {
+    test_cuw3_tcache_reuse(16);
+}
+
 TEST(Cuw3, MtSpam) {
     for (int i = 0; i < 10; i++) {
         test_cuw3_mt_spam(128, 8, 64);
@@ -330,6 +1076,62 @@ TEST(Cuw3, MtCross) {
     }    
 }
 
+TEST(Cuw3, Pipeline) {
+    test_cuw3_pipeline(64, 1024);
+}
+
+TEST(Cuw3, Unsized) {
+    test_cuw3_unsized(4096);
+}
+
+TEST(Cuw3, Realloc) {
+    test_cuw3_realloc(16);
+}
+
+TEST(Cuw3, Large) {
+    test_cuw3_large(8);
+}
+
+TEST(Cuw3, OverAligned) {
+    test_cuw3_over_aligned(1024);
+}
+
+TEST(Cuw3, MixedAligned) {
+    for (int i = 0; i < 16; i++) {
+        test_cuw3_mixed_aligned(4096);
+    }
+}
+
+TEST(Cuw3, UnderAligned) {
+    test_cuw3_under_aligned(256);
+}
+
+TEST(Cuw3, ManySmallThreads) {
+    for (int i = 0; i < 4; i++) {
+        test_cuw3_many_small_threads(256, 64);
+    }
+}
+
+TEST(Cuw3, Heaps) {
+    test_cuw3_heaps(8, 4, 1024);
+}
+
+TEST(Cuw3, Batch) {
+    test_cuw3_batch(4);
+}
+
+TEST(Cuw3, Adapters) {
+    test_cuw3_adapters(4, 1 << 14);
+}
+
+TEST(Cuw3, FastPath) {
+    test_cuw3_fast_path(4, 4096);
+}
+
+TEST(Cuw3, Arena) {
+    test_cuw3_arena(4, 4096);
+}
+
 TEST(Cuw3, Chaos_2_0_0) {
     test_allocation_chaos(2, 0, 0);
 }
@@ -285,6 +285,216 @@ namespace fast_arena_tests {
     };
 
 
+    // allocation size must be recoverable from the end map at any moment, map must be zeroed on reset
+    void test_arena_end_map(uint desired_alignment, uint rounds) {
+        uint64 alignment = FastArenaUnit::adjust_alignment(desired_alignment);
+        uint64 memory_size = 4 * fast_arena_end_map_summary_word_span;
+        auto vmem_ptr = FastArenaUnit::create_vmem_ptr(alignment, memory_size);
+
+        std::vector<uint64> end_map(memory_size / fast_arena_end_map_word_span);
+        std::vector<uint64> end_map_summary(memory_size / fast_arena_end_map_summary_word_span);
+
+        FastArena arena{};
+        FastArenaConfig config{};
+        config.owner = &dummy_owner;
+        config.arena_memory = vmem_ptr.get();
+        config.arena_memory_size = memory_size;
+        config.arena_alignment = alignment;
+        config.end_map = end_map.data();
+        config.end_map_summary = end_map_summary.data();
+        CUW3_CHECK(FastArenaView::create(Memory::from(&arena), config), "failed to create arena");
+
+        auto view = FastArenaView{&arena};
+        std::minstd_rand gen{42};
+        for (uint round = 0; round < rounds; round++) {
+            std::vector<FastArenaAllocation> allocations{};
+            while (true) {
+                // mix of tiny allocations and ones spanning several map words
+                uint64 size = gen() % 2 ? gen() % (4 * alignment) + 1 : gen() % (2 * fast_arena_end_map_summary_word_span) + 1;
+                void* memory = view.acquire(size);
+                if (!memory) {
+                    break;
+                }
+                allocations.push_back({memory, align(size, alignment)});
+            }
+            if (uint64 remaining = view.remaining()) {
+                allocations.push_back({view.acquire(remaining), remaining}); // last one spans up to the arena end
+            }
+
+            shuffle(allocations);
+            for (auto allocation : allocations) {
+                CUW3_CHECK(view.allocation_size(allocation.memory) == allocation.size, "allocation size mismatch");
+                view.release(allocation.memory, view.allocation_size(allocation.memory));
+            }
+            CUW3_CHECK(view.resettable(), "arena must have been resettable");
+            view.reset();
+
+            CUW3_CHECK(std::all_of(end_map.begin(), end_map.end(), [](uint64 word) { return word == 0; }), "end map was not cleared");
+            CUW3_CHECK(std::all_of(end_map_summary.begin(), end_map_summary.end(), [](uint64 word) { return word == 0; }), "end map summary was not cleared");
+        }
+    }
+
+    // only the last allocation can be resized, end map must follow the top
+    void test_arena_resize(uint desired_alignment) {
+        uint64 alignment = FastArenaUnit::adjust_alignment(desired_alignment);
+        uint64 memory_size = 2 * fast_arena_end_map_summary_word_span;
+        auto vmem_ptr = FastArenaUnit::create_vmem_ptr(alignment, memory_size);
+
+        std::vector<uint64> end_map(memory_size / fast_arena_end_map_word_span);
+        std::vector<uint64> end_map_summary(memory_size / fast_arena_end_map_summary_word_span);
+
+        FastArena arena{};
+        FastArenaConfig config{};
+        config.owner = &dummy_owner;
+        config.arena_memory = vmem_ptr.get();
+        config.arena_memory_size = memory_size;
+        config.arena_alignment = alignment;
+        config.end_map = end_map.data();
+        config.end_map_summary = end_map_summary.data();
+        CUW3_CHECK(FastArenaView::create(Memory::from(&arena), config), "failed to create arena");
+
+        auto view = FastArenaView{&arena};
+        void* first = view.acquire(alignment);
+        void* last = view.acquire(alignment);
+        CUW3_CHECK(!view.can_resize(first, alignment, 2 * alignment), "only the last allocation can be resized");
+        CUW3_CHECK(view.can_resize(last, alignment, 2 * alignment), "last allocation must be resizable");
+
+        // grow across several map words, shrink back, grow up to the arena end
+        uint64 last_offset = alignment;
+        uint64 size = alignment;
+        for (uint64 new_size : {3 * alignment, fast_arena_end_map_summary_word_span + alignment, alignment, memory_size - last_offset}) {
+            bool resized = view.resize(last, size, new_size);
+            CUW3_CHECK(resized, "failed to resize");
+            size = new_size;
+            CUW3_CHECK(view.remaining() == memory_size - last_offset - size, "top was not moved");
+            CUW3_CHECK(view.allocation_size(last) == size, "end map was not updated");
+            CUW3_CHECK(view.allocation_size(first) == alignment, "neighbour was affected");
+        }
+        CUW3_CHECK(!view.can_resize(last, size, size + alignment), "resize past the arena end");
+
+        bool resized = view.resize(last, size, alignment);
+        CUW3_CHECK(resized, "failed to shrink");
+        void* next = view.acquire(alignment);
+        CUW3_CHECK(next == advance_ptr(last, alignment), "shrunk space must be reused");
+        CUW3_CHECK(view.allocation_size(last) == alignment, "stale end mark left behind");
+
+        view.release(first, alignment);
+        view.release(last, alignment);
+        view.release(next, alignment);
+        view.reset();
+        CUW3_CHECK(std::all_of(end_map.begin(), end_map.end(), [](uint64 word) { return word == 0; }), "end map was not cleared");
+        CUW3_CHECK(std::all_of(end_map_summary.begin(), end_map_summary.end(), [](uint64 word) { return word == 0; }), "end map summary was not cleared");
+    }
+
+    // padding goes into freed: arena must become resettable once real allocations are gone
+    void test_arena_padded(uint desired_alignment, uint rounds) {
+        uint64 alignment = FastArenaUnit::adjust_alignment(desired_alignment);
+        uint64 memory_size = 4 * fast_arena_end_map_summary_word_span;
+        auto vmem_ptr = FastArenaUnit::create_vmem_ptr(alignment, memory_size);
+
+        std::vector<uint64> end_map(memory_size / fast_arena_end_map_word_span);
+        std::vector<uint64> end_map_summary(memory_size / fast_arena_end_map_summary_word_span);
+
+        FastArena arena{};
+        FastArenaConfig config{};
+        config.owner = &dummy_owner;
+        config.arena_memory = vmem_ptr.get();
+        config.arena_memory_size = memory_size;
+        config.arena_alignment = alignment;
+        config.end_map = end_map.data();
+        config.end_map_summary = end_map_summary.data();
+        CUW3_CHECK(FastArenaView::create(Memory::from(&arena), config), "failed to create arena");
+
+        auto view = FastArenaView{&arena};
+        std::minstd_rand gen{42};
+        for (uint round = 0; round < rounds; round++) {
+            std::vector<FastArenaAllocation> allocations{};
+            while (true) {
+                uint64 size = gen() % (4 * alignment) + 1;
+                uint64 padded_alignment = alignment << (gen() % 6);
+                uint64 padding = view.padding(padded_alignment);
+                void* memory = view.acquire_padded(size, padded_alignment);
+                if (!memory) {
+                    CUW3_CHECK(view.remaining() < padding + align(size, alignment), "padded allocation must have fit");
+                    break;
+                }
+                CUW3_CHECK(is_aligned(memory, padded_alignment), "padded allocation is misaligned");
+                allocations.push_back({memory, size});
+            }
+
+            shuffle(allocations);
+            for (auto allocation : allocations) {
+                CUW3_CHECK(view.allocation_size(allocation.memory) == align(allocation.size, alignment), "padding leaked into allocation size");
+                CUW3_CHECK(!view.resettable(), "arena became resettable too early");
+                view.release(allocation.memory, allocation.size);
+            }
+            CUW3_CHECK(view.resettable(), "arena must have been resettable");
+            view.reset();
+        }
+    }
+
+    // arena memory is only reserved: everything handed out must be accessible, reset gives back steps above the top
+    void test_arena_incremental_commit(uint rounds) {
+        if (!conf_arena_commit_step) {
+            return;
+        }
+
+        uint64 alignment = conf_min_alloc_alignment;
+        uint64 memory_size = 4 * conf_arena_commit_step;
+        void* arena_memory = vmem_alloc(memory_size, VMemAllocType::VMemReserve);
+        CUW3_CHECK(arena_memory, "failed to reserve memory");
+        auto vmem_ptr = VMemPtr{arena_memory, {memory_size}};
+
+        FastArena arena{};
+        FastArenaConfig config{};
+        config.owner = &dummy_owner;
+        config.arena_memory = vmem_ptr.get();
+        config.arena_memory_size = memory_size;
+        config.arena_alignment = alignment;
+        config.incremental_commit = true;
+        CUW3_CHECK(FastArenaView::create(Memory::from(&arena), config), "failed to create arena");
+
+        auto view = FastArenaView{&arena};
+        CUW3_CHECK(view.committed() == 0, "nothing must be committed up front");
+
+        std::minstd_rand gen{42};
+        for (uint round = 0; round < rounds; round++) {
+            // every other round uses only a fraction of the arena so reset has something to give back
+            uint64 budget = round % 2 ? gen() % conf_arena_commit_step + 1 : memory_size;
+            std::vector<FastArenaAllocation> allocations{};
+            while (memory_size - view.remaining() < budget) {
+                uint64 size = gen() % (conf_arena_commit_step / 2) + 1;
+                void* memory = view.acquire(size);
+                if (!memory) {
+                    break;
+                }
+                std::memset(memory, 0xCD, size); // must not fault
+                allocations.push_back({memory, size});
+
+                uint64 top = memory_size - view.remaining();
+                CUW3_CHECK(view.committed() >= top && view.committed() == std::min(align(view.committed(), conf_arena_commit_step), memory_size), "commit must cover the top in whole steps");
+            }
+
+            // grow the last allocation across the step boundary
+            auto& last = allocations.back();
+            uint64 new_size = std::min(last.size + conf_arena_commit_step, align(last.size, alignment) + view.remaining());
+            if (view.can_resize(last.memory, last.size, new_size)) {
+                bool resized = view.resize(last.memory, last.size, new_size);
+                CUW3_CHECK(resized, "failed to resize");
+                std::memset(last.memory, 0xCD, new_size);
+                last.size = new_size;
+            }
+
+            uint64 top = memory_size - view.remaining();
+            for (auto allocation : allocations) {
+                view.release(allocation.memory, allocation.size);
+            }
+            CUW3_CHECK(view.resettable(), "arena must have been resettable");
+            view.reset();
+            CUW3_CHECK(view.committed() == std::min(align(top, conf_arena_commit_step), memory_size), "steps above the top must have been decommitted");
+        }
+    }
+
     void test_arena_partial_exaustion1(uint desired_alignment) {
         uint alignment = FastArenaUnit::adjust_alignment(desired_alignment);
         uint memory_size = FastArenaUnit::adjust_memory_size(alignment, 2 * (1 + 2 + 3 + 4) * alignment);
@@ -1111,6 +1321,28 @@ TEST(FastArena, FullExaustion) {
     fast_arena_tests::test_arena_full_exaustion(64, 1 << 16);
 }
 
+TEST(FastArena, EndMap) {
+    for (uint alignment = 1; alignment <= 1024; alignment *= 2) {
+        fast_arena_tests::test_arena_end_map(alignment, 16);
+    }
+}
+
+TEST(FastArena, Resize) {
+    for (uint alignment = 1; alignment <= 1024; alignment *= 2) {
+        fast_arena_tests::test_arena_resize(alignment);
+    }
+}
+
+TEST(FastArena, Padded) {
+    for (uint alignment = 1; alignment <= 1024; alignment *= 2) {
+        fast_arena_tests::test_arena_padded(alignment, 16);
+    }
+}
+
+TEST(FastArena, IncrementalCommit) {
+    fast_arena_tests::test_arena_incremental_commit(16);
+}
+
 TEST(FastArena, PartialExaustion1) {
     fast_arena_tests::test_arena_partial_exaustion1(64);
 }
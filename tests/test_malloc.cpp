@@ -0,0 +1,225 @@
+#include <cuw3/cuw3.hpp>
+
+#include "tests_common.hpp"
+
+#include <new>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <malloc.h>
+
+#include <gtest/gtest.h>
+
+// this binary is linked against cuw3_malloc so the whole process (gtest included) runs on top of it
+
+using namespace cuw3;
+
+namespace malloc_tests {
+    struct alignas(256) OverAligned {
+        std::byte data[256];
+    };
+
+    // pointer must be owned by cuw3: foreign pointer would abort in cuw3_usable_size()
+    void check_cuw3_owned(void* ptr, uint64 size) {
+        CUW3_CHECK(ptr, "allocation failed");
+        CUW3_CHECK(cuw3_usable_size(ptr) >= size, "allocation is not owned by cuw3");
+        CUW3_CHECK(malloc_usable_size(ptr) == cuw3_usable_size(ptr), "usable size mismatch");
+    }
+
+    void test_malloc_basic() {
+        for (uint64 size = 0; size <= (1 << 20); size = size ? size * 2 : 1) {
+            void* ptr = malloc(size);
+            check_cuw3_owned(ptr, size);
+            CUW3_CHECK(is_aligned(ptr, 16), "malloc must be aligned to 16");
+            memset(ptr, 0xff, size);
+            free(ptr);
+        }
+        free(nullptr);
+        CUW3_CHECK(malloc_usable_size(nullptr) == 0, "usable size of null must be zero");
+    }
+
+    void test_malloc_calloc(uint rounds) {
+        for (uint round = 0; round < rounds; round++) {
+            uint64 count = 1 + round % 64;
+            void* dirty = malloc(count * 24);
+            memset(dirty, 0xff, count * 24);
+            free(dirty);
+
+            auto* bytes = (unsigned char*)calloc(count, 24);
+            check_cuw3_owned(bytes, count * 24);
+            for (uint64 i = 0; i < count * 24; i++) {
+                CUW3_CHECK(bytes[i] == 0, "calloc memory was not zeroed");
+            }
+            free(bytes);
+        }
+
+        volatile size_t huge_count = ~(size_t)0 / 2; // hides overflow from the compiler
+        errno = 0;
+        CUW3_CHECK(!calloc(huge_count, 4), "calloc overflow must fail");
+        CUW3_CHECK(errno == ENOMEM, "errno must be set");
+    }
+
+    void test_malloc_realloc() {
+        auto* bytes = (unsigned char*)realloc(nullptr, 16);
+        check_cuw3_owned(bytes, 16);
+        for (uint64 i = 0; i < 16; i++) {
+            bytes[i] = (unsigned char)i;
+        }
+
+        uint64 size = 16;
+        for (uint64 new_size = 32; new_size <= (1 << 20); new_size *= 4) {
+            bytes = (unsigned char*)realloc(bytes, new_size);
+            check_cuw3_owned(bytes, new_size);
+            for (uint64 i = 0; i < size; i++) {
+                CUW3_CHECK(bytes[i] == (unsigned char)i, "realloc lost data");
+            }
+            for (uint64 i = size; i < new_size; i++) {
+                bytes[i] = (unsigned char)i;
+            }
+            size = new_size;
+        }
+
+        bytes = (unsigned char*)realloc(bytes, 100);
+        check_cuw3_owned(bytes, 100);
+        for (uint64 i = 0; i < 100; i++) {
+            CUW3_CHECK(bytes[i] == (unsigned char)i, "shrinking realloc lost data");
+        }
+        CUW3_CHECK(!realloc(bytes, 0), "realloc to zero frees");
+
+        // above the max chunk size: dedicated span that is moved instead of copied
+        uint64 large_size = 100 << 20;
+        bytes = (unsigned char*)malloc(large_size);
+        check_cuw3_owned(bytes, large_size);
+        bytes[0] = 1;
+        bytes[large_size - 1] = 2;
+        bytes = (unsigned char*)realloc(bytes, 3 * large_size);
+        check_cuw3_owned(bytes, 3 * large_size);
+        CUW3_CHECK(bytes[0] == 1 && bytes[large_size - 1] == 2, "large realloc lost data");
+        free(bytes);
+    }
+
+    void test_malloc_aligned() {
+        for (uint64 alignment = 1; alignment <= 4096; alignment *= 2) {
+            for (uint64 size : {1, 100, 5000, 100000}) {
+                void* ptr = aligned_alloc(alignment, size);
+                check_cuw3_owned(ptr, size);
+                CUW3_CHECK(is_aligned(ptr, alignment), "aligned_alloc is misaligned");
+                free(ptr);
+
+                ptr = memalign(alignment, size);
+                check_cuw3_owned(ptr, size);
+                CUW3_CHECK(is_aligned(ptr, alignment), "memalign is misaligned");
+                free(ptr);
+
+                if (alignment >= sizeof(void*)) {
+                    void* memptr{};
+                    CUW3_CHECK(posix_memalign(&memptr, alignment, size) == 0, "posix_memalign failed");
+                    check_cuw3_owned(memptr, size);
+                    CUW3_CHECK(is_aligned(memptr, alignment), "posix_memalign is misaligned");
+                    free(memptr);
+                }
+            }
+        }
+
+        void* memptr{};
+        CUW3_CHECK(posix_memalign(&memptr, 24, 16) == EINVAL, "invalid alignment must be rejected");
+        CUW3_CHECK(posix_memalign(&memptr, 4, 16) == EINVAL, "alignment less than pointer must be rejected");
+
+        void* page = valloc(100);
+        check_cuw3_owned(page, 100);
+        CUW3_CHECK(is_aligned(page, 4096), "valloc is misaligned");
+        free(page);
+    }
+
+    void test_malloc_new_delete() {
+        auto* value = new uint64{42};
+        check_cuw3_owned(value, sizeof(uint64));
+        delete value;
+
+        auto* array = new uint64[1000]{};
+        check_cuw3_owned(array, 1000 * sizeof(uint64));
+        delete[] array;
+
+        auto* over_aligned = new OverAligned{};
+        check_cuw3_owned(over_aligned, sizeof(OverAligned));
+        CUW3_CHECK(is_aligned(over_aligned, alignof(OverAligned)), "aligned new is misaligned");
+        delete over_aligned;
+
+        auto* over_aligned_array = new OverAligned[7]{};
+        CUW3_CHECK(is_aligned(over_aligned_array, alignof(OverAligned)), "aligned new[] is misaligned");
+        delete[] over_aligned_array;
+
+        auto* nothrow = new (std::nothrow) uint64[16];
+        check_cuw3_owned(nothrow, 16 * sizeof(uint64));
+        delete[] nothrow;
+
+        // malloc and new share the same free path for unsized delete
+        void* raw = ::operator new(777);
+        ::operator delete(raw);
+    }
+
+    // containers, strings and cross-thread frees through plain free()
+    void test_malloc_mt(uint threads, uint allocs) {
+        std::vector<std::vector<void*>> produced(threads);
+        std::vector<std::thread> workers{};
+        for (uint thread = 0; thread < threads; thread++) {
+            workers.emplace_back([&, thread]() {
+                std::minstd_rand gen(thread);
+                std::vector<std::string> strings{};
+                for (uint i = 0; i < allocs; i++) {
+                    void* ptr = malloc(gen() % 20000 + 1);
+                    CUW3_CHECK(ptr, "malloc failed");
+                    produced[thread].push_back(ptr);
+                    strings.push_back(std::string(gen() % 200, 'x'));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+
+        // every thread frees allocations of its neighbour
+        for (uint thread = 0; thread < threads; thread++) {
+            workers.emplace_back([&, thread]() {
+                for (void* ptr : produced[(thread + 1) % threads]) {
+                    free(ptr);
+                }
+                cuw3_reclaim();
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+}
+
+
+TEST(Malloc, Basic) {
+    malloc_tests::test_malloc_basic();
+}
+
+TEST(Malloc, Calloc) {
+    malloc_tests::test_malloc_calloc(256);
+}
+
+TEST(Malloc, Realloc) {
+    malloc_tests::test_malloc_realloc();
+}
+
+TEST(Malloc, Aligned) {
+    malloc_tests::test_malloc_aligned();
+}
+
+TEST(Malloc, NewDelete) {
+    malloc_tests::test_malloc_new_delete();
+}
+
+TEST(Malloc, Mt) {
+    malloc_tests::test_malloc_mt(8, 4096);
+}
@@ -1,7 +1,9 @@
 #include "cuw3/conf.hpp"
+#include "cuw3/region_chunk_cache.hpp"
 #include "cuw3/region_chunk_allocator.hpp"
 
 #include <vector>
+#include <algorithm>
 #include <barrier>
 
 #include "tests_common.hpp"
@@ -208,6 +210,14 @@ struct TestRegionChunkAllocator {
         allocator.deallocate_chunk(allocation);
     }
 
+    [[nodiscard]] uint32 allocate_chunks(uint32 region, uint32 split_start, uint32 count, RegionChunkAllocation* allocations) {
+        RegionChunkAllocParams alloc_params{};
+        alloc_params.rounds = 4;
+        alloc_params.attempts = 4;
+        alloc_params.split_start = split_start;
+        return allocator.allocate_chunks(region, count, alloc_params, allocations);
+    }
+
     uint32 get_num_regions() const {
         return specs.num_regions;
     }
@@ -330,6 +340,616 @@ void test_region_allocator_mt(uint threads, uint rounds) {
     }
 }
 
+// batches are taken with a single cas/bump per split and released as chains, every chunk must be handed out exactly once
+// odd threads allocate chunk by chunk so both paths race on the same pools
+void test_region_allocator_batched_mt(uint threads, uint rounds, uint batch_size) {
+    TestRegionChunkAllocator allocator{};
+
+    std::vector<TestRegionChunkAllocatorCache<std::vector<RegionChunkAllocation>>> thread_allocations(threads);
+
+    auto check_all_allocated = [&] () {
+        for (uint32 region = 0; region < allocator.get_num_regions(); region++) {
+            std::vector<uint32> handles{};
+            for (auto& allocations : thread_allocations) {
+                for (auto allocation : allocations[region]) {
+                    handles.push_back(allocation.handle);
+                }
+            }
+            std::sort(handles.begin(), handles.end());
+            CUW3_CHECK(handles.size() == allocator.specs.region_specs[region].num_handles, "failed to allocate all chunks");
+            CUW3_CHECK(std::adjacent_find(handles.begin(), handles.end()) == handles.end(), "chunk was allocated twice");
+        }
+    };
+
+    std::barrier all_allocated{threads, check_all_allocated};
+    std::barrier all_deallocated{threads};
+
+    std::vector<std::thread> workers(threads);
+    for (uint thread_id = 0; thread_id < threads; thread_id++) {
+        workers[thread_id] = std::thread([&, thread_id, rounds, batch_size](){
+            auto& allocations = thread_allocations[thread_id];
+            std::vector<RegionChunkAllocation> batch(batch_size);
+
+            for (uint round = 0; round < rounds; round++) {
+                for (auto& region_allocations : allocations.data) {
+                    region_allocations.clear();
+                }
+
+                all_deallocated.arrive_and_wait();
+
+                for (uint32 region = 0; region < allocator.get_num_regions(); region++) {
+                    uint32 split = thread_id;
+                    while (true) {
+                        if (thread_id % 2) {
+                            auto allocation = allocator.allocate_chunk(region, split);
+                            if (!allocation) {
+                                break;
+                            }
+                            allocations[region].push_back(allocation);
+                            continue;
+                        }
+
+                        uint32 allocated = allocator.allocate_chunks(region, split, batch_size, batch.data());
+                        if (!allocated) {
+                            break;
+                        }
+                        CUW3_CHECK(allocated <= batch_size, "too many chunks allocated");
+                        allocations[region].insert(allocations[region].end(), batch.begin(), batch.begin() + allocated);
+                        split = batch[0].split;
+                    }
+                }
+
+                all_allocated.arrive_and_wait();
+
+                // shuffled chains mix pools so they are split into runs
+                for (uint32 region = 0; region < allocator.get_num_regions(); region++) {
+                    auto& region_allocations = allocations[region];
+                    shuffle(region_allocations);
+                    for (usize first = 0; first < region_allocations.size(); first += batch_size) {
+                        usize count = std::min<usize>(batch_size, region_allocations.size() - first);
+                        allocator.allocator.deallocate_chunk_chain(region_allocations.data() + first, count);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// all threads start from the same split and churn single chunks so pool free lists get contended
+// cas failures reported to the threads are a subset of the ones counted by the pools (pushes are counted only by the pools)
+void test_region_allocator_contention_mt(uint threads, uint rounds) {
+    TestRegionChunkAllocator allocator{};
+
+    std::vector<uint64> reported(threads);
+    std::barrier start{threads};
+
+    std::vector<std::thread> workers(threads);
+    for (uint thread_id = 0; thread_id < threads; thread_id++) {
+        workers[thread_id] = std::thread([&, thread_id, rounds](){
+            uint32 cas_failures = 0;
+            RegionChunkAllocParams alloc_params{};
+            alloc_params.rounds = 4;
+            alloc_params.attempts = -1;
+            alloc_params.cas_failures = &cas_failures;
+
+            start.arrive_and_wait();
+
+            for (uint round = 0; round < rounds; round++) {
+                auto allocation = allocator.allocator.allocate_chunk(0, alloc_params);
+                CUW3_CHECK(allocation, "failed to allocate chunk");
+                allocator.deallocate_chunk(allocation);
+            }
+            reported[thread_id] = cas_failures;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    uint64 total_reported = 0;
+    for (auto failures : reported) {
+        total_reported += failures;
+    }
+    uint64 total_counted = 0;
+    for (uint32 region = 0; region < allocator.get_num_regions(); region++) {
+        for (uint32 split = 0; split < allocator.allocator.num_pool_splits(); split++) {
+            uint64 failures = allocator.allocator.pool_cas_failures(region, split);
+            CUW3_CHECK(region == 0 || failures == 0, "cas failures counted for untouched region");
+            total_counted += failures;
+        }
+    }
+    CUW3_CHECK(total_reported <= total_counted, "pools lost cas failures");
+}
+
+// segments are reserved only once their first chunk is allocated, chunk lookup must work across all of them
+void test_region_allocator_segmented(uint rounds) {
+    constexpr uint32 num_regions = 8;
+    constexpr uint64 segment_size_log2 = 20;
+
+    uint64 region_sizes[num_regions] = {20, 20, 21, 21, 22, 22, 22, 22};
+    uint64 region_chunk_sizes[num_regions] = {12, 13, 14, 15, 16, 17, 18, 19};
+
+    RegionChunkAllocatorSpecsConfig specs_config{};
+    specs_config.region_sizes = region_sizes;
+    specs_config.num_region_sizes = num_regions;
+    specs_config.region_chunk_sizes = region_chunk_sizes;
+    specs_config.num_region_chunk_sizes = num_regions;
+    specs_config.handle_size = conf_region_handle_size;
+    specs_config.region_alignment = 8;
+    specs_config.handle_alignment = 8;
+    specs_config.segment_size_log2 = segment_size_log2;
+    specs_config.address_space_bits = conf_address_space_bits;
+
+    RegionChunkAllocatorSpecs specs{};
+    auto* specs_config_check = RegionChunkAllocatorSpecs::create(Memory::from(&specs), specs_config);
+    CUW3_CHECK(specs_config_check, "failed to create region specs");
+    CUW3_CHECK(specs.num_segments == 22, "invalid number of segments");
+
+    RegionChunkAllocatorPoolsConfig pools_config{};
+    pools_config.specs = &specs;
+    pools_config.contention_split = 4;
+
+    RegionChunkAllocatorPools pools{};
+    auto* pools_check = RegionChunkAllocatorPools::create(Memory::from(&pools), pools_config);
+    CUW3_CHECK(pools_check, "failed to create allocator pools");
+
+    auto handles = VMemPtr::create(specs.total_handles_size);
+    auto pool_handles = VMemPtr::create(specs.total_pool_handles_size);
+    auto segments = VMemPtr::create(specs.total_segments_size);
+    auto segment_map = VMemPtr::create(specs.total_segment_map_size);
+    CUW3_CHECK(handles && pool_handles && segments && segment_map, "failed to allocate allocator memory");
+
+    RegionAllocatorConfig allocator_config{};
+    allocator_config.specs = &specs;
+    allocator_config.pools = &pools;
+    allocator_config.handles = handles.ptr();
+    allocator_config.pool_handles = pool_handles.ptr();
+    allocator_config.segments = (void**)segments.ptr();
+    allocator_config.segment_map = (uint32*)segment_map.ptr();
+    allocator_config.segment_alloc_type = VMemReserveCommit;
+
+    RegionChunkAllocator allocator{};
+    auto* allocator_check = RegionChunkAllocator::create(Memory::from(&allocator), allocator_config);
+    CUW3_CHECK(allocator_check, "failed to create an allocator");
+
+    auto count_segments = [&]() {
+        return std::count_if(allocator.segments, allocator.segments + specs.num_segments, [](void* segment) { return segment != nullptr; });
+    };
+    CUW3_CHECK(count_segments() == 0, "segments must not be reserved up front");
+
+    uint64 local{};
+    CUW3_CHECK(!allocator.ptr_to_allocation(&local), "foreign pointer located");
+
+    for (uint round = 0; round < rounds; round++) {
+        std::vector<RegionChunkAllocation> allocations{};
+        for (uint32 region = 0; region < num_regions; region++) {
+            RegionChunkAllocParams alloc_params{};
+            alloc_params.rounds = 4;
+            alloc_params.attempts = 4;
+            while (auto allocation = allocator.allocate_chunk(region, alloc_params)) {
+                alloc_params.split_start = allocation.split;
+                allocations.push_back(allocation);
+
+                auto chunk_memory = allocator.chunk_allocation_to_memory(allocation);
+                auto* chunk_first = (char*)chunk_memory.chunk;
+                auto* chunk_last = chunk_first + chunk_memory.chunk_size - 1;
+                *chunk_first = 1;
+                *chunk_last = 1;
+                for (void* ptr : {(void*)chunk_first, (void*)chunk_last}) {
+                    auto located = allocator.ptr_to_allocation(ptr);
+                    CUW3_CHECK(located.region == allocation.region && located.chunk == allocation.chunk, "invalid chunk located");
+                    CUW3_CHECK(located.handle == allocation.handle && located.split == allocation.split, "invalid chunk located");
+                }
+            }
+            if (round == 0 && region == 0) {
+                CUW3_CHECK(count_segments() == 1, "only the segment of the first region must have been reserved");
+            }
+        }
+        CUW3_CHECK(allocations.size() == specs.num_handles, "failed to properly exhaust region pools");
+        CUW3_CHECK(count_segments() == (long)specs.num_segments, "all segments must have been reserved");
+
+        shuffle(allocations);
+        for (auto allocation : allocations) {
+            allocator.deallocate_chunk(allocation);
+        }
+    }
+
+    allocator.release_segments();
+    CUW3_CHECK(count_segments() == 0, "segments were not released");
+}
+
+// all regions share a single range of 32 blocks (block = max chunk size)
+struct TestUnifiedRegionChunkAllocator {
+    static constexpr uint32 num_regions = 6;
+
+    TestUnifiedRegionChunkAllocator() {
+        uint64 region_sizes[num_regions] = {14, 14, 14, 14, 14, 14};
+        uint64 region_chunk_sizes[num_regions] = {4, 5, 6, 7, 8, 9};
+
+        RegionChunkAllocatorSpecsConfig specs_config{};
+        specs_config.region_sizes = region_sizes;
+        specs_config.num_region_sizes = num_regions;
+        specs_config.region_chunk_sizes = region_chunk_sizes;
+        specs_config.num_region_chunk_sizes = num_regions;
+        specs_config.handle_size = conf_region_handle_size;
+        specs_config.region_alignment = 8;
+        specs_config.handle_alignment = 8;
+        specs_config.unified = true;
+
+        auto* specs_config_check = RegionChunkAllocatorSpecs::create(Memory::from(&specs), specs_config);
+        CUW3_CHECK(specs_config_check, "failed to create region specs");
+        CUW3_CHECK(specs.total_regions_size == intpow2<uint64>(14), "unified regions must share the range");
+        CUW3_CHECK(specs.num_blocks == 32, "invalid number of blocks");
+
+        RegionChunkAllocatorPoolsConfig pools_config{};
+        pools_config.specs = &specs;
+        pools_config.contention_split = 4;
+
+        auto* pools_check = RegionChunkAllocatorPools::create(Memory::from(&pools), pools_config);
+        CUW3_CHECK(pools_check, "failed to create allocator pools");
+
+        regions = VMemPtr::create(specs.total_regions_size);
+        handles = VMemPtr::create(specs.total_handles_size);
+        pool_handles = VMemPtr::create(specs.total_pool_handles_size);
+        blocks = VMemPtr::create(specs.total_blocks_size);
+        CUW3_CHECK(regions && handles && pool_handles && blocks, "failed to allocate allocator memory");
+
+        RegionAllocatorConfig allocator_config{};
+        allocator_config.specs = &specs;
+        allocator_config.pools = &pools;
+        allocator_config.regions = regions.ptr();
+        allocator_config.handles = handles.ptr();
+        allocator_config.pool_handles = pool_handles.ptr();
+        allocator_config.blocks = (RegionChunkBlock*)blocks.ptr();
+
+        auto* allocator_check = RegionChunkAllocator::create(Memory::from(&allocator), allocator_config);
+        CUW3_CHECK(allocator_check, "failed to create an allocator");
+    }
+
+    [[nodiscard]] RegionChunkAllocation allocate_chunk(uint32 region, uint32 split_start) {
+        RegionChunkAllocParams alloc_params{};
+        alloc_params.rounds = 4;
+        alloc_params.attempts = 4;
+        alloc_params.split_start = split_start;
+        return allocator.allocate_chunk(region, alloc_params);
+    }
+
+    void deallocate_chunk(RegionChunkAllocation allocation) {
+        allocator.deallocate_chunk(allocation);
+    }
+
+    // allocation must be found by any of its bytes
+    void check_located(RegionChunkAllocation allocation) {
+        auto chunk_memory = allocator.chunk_allocation_to_memory(allocation);
+        for (void* ptr : {chunk_memory.chunk, advance_ptr(chunk_memory.chunk, chunk_memory.chunk_size - 1)}) {
+            auto located = allocator.ptr_to_allocation(ptr);
+            CUW3_CHECK(located.region == allocation.region && located.chunk == allocation.chunk, "invalid chunk located");
+            CUW3_CHECK(located.handle == allocation.handle && located.split == allocation.split, "invalid chunk located");
+        }
+    }
+
+    // chunks must not overlap and must cover the whole range if every region is exhausted
+    uint64 check_disjoint(const std::vector<RegionChunkAllocation>& allocations) {
+        std::vector<std::pair<uint64, uint64>> ranges{};
+        for (auto allocation : allocations) {
+            auto& region_specs = specs.region_specs[allocation.region];
+            ranges.push_back({region_specs.get_relchunk(allocation.chunk), region_specs.get_chunk_size()});
+        }
+        std::sort(ranges.begin(), ranges.end());
+
+        uint64 total = 0;
+        for (usize i = 0; i < ranges.size(); i++) {
+            CUW3_CHECK(i == 0 || ranges[i - 1].first + ranges[i - 1].second <= ranges[i].first, "chunks overlap");
+            total += ranges[i].second;
+        }
+        return total;
+    }
+
+    RegionChunkAllocatorSpecs specs{};
+    RegionChunkAllocatorPools pools{};
+    VMemPtr regions{};
+    VMemPtr handles{};
+    VMemPtr pool_handles{};
+    VMemPtr blocks{};
+    RegionChunkAllocator allocator{};
+};
+
+void test_region_allocator_unified(uint rounds) {
+    TestUnifiedRegionChunkAllocator allocator{};
+    constexpr uint32 num_regions = TestUnifiedRegionChunkAllocator::num_regions;
+    constexpr uint32 max_region = num_regions - 1;
+
+    auto exhaust_region = [&](uint32 region, std::vector<RegionChunkAllocation>& allocations) {
+        uint32 split = 0;
+        while (auto allocation = allocator.allocate_chunk(region, split)) {
+            split = allocation.split;
+            allocator.check_located(allocation);
+            allocations.push_back(allocation);
+        }
+    };
+
+    for (uint round = 0; round < rounds; round++) {
+        // the smallest chunks can take the whole range
+        std::vector<RegionChunkAllocation> allocations{};
+        exhaust_region(0, allocations);
+        CUW3_CHECK(allocations.size() == allocator.specs.region_specs[0].num_handles, "smallest chunks must take the whole range");
+        CUW3_CHECK(allocator.check_disjoint(allocations) == allocator.specs.total_regions_size, "range is not covered");
+        CUW3_CHECK(!allocator.allocate_chunk(max_region, 0), "all blocks must have been split");
+
+        // blocks of the freed chunks are merged back
+        shuffle(allocations);
+        for (auto allocation : allocations) {
+            allocator.deallocate_chunk(allocation);
+        }
+        allocations.clear();
+        exhaust_region(max_region, allocations);
+        CUW3_CHECK(allocations.size() == allocator.specs.num_blocks, "blocks were not merged");
+        for (auto allocation : allocations) {
+            allocator.deallocate_chunk(allocation);
+        }
+        allocations.clear();
+
+        // chunks of random sizes: once no region can allocate every block is fully allocated
+        std::vector<uint32> exhausted(num_regions);
+        uint32 num_exhausted = 0;
+        while (num_exhausted < num_regions) {
+            uint32 region = rand() % num_regions;
+            if (exhausted[region]) {
+                continue;
+            }
+            auto allocation = allocator.allocate_chunk(region, 0);
+            if (!allocation) {
+                exhausted[region] = 1;
+                num_exhausted++;
+                continue;
+            }
+            allocator.check_located(allocation);
+            allocations.push_back(allocation);
+        }
+        CUW3_CHECK(allocator.check_disjoint(allocations) == allocator.specs.total_regions_size, "range is not covered");
+
+        // freed as chains of neighbours
+        std::sort(allocations.begin(), allocations.end(), [](auto& a, auto& b) { return std::pair{a.region, a.chunk} < std::pair{b.region, b.chunk}; });
+        allocator.allocator.deallocate_chunk_chain(allocations.data(), allocations.size());
+        allocations.clear();
+    }
+}
+
+// threads allocate and free chunks of random sizes, every chunk is tagged by its owner
+// everything is merged back once all chunks are free
+void test_region_allocator_unified_mt(uint threads, uint rounds) {
+    TestUnifiedRegionChunkAllocator allocator{};
+    constexpr uint32 num_regions = TestUnifiedRegionChunkAllocator::num_regions;
+
+    std::vector<std::thread> workers(threads);
+    for (uint thread_id = 0; thread_id < threads; thread_id++) {
+        workers[thread_id] = std::thread([&, thread_id, rounds](){
+            std::vector<RegionChunkAllocation> allocations{};
+            auto release = [&](usize index) {
+                auto allocation = allocations[index];
+                auto chunk_memory = allocator.allocator.chunk_allocation_to_memory(allocation);
+                auto* chunk_first = (uint64*)chunk_memory.chunk;
+                auto* chunk_last = (uint64*)advance_ptr(chunk_memory.chunk, chunk_memory.chunk_size - sizeof(uint64));
+                CUW3_CHECK(*chunk_first == thread_id && *chunk_last == allocation.handle, "chunk was handed out twice");
+                allocator.deallocate_chunk(allocation);
+                allocations[index] = allocations.back();
+                allocations.pop_back();
+            };
+
+            for (uint round = 0; round < rounds; round++) {
+                if (allocations.empty() || rand() % 3) {
+                    if (auto allocation = allocator.allocate_chunk(rand() % num_regions, thread_id)) {
+                        auto chunk_memory = allocator.allocator.chunk_allocation_to_memory(allocation);
+                        *(uint64*)chunk_memory.chunk = thread_id;
+                        *(uint64*)advance_ptr(chunk_memory.chunk, chunk_memory.chunk_size - sizeof(uint64)) = allocation.handle;
+                        allocator.check_located(allocation);
+                        allocations.push_back(allocation);
+                        continue;
+                    }
+                }
+                if (!allocations.empty()) {
+                    release(rand() % allocations.size());
+                }
+            }
+            while (!allocations.empty()) {
+                release(allocations.size() - 1);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<RegionChunkAllocation> allocations{};
+    while (auto allocation = allocator.allocate_chunk(num_regions - 1, 0)) {
+        allocations.push_back(allocation);
+    }
+    CUW3_CHECK(allocations.size() == allocator.specs.num_blocks, "blocks were not merged");
+}
+
+RegionChunkCacheConfig create_test_chunk_cache_config(uint64 budget, uint64 high, uint64 low) {
+    RegionChunkCacheConfig config{};
+    config.budget = budget;
+    config.num_shards = 4;
+    for (uint32 region = 0; region < conf_max_region_sizes; region++) {
+        config.high_watermarks[region] = high;
+        config.low_watermarks[region] = low;
+    }
+    return config;
+}
+
+void test_region_chunk_cache_st() {
+    constexpr uint64 high = 4;
+    constexpr uint64 low = 1;
+
+    TestRegionChunkAllocator allocator{};
+    for (uint32 region = 0; region < allocator.get_num_regions(); region++) {
+        uint64 chunk_size = allocator.specs.region_specs[region].get_chunk_size();
+
+        // watermark limit
+        {
+            RegionChunkCache cache{};
+            auto* check = RegionChunkCache::create(Memory::from(&cache), create_test_chunk_cache_config(-1, high, low));
+            CUW3_CHECK(check, "failed to create chunk cache");
+
+            std::vector<RegionChunkAllocation> allocations{};
+            for (uint i = 0; i < 2 * high; i++) {
+                auto allocation = allocator.allocate_chunk(region, 0);
+                CUW3_CHECK(allocation, "failed to allocate chunk");
+                allocations.push_back(allocation);
+            }
+
+            std::vector<RegionChunkAllocation> rejected{};
+            for (uint i = 0; i < allocations.size(); i++) {
+                bool cached = cache.put(allocator.allocator, allocations[i], i);
+                CUW3_CHECK(cached == (i < high), "high watermark was not respected");
+                if (!cached) {
+                    rejected.push_back(allocations[i]);
+                }
+            }
+            CUW3_CHECK(cache.get_cached_count(region) == high, "invalid count of cached chunks");
+            CUW3_CHECK(cache.get_cached_size() == high * chunk_size, "invalid size of cached chunks");
+
+            while (auto allocation = cache.trim(allocator.allocator, region, cache.get_low_watermark(region))) {
+                rejected.push_back(allocation);
+            }
+            CUW3_CHECK(cache.get_cached_count(region) == low, "cache was not trimmed to low watermark");
+
+            while (auto allocation = cache.get(allocator.allocator, region, 0)) {
+                rejected.push_back(allocation);
+            }
+            CUW3_CHECK(cache.get_cached_count(region) == 0, "cache must have been empty");
+            CUW3_CHECK(cache.get_cached_size() == 0, "cache must have been empty");
+            CUW3_CHECK(rejected.size() == allocations.size(), "some chunk was lost");
+
+            for (auto allocation : rejected) {
+                auto it = std::find_if(allocations.begin(), allocations.end(), [&](auto& other) { return other.handle == allocation.handle; });
+                CUW3_CHECK(it != allocations.end(), "unknown chunk returned");
+                CUW3_CHECK(it->region == allocation.region && it->chunk == allocation.chunk && it->split == allocation.split, "chunk was corrupted");
+                allocations.erase(it);
+                allocator.deallocate_chunk(allocation);
+            }
+        }
+
+        // budget limit
+        {
+            RegionChunkCache cache{};
+            auto* check = RegionChunkCache::create(Memory::from(&cache), create_test_chunk_cache_config(chunk_size, high, low));
+            CUW3_CHECK(check, "failed to create chunk cache");
+
+            auto allocation1 = allocator.allocate_chunk(region, 0);
+            auto allocation2 = allocator.allocate_chunk(region, 0);
+            CUW3_CHECK(allocation1 && allocation2, "failed to allocate chunk");
+            CUW3_CHECK(cache.put(allocator.allocator, allocation1, 0), "chunk must have been cached");
+            CUW3_CHECK(!cache.put(allocator.allocator, allocation2, 0), "budget was not respected");
+
+            auto cached = cache.get(allocator.allocator, region, 3);
+            CUW3_CHECK(cached.handle == allocation1.handle, "invalid chunk returned");
+            allocator.deallocate_chunk(allocation1);
+            allocator.deallocate_chunk(allocation2);
+        }
+    }
+}
+
+void test_region_chunk_cache_decay() {
+    constexpr uint64 high = 4;
+    constexpr uint64 decay_ms = 1000;
+
+    TestRegionChunkAllocator allocator{};
+
+    auto config = create_test_chunk_cache_config(-1, high, 0);
+    config.decay_ms = decay_ms;
+
+    RegionChunkCache cache{};
+    auto* check = RegionChunkCache::create(Memory::from(&cache), config);
+    CUW3_CHECK(check, "failed to create chunk cache");
+
+    uint32 region = 0;
+    for (uint i = 0; i < high; i++) {
+        auto allocation = allocator.allocate_chunk(region, 0);
+        CUW3_CHECK(allocation, "failed to allocate chunk");
+        CUW3_CHECK(cache.put(allocator.allocator, allocation, i), "chunk must have been cached");
+    }
+
+    auto purge = [&](uint64 now) {
+        uint64 watermark = cache.update_decay_watermark(region, now);
+        while (auto allocation = cache.trim(allocator.allocator, region, watermark)) {
+            allocator.deallocate_chunk(allocation);
+        }
+        return watermark;
+    };
+
+    // region was active: idle period starts now
+    CUW3_CHECK(purge(100) == high, "active region must keep everything");
+    CUW3_CHECK(cache.get_cached_count(region) == high, "active region was purged");
+
+    CUW3_CHECK(purge(100 + decay_ms / 2) == high / 2, "invalid decay watermark");
+    CUW3_CHECK(cache.get_cached_count(region) == high / 2, "region has not decayed");
+
+    // activity restarts idle period
+    auto allocation = cache.get(allocator.allocator, region, 0);
+    CUW3_CHECK(allocation, "cache must have had a chunk");
+    CUW3_CHECK(cache.put(allocator.allocator, allocation, 0), "chunk must have been cached");
+    CUW3_CHECK(purge(100 + decay_ms) == high, "activity was not registered");
+    CUW3_CHECK(cache.get_cached_count(region) == high / 2, "active region was purged");
+
+    CUW3_CHECK(purge(100 + 2 * decay_ms - 1) == 1, "last chunk must live for the whole period");
+    CUW3_CHECK(purge(100 + 2 * decay_ms) == 0, "idle region must have been purged completely");
+    CUW3_CHECK(cache.get_cached_count(region) == 0, "idle region must have been purged completely");
+    CUW3_CHECK(cache.get_cached_size() == 0, "cache must have been empty");
+}
+
+void test_region_chunk_cache_mt(uint threads, uint rounds) {
+    TestRegionChunkAllocator allocator{};
+
+    RegionChunkCache cache{};
+    auto* check = RegionChunkCache::create(Memory::from(&cache), create_test_chunk_cache_config(-1, 16, 0));
+    CUW3_CHECK(check, "failed to create chunk cache");
+
+    std::vector<std::atomic<uint32>> owned(allocator.specs.num_handles);
+
+    std::vector<std::thread> workers{};
+    for (uint thread_id = 0; thread_id < threads; thread_id++) {
+        workers.push_back(std::thread([&, thread_id]() {
+            std::vector<RegionChunkAllocation> allocations{};
+            for (uint round = 0; round < rounds; round++) {
+                uint32 region = round % allocator.get_num_regions();
+                for (uint i = 0; i < 4; i++) {
+                    auto allocation = cache.get(allocator.allocator, region, thread_id);
+                    if (!allocation) {
+                        allocation = allocator.allocate_chunk(region, thread_id);
+                    }
+                    if (!allocation) {
+                        continue;
+                    }
+                    CUW3_CHECK(owned[allocation.handle].exchange(1) == 0, "chunk is owned by two threads at once");
+                    allocations.push_back(allocation);
+                }
+                for (auto allocation : allocations) {
+                    CUW3_CHECK(owned[allocation.handle].exchange(0) == 1, "chunk was not owned");
+                    if (!cache.put(allocator.allocator, allocation, thread_id)) {
+                        allocator.deallocate_chunk(allocation);
+                    }
+                }
+                allocations.clear();
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (uint32 region = 0; region < allocator.get_num_regions(); region++) {
+        while (auto allocation = cache.get(allocator.allocator, region, 0)) {
+            allocator.deallocate_chunk(allocation);
+        }
+    }
+    CUW3_CHECK(cache.get_cached_size() == 0, "cache must have been empty");
+}
+
 
 TEST(RegionChunkAllocator, Specs) {
     test_region_allocator_specs();
@@ -345,4 +965,36 @@ TEST(RegionChunkAllocator, SingleThreaded) {
 
 TEST(RegionChunkAllocator, MultiThreaded) {
     test_region_allocator_mt(8, 64);
+}
+
+TEST(RegionChunkAllocator, BatchedMultiThreaded) {
+    test_region_allocator_batched_mt(4, 64, 5);
+}
+
+TEST(RegionChunkAllocator, ContentionMultiThreaded) {
+    test_region_allocator_contention_mt(8, 1 << 14);
+}
+
+TEST(RegionChunkAllocator, Segmented) {
+    test_region_allocator_segmented(4);
+}
+
+TEST(RegionChunkAllocator, Unified) {
+    test_region_allocator_unified(16);
+}
+
+TEST(RegionChunkAllocator, UnifiedMultiThreaded) {
+    test_region_allocator_unified_mt(8, 1 << 14);
+}
+
+TEST(RegionChunkAllocator, ChunkCacheSingleThreaded) {
+    test_region_chunk_cache_st();
+}
+
+TEST(RegionChunkAllocator, ChunkCacheDecay) {
+    test_region_chunk_cache_decay();
+}
+
+TEST(RegionChunkAllocator, ChunkCacheMultiThreaded) {
+    test_region_chunk_cache_mt(8, 1 << 12);
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "cuw3/conf.hpp"
+#include "cuw3/assert.hpp"
+#include "cuw3/remote_free_buffer.hpp"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+
+using namespace cuw3;
+
+namespace remote_free_buffer_tests {
+    struct alignas(16) Block {
+        std::byte data[16];
+    };
+
+    void test_remote_free_buffer(uint64 num_batches, uint64 batch_capacity) {
+        RemoteFreeBufferConfig config{};
+        config.num_batches = num_batches;
+        config.batch_capacity = batch_capacity;
+
+        RemoteFreeBuffer buffer{};
+        auto* check = RemoteFreeBuffer::create(Memory::from(&buffer), config);
+        CUW3_CHECK(check, "failed to create remote free buffer");
+        CUW3_CHECK(buffer.enabled() && buffer.empty(), "buffer must have been empty");
+
+        std::vector<Block> handles(num_batches + 1);
+        std::vector<Block> blocks(batch_capacity);
+
+        // every handle gets its own slot, one extra handle does not fit
+        for (uint64 i = 0; i < num_batches; i++) {
+            auto* batch = buffer.find(&handles[i]);
+            CUW3_CHECK(batch && batch->handle == &handles[i], "slot must have been assigned");
+            CUW3_CHECK(buffer.find(&handles[i]) == batch, "same handle must map to the same slot");
+        }
+        CUW3_CHECK(!buffer.find(&handles[num_batches]), "buffer must have been full");
+
+        // block chain: last pushed block goes first, first pushed block is the tail
+        auto* batch = buffer.find(&handles[0]);
+        for (uint64 i = 0; i < batch_capacity; i++) {
+            CUW3_CHECK(!buffer.full(batch), "batch must not have been full");
+            buffer.push(batch, &blocks[i], 16);
+        }
+        CUW3_CHECK(buffer.full(batch), "batch must have been full");
+
+        auto detached = buffer.detach(batch);
+        CUW3_CHECK(detached.handle == &handles[0], "invalid handle detached");
+        CUW3_CHECK(detached.count == batch_capacity && detached.size == 16 * batch_capacity, "invalid batch stats");
+        CUW3_CHECK(detached.head == &blocks[batch_capacity - 1] && detached.tail == &blocks[0], "invalid chain boundaries");
+
+        uint64 chain_length = 0;
+        for (void* block = detached.head; block != detached.tail; block = *(void**)block) {
+            chain_length++;
+        }
+        CUW3_CHECK(chain_length + 1 == batch_capacity, "chain is broken");
+
+        // freed slot can be reused
+        auto* reused = buffer.find(&handles[num_batches]);
+        CUW3_CHECK(reused == batch, "freed slot must have been reused");
+
+        // size-only batch does not touch memory
+        buffer.push(reused, nullptr, 32);
+        CUW3_CHECK(!reused->head && !reused->tail && reused->size == 32, "size-only push must not chain anything");
+
+        // buffer is full again so victim is picked round-robin
+        CUW3_CHECK(buffer.victim() == &buffer.batches[0], "invalid victim");
+        for (auto& batch : buffer.batches) {
+            if (batch) {
+                (void)buffer.detach(&batch);
+            }
+        }
+        CUW3_CHECK(buffer.empty(), "buffer must have been empty");
+    }
+}
+
+
+TEST(RemoteFreeBuffer, Basic) {
+    remote_free_buffer_tests::test_remote_free_buffer(conf_remote_free_batches, conf_remote_free_batch_capacity);
+}
+
+TEST(RemoteFreeBuffer, Tiny) {
+    remote_free_buffer_tests::test_remote_free_buffer(1, 1);
+}
@@ -0,0 +1,257 @@
+#include "cuw3/conf.hpp"
+#include "cuw3/vmem.hpp"
+#include "cuw3/funcs.hpp"
+#include "cuw3/assert.hpp"
+#include "cuw3/slab_allocator.hpp"
+
+#include "tests_common.hpp"
+
+#include <set>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <random>
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+
+using namespace cuw3;
+
+namespace slab_allocator_tests {
+    struct alignas(region_owner_alignment) Owner {
+    } dummy_owner;
+
+    struct alignas(conf_control_block_size) SlabChunkHandle {
+        std::byte data[conf_control_block_size];
+    };
+
+    struct SlabAllocation {
+        explicit operator bool() const {
+            return ptr;
+        }
+
+        void* ptr{};
+        uint64 size{};
+    };
+
+    // emulates region chunk allocator: fixed amount of chunks with external handles
+    struct TestSlabAllocator {
+        TestSlabAllocator(uint num_chunks, uint64 chunk_size, uint64 max_size = conf_slab_max_size)
+            : num_chunks{num_chunks}, chunk_size{chunk_size}, handles(num_chunks), chunk_used(num_chunks) {
+            total_size = num_chunks * chunk_size;
+            memory = vmem_alloc_aligned(total_size, VMemAllocType::VMemReserveCommit, chunk_size);
+            CUW3_CHECK(memory, "failed to allocate memory");
+
+            SlabAllocatorConfig config{};
+            config.max_size = max_size;
+            auto* created = SlabAllocator::create(Memory::from(&allocator), config);
+            CUW3_CHECK(created, "failed to create slab allocator");
+        }
+
+        ~TestSlabAllocator() {
+            vmem_free(memory, total_size);
+        }
+
+        [[nodiscard]] SlabAllocation allocate(uint64 size, uint64 alignment) {
+            auto acquired = allocator.allocate(size, alignment);
+            if (acquired.status_no_resource()) {
+                auto* chunk = acquire_chunk();
+                if (!chunk) {
+                    return {};
+                }
+                allocator.add_chunk(chunk);
+                acquired = allocator.allocate(size, alignment);
+            }
+            if (!acquired.status_acquired()) {
+                return {};
+            }
+            return {acquired.get(), size};
+        }
+
+        void deallocate(void* ptr, uint64 size) {
+            if (auto* released = allocator.deallocate(chunk_from_ptr(ptr), ptr, size)) {
+                release_chunk(released);
+            }
+        }
+
+        void retire(void* ptr, uint64 size) {
+            (void)allocator.retire(chunk_from_ptr(ptr), ptr, size);
+        }
+
+        void reclaim() {
+            auto reclaim_list = allocator.reclaim_chunks();
+            while (reclaim_list) {
+                auto* chunk = reclaim_list.pop();
+                if (auto* released = allocator.reclaim_chunk(chunk)) {
+                    release_chunk(released);
+                }
+            }
+        }
+
+        bool empty() const {
+            return allocator.empty() && std::none_of(chunk_used.begin(), chunk_used.end(), [](bool used) { return used; });
+        }
+
+
+        SlabChunk* acquire_chunk() {
+            for (uint i = 0; i < num_chunks; i++) {
+                if (!chunk_used[i]) {
+                    chunk_used[i] = true;
+
+                    SlabChunkConfig config{};
+                    config.owner = &dummy_owner;
+                    config.chunk_memory = advance_ptr(memory, i * chunk_size);
+                    config.chunk_memory_size = chunk_size;
+                    auto* chunk = SlabChunkView::create(Memory::from(&handles[i]), config);
+                    CUW3_CHECK(chunk, "failed to create slab chunk");
+                    return chunk;
+                }
+            }
+            return nullptr;
+        }
+
+        void release_chunk(SlabChunk* chunk) {
+            auto id = (SlabChunkHandle*)chunk - handles.data();
+            CUW3_CHECK(chunk_used[id], "chunk was not used");
+            chunk_used[id] = false;
+        }
+
+        SlabChunk* chunk_from_ptr(void* ptr) {
+            auto offset = subptr(ptr, memory);
+            CUW3_CHECK(offset >= 0 && (uint64)offset < total_size, "ptr does not belong to any chunk");
+            return (SlabChunk*)&handles[offset / chunk_size];
+        }
+
+
+        uint num_chunks{};
+        uint64 chunk_size{};
+        uint64 total_size{};
+        void* memory{};
+        std::vector<SlabChunkHandle> handles{};
+        std::vector<bool> chunk_used{};
+        SlabAllocator allocator{};
+    };
+
+    void test_slab_size_classes() {
+        for (uint64 size = 1; size <= conf_slab_max_size; size++) {
+            auto size_class = slab_size_to_size_class(size);
+            CUW3_CHECK(size_class < conf_slab_num_size_classes, "invalid size class");
+            CUW3_CHECK(slab_size_class_to_size(size_class) >= size, "size class is too small");
+        }
+
+        TestSlabAllocator allocator(1, conf_min_region_chunk_size);
+        for (uint64 alignment = conf_min_alloc_alignment; alignment <= conf_slab_max_size; alignment *= 2) {
+            for (uint64 size = 1; size <= conf_slab_max_size; size++) {
+                auto size_class = allocator.allocator.locate_size_class(size, alignment);
+                if (size_class == slab_null_size_class) {
+                    CUW3_CHECK(align(size, alignment) > conf_slab_max_size, "size class must have been found");
+                    continue;
+                }
+                auto block_size = slab_size_class_to_size(size_class);
+                CUW3_CHECK(block_size >= size, "size class is too small");
+                CUW3_CHECK(is_aligned(block_size, alignment), "size class is misaligned");
+            }
+        }
+        CUW3_CHECK(!allocator.allocator.can_allocate(conf_slab_max_size + 1, conf_min_alloc_alignment), "max size exceeded");
+        CUW3_CHECK(!allocator.allocator.can_allocate(16, 2 * conf_slab_max_size), "max alignment exceeded");
+    }
+
+    void test_slab_allocator_st(uint rounds, uint num_chunks, uint64 total_allocs) {
+        TestSlabAllocator allocator(num_chunks, conf_min_region_chunk_size);
+
+        std::minstd_rand rand{42};
+        std::vector<SlabAllocation> allocations{};
+        std::set<void*> unique{};
+        for (uint round = 0; round < rounds; round++) {
+            for (uint64 i = 0; i < total_allocs; i++) {
+                uint64 size = rand() % conf_slab_max_size + 1;
+                uint64 alignment = intpow2<uint64>(conf_min_alloc_alignment_log2 + rand() % 3);
+                auto allocation = allocator.allocate(size, alignment);
+                CUW3_CHECK(allocation, "failed to allocate");
+                CUW3_CHECK(is_aligned(allocation.ptr, alignment), "allocation is misaligned");
+                CUW3_CHECK(unique.insert(allocation.ptr).second, "same block was handed out twice");
+
+                std::memset(allocation.ptr, 0xCD, size);
+                allocations.push_back(allocation);
+            }
+
+            shuffle(allocations);
+            uint64 to_free = allocations.size() / 2;
+            for (uint64 i = 0; i < to_free; i++) {
+                unique.erase(allocations.back().ptr);
+                allocator.deallocate(allocations.back().ptr, allocations.back().size);
+                allocations.pop_back();
+            }
+        }
+
+        for (auto allocation : allocations) {
+            allocator.deallocate(allocation.ptr, allocation.size);
+        }
+        CUW3_CHECK(allocator.empty(), "allocator must have been empty");
+    }
+
+    void test_slab_allocator_exhaustion() {
+        TestSlabAllocator allocator(1, conf_min_region_chunk_size);
+
+        uint64 page_size = conf_min_region_chunk_size / conf_slab_pages_per_chunk;
+        uint64 total_allocs = (conf_slab_pages_per_chunk - 1) * (page_size / conf_slab_max_size);
+
+        std::vector<void*> allocations{};
+        while (auto allocation = allocator.allocate(conf_slab_max_size, conf_min_alloc_alignment)) {
+            allocations.push_back(allocation.ptr);
+        }
+        CUW3_CHECK(allocations.size() == total_allocs, "invalid count of allocations made");
+
+        shuffle(allocations);
+        for (auto ptr : allocations) {
+            allocator.deallocate(ptr, conf_slab_max_size);
+        }
+        CUW3_CHECK(allocator.empty(), "allocator must have been empty");
+    }
+
+    void test_slab_allocator_retire_reclaim(uint rounds, uint64 allocs_per_round) {
+        TestSlabAllocator allocator(4, conf_min_region_chunk_size);
+
+        for (uint round = 0; round < rounds; round++) {
+            std::vector<SlabAllocation> allocations{};
+            for (uint64 i = 0; i < allocs_per_round; i++) {
+                auto allocation = allocator.allocate(i % conf_slab_max_size + 1, conf_min_alloc_alignment);
+                CUW3_CHECK(allocation, "failed to allocate");
+                allocations.push_back(allocation);
+            }
+
+            std::atomic<bool> done{};
+            std::thread retirer([&]() {
+                for (auto allocation : allocations) {
+                    allocator.retire(allocation.ptr, allocation.size);
+                }
+                done.store(true);
+            });
+            while (!done.load()) {
+                allocator.reclaim();
+            }
+            retirer.join();
+
+            allocator.reclaim();
+            CUW3_CHECK(allocator.empty(), "allocator must have been empty");
+        }
+    }
+}
+
+
+TEST(SlabAllocator, SizeClasses) {
+    slab_allocator_tests::test_slab_size_classes();
+}
+
+TEST(SlabAllocator, AllocatorSt) {
+    slab_allocator_tests::test_slab_allocator_st(8, 8, 1 << 12);
+}
+
+TEST(SlabAllocator, Exhaustion) {
+    slab_allocator_tests::test_slab_allocator_exhaustion();
+}
+
+TEST(SlabAllocator, RetireReclaim) {
+    slab_allocator_tests::test_slab_allocator_retire_reclaim(16, 1 << 12);
+}
@@ -1,6 +1,7 @@
 #include <cstring>
 #include <iostream>
 
+#include "cuw3/defs.hpp"
 #include "cuw3/vmem.hpp"
 #include "cuw3/utils.hpp"
 #include "cuw3/assert.hpp"
@@ -37,6 +38,75 @@ void test_vmem_reserve_commit_decommit() {
     vmem_free(alloc_reserved, 1 << 20);
 }
 
+void test_vmem_purge() {
+    void* alloc = vmem_alloc(1 << 20, VMemAllocType::VMemReserveCommit);
+    CUW3_CHECK(alloc, "vmem_alloc failed");
+
+    std::memset(alloc, 0xCD, 1 << 20);
+    CUW3_CHECK(vmem_purge(alloc, 1 << 20, VMemPurgeDontNeed), "vmem_purge with VMemPurgeDontNeed failed");
+    CUW3_CHECK(((unsigned char*)alloc)[0] == 0 && ((unsigned char*)alloc)[(1 << 20) - 1] == 0, "purged memory must read as zeroes");
+
+    // contents are undefined after lazy purge but memory must stay accessible
+    std::memset(alloc, 0xCD, 1 << 20);
+    CUW3_CHECK(vmem_purge(alloc, 1 << 20, VMemPurgeFree), "vmem_purge with VMemPurgeFree failed");
+    std::memset(alloc, 0xAB, 1 << 20);
+    CUW3_CHECK(((unsigned char*)alloc)[(1 << 20) - 1] == 0xAB, "purged memory must stay writable");
+
+    vmem_free(alloc, 1 << 20);
+}
+
+// huge pages are only hints, we can only check that memory is usable and falls back gracefully
+void test_vmem_hugepages() {
+    usize huge_page_size = vmem_huge_page_size();
+    for (auto huge_flag : {VMemHugepages, VMemHugetlb}) {
+        void* alloc = vmem_alloc_aligned(4 * huge_page_size, (VMemAllocType)(VMemReserve | huge_flag), huge_page_size);
+        CUW3_CHECK(alloc, "vmem_alloc_aligned with huge pages failed");
+        CUW3_CHECK(is_aligned(alloc, huge_page_size), "allocation must be aligned");
+
+        void* chunk = advance_ptr(alloc, huge_page_size);
+        CUW3_CHECK(vmem_commit(chunk, 2 * huge_page_size), "vmem_commit failed");
+        std::memset(chunk, 0xCD, 2 * huge_page_size);
+        CUW3_CHECK(vmem_decommit(chunk, 2 * huge_page_size), "vmem_decommit failed");
+        vmem_free(alloc, 4 * huge_page_size);
+    }
+}
+
+// contents must survive both in place resize and move
+void test_vmem_remap() {
+    usize page_size = vmem_page_size();
+    void* alloc = vmem_alloc(4 * page_size, VMemAllocType::VMemReserveCommit);
+    CUW3_CHECK(alloc, "vmem_alloc failed");
+    std::memset(alloc, 0xCD, 4 * page_size);
+
+    void* shrunk = vmem_remap(alloc, 4 * page_size, 2 * page_size, false);
+#if defined(_WIN32)
+    CUW3_CHECK(!shrunk, "remap is not supported on windows");
+    vmem_free(alloc, 4 * page_size);
+#else
+    CUW3_CHECK(shrunk == alloc, "shrink must be done in place");
+
+    void* grown = vmem_remap(shrunk, 2 * page_size, 64 * page_size, true);
+    CUW3_CHECK(grown, "vmem_remap failed");
+    CUW3_CHECK(((unsigned char*)grown)[0] == 0xCD && ((unsigned char*)grown)[2 * page_size - 1] == 0xCD, "contents were not preserved");
+    std::memset(grown, 0xAB, 64 * page_size);
+    vmem_free(grown, 64 * page_size);
+#endif
+}
+
+#ifdef CUW3_ASAN_ENABLED
+// heaps, tlas and spans poison their memory and unmap it as is, next mapping at the same address must be usable
+// poison exists only under asan so there is nothing to check otherwise
+void test_vmem_free_unpoisons() {
+    for (int i = 0; i < 4; i++) {
+        void* alloc = vmem_alloc(1 << 20, VMemAllocType::VMemReserveCommit);
+        CUW3_CHECK(alloc, "vmem_alloc failed");
+        std::memset(alloc, 0xCD, 1 << 20);
+        CUW3_POISON_MEMORY_REGION(alloc, 1 << 20);
+        vmem_free(alloc, 1 << 20);
+    }
+}
+#endif
+
 TEST(VMem, PageSizes) {
     test_vmem_page_sizes();
 }
@@ -52,3 +122,21 @@ TEST(VMem, AllocAligned) {
 TEST(VMem, ReserveCommitDecommit) {
     test_vmem_reserve_commit_decommit();
 }
+
+TEST(VMem, Purge) {
+    test_vmem_purge();
+}
+
+TEST(VMem, Hugepages) {
+    test_vmem_hugepages();
+}
+
+TEST(VMem, Remap) {
+    test_vmem_remap();
+}
+
+#ifdef CUW3_ASAN_ENABLED
+TEST(VMem, FreeUnpoisons) {
+    test_vmem_free_unpoisons();
+}
+#endif